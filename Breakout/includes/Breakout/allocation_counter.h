@@ -0,0 +1,8 @@
+#pragma once
+
+
+// breakout_sim replaces the global operator new to count every heap
+// allocation the process makes, so benchmarks can report allocations
+// per tick. The replacement lives in its own translation unit.
+// Allocations made by all threads so far
+unsigned long long AllocationCount();
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "game.h"
+#include "replay.h"
+
+
+// AutoPlayer plays a Game through the same keys a person would press.
+// In the menus it picks its level and starts it; while playing it
+// predicts where the ball will come down, following its bounces off the
+// walls and the ceiling, and moves the paddle there. Each time the ball
+// starts to fall it picks where on the paddle to hit it: it sweeps the
+// paths a range of hit offsets would send the ball along through the
+// level and takes the one that reaches a breakable brick soonest.
+// Decisions depend only on the game state, so a run is reproducible.
+class AutoPlayer
+{
+public:
+    // Constructor, level is the one selected from the menu
+    AutoPlayer(GLuint level = 0);
+    // Set the keys for the next tick of dt seconds. Key changes are
+    // also given to recorder, if there is one.
+    void Update(Game& game, GLfloat dt, ReplayRecorder* recorder = nullptr);
+    // Horizontal center of the ball when it reaches the paddle's height
+    static GLfloat PredictLanding(const Game& game);
+private:
+    GLuint level;
+    // Planned hit point, as a fraction of half the paddle from its center
+    GLfloat offset;
+    // Whether the ball was falling last tick, and how often it has started to
+    GLboolean falling;
+    GLuint falls;
+    // Press or release a key unless it already is
+    void press(Game& game, GLuint key, GLboolean pressed, ReplayRecorder* recorder);
+    // Press key for a tick and release it for the next, so the menus see every press
+    void tap(Game& game, GLuint key, ReplayRecorder* recorder);
+    // Choose the hit offset for a ball coming down at landing
+    void plan(const Game& game, GLfloat landing);
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "ball_object.h"
+#include "fixed_point.h"
+#include "job_system.h"
+#include "spatial_hash.h"
+
+
+// BallPool holds the extra balls of the multi-ball powerup as a
+// structure of arrays, so thousands of them step through plain loops
+// over contiguous floats. Positions are top left corners, like
+// GameObject::Position. Every ball of the pool has the same Radius and,
+// unlike Game::Ball, none of them ever sticks to the paddle. Removing a
+// ball moves the last one into its place, so indices are not stable
+// across removals.
+class BallPool
+{
+public:
+    std::vector<GLfloat> X, Y, VX, VY;
+    // Positions at the start of the tick, for drawing between ticks
+    std::vector<GLfloat> PrevX, PrevY;
+    GLfloat              Radius;
+
+    // Constructor
+    BallPool(GLfloat radius = 12.5f);
+    // Number of balls
+    GLuint Size() const;
+    // Adds a ball; it starts the tick where it is added
+    void   Add(glm::vec2 position, glm::vec2 velocity);
+    // Removes ball index, moving the last ball into its place
+    void   Remove(GLuint index);
+    void   Clear();
+    // Remembers where every ball starts the tick
+    void   StorePrevious();
+    // Separates every pair of touching balls and swaps their speeds along
+    // the line between them (an elastic collision of equal masses). Pairs
+    // come from a SpatialHash and are resolved in index order, the
+    // arithmetic in the physics number type. other is one more ball that
+    // takes part (Game::Ball) or nullptr; it keeps its own Radius and is
+    // tested against every ball of the pool. With jobs the pair search is
+    // split over its threads. Returns the pairs resolved.
+    GLuint Collide(BallObject* other = nullptr, JobSystem* jobs = nullptr);
+private:
+    // Scratch space of Collide, kept between ticks
+    std::vector<GLfloat> cornerX, cornerY;
+    std::vector<Vec2>    corners;
+    // touching pairs, lower index in the high half, and the pairs each
+    // chunk of the parallel search found
+    std::vector<std::uint64_t> pairs;
+    std::vector<std::vector<std::uint64_t>> chunkPairs;
+    std::vector<size_t>  chunkFound;
+    SpatialHash          grid;
+};
\ No newline at end of file
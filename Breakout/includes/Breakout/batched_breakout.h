@@ -0,0 +1,109 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+#include "game.h"
+
+
+// Bits of the action a world takes in one step; they press the same
+// keys as Game::ProcessInput reads (A, D and SPACE)
+enum BatchedAction {
+    ACTION_NONE  = 0,
+    ACTION_LEFT  = 1,
+    ACTION_RIGHT = 2,
+    ACTION_FIRE  = 4
+};
+
+// How the episode of a world ended in the last step
+enum EpisodeEnd {
+    EPISODE_RUNNING,
+    EPISODE_CLEARED,   // every breakable brick destroyed
+    EPISODE_LOST,      // the last life was lost
+    EPISODE_TRUNCATED  // MaxTicks reached
+};
+
+// BatchedBreakout steps many independent worlds of one level in
+// lockstep, for training agents. Each world plays like a Game that is
+// already in GAME_ACTIVE, with MultiBall off: given the same seed and the same keys, every
+// step leaves a world in exactly the state Game::Tick leaves the game in
+// (Checksum matches Game::Checksum), until its episode ends. A finished
+// world is reset at once with the seed Seeds[w] + Worlds, so every
+// episode of the batch has its own seed and Step never waits for one.
+//
+// State is kept as structure of arrays, one entry per world, so the
+// paddle and powerup updates are plain loops over contiguous floats.
+// Only the ball sweep, which branches on what it hits, runs world by
+// world. All worlds share one read-only copy of the level; each keeps
+// only its brick liveness bits. With Jobs set, Step splits the worlds
+// into ranges that run on the JobSystem.
+class BatchedBreakout
+{
+public:
+    // Most powerups a world keeps at once; later spawns are dropped (and
+    // counted), which is the one way a world can stop matching Game
+    static const GLuint POWERUP_SLOTS = 32;
+
+    GLuint       Worlds, Width, Height;
+    // Steps after which an episode is truncated, 0 for never
+    unsigned int MaxTicks;
+    // The level every world plays, with all of its bricks alive
+    GameLevel    Level;
+    GLuint       AliveWords;
+    // Ball
+    std::vector<GLfloat>   BallX, BallY, BallVX, BallVY;
+    std::vector<GLboolean> Stuck, Sticky, PassThrough;
+    // Paddle; its y and height never change
+    std::vector<GLfloat>   PaddleX, PaddleWidth;
+    GLfloat                PaddleY;
+    // Progress
+    std::vector<GLuint>        Lives, Remaining;
+    std::vector<std::uint64_t> Alive; // AliveWords per world
+    std::vector<GLboolean>     Confuse, Chaos;
+    // Powerups, POWERUP_SLOTS per world; the first PowerUpCount slots are
+    // in use, in the order Game::PowerUps would hold them
+    std::vector<GLuint>    PowerUpCount, PowerUpsDropped;
+    std::vector<GLfloat>   PowerUpX, PowerUpY, PowerUpDuration;
+    std::vector<GLubyte>   PowerUpType; // index in POWERUP_TYPES
+    std::vector<GLboolean> PowerUpActivated, PowerUpDestroyed;
+    // Per-world random generator and the seed of the current episode
+    std::vector<Random>        Rng;
+    std::vector<std::uint64_t> Seeds;
+    std::vector<unsigned int>  Ticks;
+    // Results of the last step: bricks destroyed, and whether (and how)
+    // the episode ended before the world was reset
+    std::vector<GLfloat> Rewards;
+    std::vector<GLubyte> Dones;
+    // Scheduler for Step, nullptr steps every world on the calling thread
+    JobSystem* Jobs;
+
+    // Constructor, world w starts its first episode with seed + w
+    BatchedBreakout(const GameLevel& level, GLuint worlds, GLuint width, GLuint height,
+        std::uint64_t seed, unsigned int maxTicks = 0);
+    // Starts a new episode of one world
+    void          Reset(GLuint world, std::uint64_t seed);
+    // Advances every world by dt; actions holds one BatchedAction per world
+    void          Step(const GLubyte* actions, GLfloat dt);
+    // Hash of one world, equal to Game::Checksum of the matching game
+    std::uint32_t Checksum(GLuint world) const;
+private:
+    // One step of the worlds [begin, end)
+    void stepRange(const GLubyte* actions, GLfloat dt, GLuint begin, GLuint end);
+    // Game::ProcessInput
+    void moveRange(const GLubyte* actions, GLfloat dt, GLuint begin, GLuint end);
+    // Game::DoCollisions and the life check of Game::Update
+    void collide(GLuint w, GLfloat dt);
+    // Game::sweepBall, hitBrick and bouncePaddle
+    GLboolean sweepBall(GLuint w, GLfloat dt);
+    void      hitBrick(GLuint w, GLuint index, Vec2 normal);
+    void      bouncePaddle(GLuint w);
+    void      spawnPowerUps(GLuint w, glm::vec2 position);
+    void      activatePowerUp(GLuint w, GLuint kind);
+    // Game::UpdatePowerUps: moving is one loop over all slots of the
+    // range, expiring and removing runs world by world
+    void advancePowerUps(GLfloat dt, GLuint begin, GLuint end);
+    void expirePowerUps(GLuint w);
+    // Game::ResetPlayer
+    void resetPlayer(GLuint w);
+};
\ No newline at end of file
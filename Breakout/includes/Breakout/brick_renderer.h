@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+#include "render_snapshot.h"
+#include "shader.h"
+#include "texture_array.h"
+
+
+// Per-instance data of one brick
+struct BrickInstance
+{
+    GLfloat X, Y, Width, Height;
+    GLfloat R, G, B;
+    // Where the brick's sprite is in the texture array
+    GLfloat Layer;
+    glm::vec4 UV;
+};
+
+// BrickRenderer draws a whole level with one instanced draw call.
+// Load uploads one instance per brick; afterwards only the slots of
+// bricks that were destroyed or revived are written again (a destroyed
+// brick gets a zero size, so it draws nothing), and drawing costs the
+// same no matter how many bricks the level has. Bricks never rotate.
+class BrickRenderer
+{
+public:
+    // Bricks in the instance buffer
+    GLuint Count;
+    // Constructor (inits shader and quad)
+    BrickRenderer(Shader& shader);
+    // Destructor
+    ~BrickRenderer();
+    // Uploads every brick of a level, destroyed ones included, all alive;
+    // bricks use the block sprite, solid ones the solid sprite
+    void Load(const std::vector<SpriteState>& bricks, const SpriteRegion& block, const SpriteRegion& solid);
+    // Rewrites the slots of bricks whose bit differs from the last call,
+    // one buffer update per run of neighbouring slots. alive has the
+    // layout of GameLevel::Alive.
+    void SetAlive(const std::uint64_t* alive);
+    // Draws all live bricks from the texture array their sprites are in
+    void Draw(const TextureArray& sprites);
+private:
+    // Render state
+    Shader shader;
+    GLuint VAO, quadVBO, instanceVBO;
+    // Instances as uploaded, with their full size, and the live bitmap
+    // the instance buffer currently shows
+    std::vector<BrickInstance> instances;
+    std::vector<std::uint64_t> alive;
+    // Initializes the quad and the instance attributes
+    void initRenderData();
+    // Writes slots [begin, end) to the instance buffer
+    void upload(GLuint begin, GLuint end);
+};
\ No newline at end of file
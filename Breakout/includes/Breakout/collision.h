@@ -0,0 +1,60 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <tuple>
+
+#include "ball_object.h"
+#include "fixed_point.h"
+#include "game_object.h"
+
+
+enum Direction {
+    UP,
+    RIGHT,
+    DOWN,
+    LEFT
+};
+
+// <collision?, what direction?, difference vector from the center to the closest point>
+typedef std::tuple<GLboolean, Direction, glm::vec2> Collision;
+
+// Which of the four directions the target vector is closest to
+Direction VectorDirection(glm::vec2 target);
+// AABB - AABB collision
+GLboolean CheckCollision(GameObject& one, GameObject& two);
+// AABB - Circle collision
+Collision CheckCollision(BallObject& one, GameObject& two);
+// The tests above on plain bounds, with the same arithmetic: boxes are
+// given by position (top left) and size, the circle by its center.
+// V is glm::vec2 or FixedVec2, like every template below.
+template <typename V>
+GLboolean OverlapAABB(V onePosition, V oneSize, V twoPosition, V twoSize);
+template <typename V>
+GLboolean OverlapCircleAABB(V center, typename V::value_type radius, V position, V size);
+
+
+// Result of a swept (continuous) collision test: the fraction of the
+// motion at which the shapes first touch and the contact normal, which
+// points away from the obstacle towards the moving circle.
+template <typename V>
+struct BasicSweepHit
+{
+    typename V::value_type Time;
+    V                      Normal;
+};
+// The hit of the physics' own number type (see Scalar)
+typedef BasicSweepHit<Vec2> SweepHit;
+
+// Sweeps a circle from center along motion against the axis-aligned box
+// [boxMin, boxMax]. Returns GL_TRUE and fills hit if the circle touches
+// the box within the motion (Time in [0, 1]) while moving towards it.
+// A circle that already overlaps the box and keeps moving into it hits
+// at Time 0 so it can be pushed back out.
+template <typename V>
+GLboolean SweepCircleAABB(V center, typename V::value_type radius, V motion,
+    V boxMin, V boxMax, BasicSweepHit<V>& hit);
+// Bounces velocity off a surface with the given contact normal so that
+// it leaves the surface, even after an earlier bounce in the same step
+template <typename V>
+void Reflect(V& velocity, V normal);
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+
+// Number of boxes one batch kernel call tests
+const GLuint BOX_BATCH = 8;
+
+// Structure-of-arrays copy of box bounds, stored the same way
+// CheckCollision sees them (center and half extents) so the kernels
+// below reproduce its results bit for bit. The arrays are padded with
+// empty boxes so a batch may start at any index below Count.
+struct BoxBatch
+{
+    std::vector<GLfloat> CenterX, CenterY, HalfX, HalfY;
+    GLuint Count;
+
+    BoxBatch() : Count(0) { }
+    // Holds count boxes, all of them empty
+    void Resize(GLuint count);
+    // Stores the box at position with size
+    void Set(GLuint index, glm::vec2 position, glm::vec2 size);
+    // Makes the box at index empty, it never overlaps anything
+    void Clear(GLuint index);
+};
+
+// Tests one circle against the BOX_BATCH boxes starting at first.
+// Returns a mask with bit i set when box first + i overlaps the circle,
+// exactly as CheckCollision(BallObject&, GameObject&) decides it, and
+// writes the vector from the center to each box's closest point (the
+// penetration vector) to diffX[i], diffY[i].
+typedef GLuint (*OverlapKernel)(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY);
+
+GLuint OverlapCircleBoxesScalar(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY);
+GLuint OverlapCircleBoxesSSE2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY);
+GLuint OverlapCircleBoxesAVX2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY);
+
+// Which of the kernels above this CPU runs (0 scalar, 1 SSE2, 2 AVX2)
+GLuint OverlapKernelLevel();
+// The fastest kernel this CPU supports
+extern const OverlapKernel OverlapCircleBoxes;
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "batched_breakout.h"
+
+
+// The shared-memory channel between breakout_sim --serve and trainer
+// processes on the same host (Linux only). One POSIX shared-memory
+// object holds an EnvHeader followed by Slots client slots; a client
+// claims a free slot and then owns Worlds BatchedBreakout worlds:
+//
+//   EnvHeader
+//   | Slots x (EnvSlot | Ring x frame)
+//   frame: Actions   Worlds x u8                  written by the client
+//          Features  Worlds x ENV_FEATURES x f32  the rest by the server
+//          Rewards   Worlds x f32
+//          Dones     Worlds x u8 (EpisodeEnd)
+//          Bricks    Worlds x AliveWords x u64    brick liveness bits
+//
+// Request n of a slot reads its actions from and writes its results to
+// frame n % Ring, so the results of the previous Ring - 1 requests stay
+// readable in place, e.g. for frame stacking. Every part starts on a
+// 64 byte boundary. Worlds that finished an episode are already reset:
+// Dones says how it ended, Features show the start of the next one.
+//
+// Handoff: the client fills the frame, stores Request = n and bumps
+// the header's Doorbell; the server answers with Response = n. Either
+// side spins for a while before it sleeps on the word with a futex, so
+// a pair that keeps up with each other never makes a system call.
+
+const std::uint32_t ENV_MAGIC = 0x564e454b; // "KENV"
+const std::uint32_t ENV_VERSION = 1;
+
+// Columns of a world's row in Features
+enum EnvFeature {
+    FEATURE_BALL_X, FEATURE_BALL_Y, FEATURE_BALL_VX, FEATURE_BALL_VY,
+    FEATURE_PADDLE_X, FEATURE_PADDLE_WIDTH,
+    FEATURE_LIVES, FEATURE_REMAINING,
+    FEATURE_STUCK, FEATURE_STICKY, FEATURE_PASS_THROUGH, FEATURE_CONFUSE, FEATURE_CHAOS,
+    ENV_FEATURES
+};
+
+// What a request asks the server to do with the slot's worlds
+enum EnvCommand {
+    ENV_OBSERVE, // only write the current state
+    ENV_RESET,   // new episodes, world w with Seed + w
+    ENV_STEP     // one step with the frame's actions
+};
+
+struct EnvHeader
+{
+    std::uint32_t Magic, Version;
+    std::uint32_t Slots, Worlds, AliveWords, Ring;
+    std::uint32_t Level, Width, Height;
+    GLfloat       Dt;
+    std::uint64_t SlotBytes, TotalBytes;
+    // Cleared when the server shuts down
+    std::atomic<std::uint32_t> Running;
+    // Bumped by every request; the server sleeps on it while idle
+    alignas(64) std::atomic<std::uint32_t> Doorbell;
+    std::atomic<std::uint32_t> ServerSleeping;
+};
+
+struct alignas(64) EnvSlot
+{
+    // Process id of the client that claimed the slot, 0 if free
+    std::atomic<std::uint32_t> Owner;
+    // Sequence numbers of the last request and the last answered one
+    std::atomic<std::uint32_t> Request, Response;
+    std::atomic<std::uint32_t> ClientWaiting;
+    // Arguments of the pending request, published by the store to Request
+    std::uint32_t Command;
+    std::uint64_t Seed;
+};
+
+// Pointers into one frame of a slot
+struct EnvFrame
+{
+    GLubyte*       Actions;
+    GLfloat*       Features;
+    GLfloat*       Rewards;
+    GLubyte*       Dones;
+    std::uint64_t* Bricks;
+};
+
+// EnvChannel maps the shared-memory object; the server creates it, the
+// clients open it. The object is removed when its creator closes it.
+class EnvChannel
+{
+public:
+    EnvHeader* Header;
+
+    EnvChannel();
+    ~EnvChannel();
+    // Create the object for the given shape, replacing a stale one of the same name
+    GLboolean Create(const std::string& name, GLuint slots, GLuint worlds, GLuint aliveWords, GLuint ring);
+    // Map an object created by a running server
+    GLboolean Open(const std::string& name);
+    void      Close();
+    EnvSlot*  Slot(GLuint slot) const;
+    EnvFrame  Frame(GLuint slot, std::uint32_t request) const;
+private:
+    std::string name;
+    void*       memory;
+    std::size_t size;
+    GLboolean   owner;
+};
+
+// Writes the state of every world of batch, and the rewards and episode
+// ends of its last step, into frame
+void WriteObservation(const BatchedBreakout& batch, const EnvFrame& frame);
+// Spins, then sleeps until word is no longer old or timeoutMs passes;
+// waiting is raised while asleep so the other side knows to wake it.
+// Returns the value word had last.
+std::uint32_t WaitForChange(std::atomic<std::uint32_t>& word, std::uint32_t old,
+    std::atomic<std::uint32_t>& waiting, GLuint timeoutMs);
+// Wakes every process sleeping on word
+void WakeAll(std::atomic<std::uint32_t>& word);
\ No newline at end of file
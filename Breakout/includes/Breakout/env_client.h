@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+#include "env_channel.h"
+#include "game.h"
+
+
+// EnvClient is the trainer's side of an EnvChannel. It claims a free
+// slot of a running breakout_sim --serve; each request then blocks
+// until the server has answered it. Nothing is copied: actions are
+// written into Next() and results are read from Last(), both frames of
+// the shared memory. A result frame stays valid for the next
+// Ring - 1 requests.
+class EnvClient
+{
+public:
+    EnvChannel Channel;
+
+    EnvClient();
+    ~EnvClient();
+    // Claim a slot of the server called name
+    GLboolean Connect(const std::string& name);
+    void      Disconnect();
+    GLuint    Slot() const { return this->slot; }
+    GLuint    Worlds() const { return this->Channel.Header->Worlds; }
+    // Frame of the next request; fill its Actions before Step
+    EnvFrame  Next() const { return this->Channel.Frame(this->slot, this->sequence + 1); }
+    // Frame holding the results of the last request
+    EnvFrame  Last() const { return this->Channel.Frame(this->slot, this->sequence); }
+    // Requests; each returns GL_FALSE if the server went away
+    GLboolean Observe();
+    GLboolean Reset(std::uint64_t seed);
+    GLboolean Step();
+private:
+    GLuint        slot;
+    std::uint32_t sequence;
+    GLboolean     connected;
+    GLboolean     request(EnvCommand command, std::uint64_t seed);
+};
+
+// breakout_sim --client: a stand-in trainer. It plays random actions in
+// a slot of the server called name for the given number of steps and
+// checks every result against a BatchedBreakout of its own that gets
+// the same seed and actions, then reports the round trip time of a step.
+// Returns the process exit code.
+int RunEnvClient(const GLchar* name, const Game& prototype, unsigned int steps, std::uint64_t seed);
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "game.h"
+
+
+// breakout_sim --serve: creates the EnvChannel called name (see
+// env_channel.h) and steps BatchedBreakout worlds of the prototype's
+// level for up to slots trainer processes, each owning worlds worlds,
+// until it gets SIGINT or SIGTERM. A single thread answers all slots;
+// the worlds of a step are spread over a JobSystem with the given
+// number of threads (0 = every core). Returns the process exit code.
+int RunEnvServer(const GLchar* name, const Game& prototype, GLuint level, GLuint slots, GLuint worlds,
+    GLfloat dt, GLuint threads);
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+
+// Fixed is a signed fixed-point number with 16 fractional bits. The
+// integer part has 47 bits rather than 15 so that squared distances and
+// sweep quadratics still fit; results must stay below 2^31. Every
+// operation is integer arithmetic with its rounding spelled out here:
+// products and square roots round down, quotients towards zero. So a
+// computation gives the same bits on every compiler, flag set (fast
+// math, FMA contraction) and SIMD width.
+class Fixed
+{
+public:
+    std::int64_t Raw;
+
+    Fixed() : Raw(0) { }
+    Fixed(int value) : Raw(static_cast<std::int64_t>(value) * 65536) { }
+    Fixed(unsigned int value) : Raw(static_cast<std::int64_t>(value) * 65536) { }
+    // Rounds to the nearest step; float to double and the scaling are exact
+    Fixed(float value) : Raw(Round(static_cast<double>(value) * 65536.0)) { }
+    Fixed(double value) : Raw(std::llround(value * 65536.0)) { }
+    static Fixed FromRaw(std::int64_t raw) { Fixed f; f.Raw = raw; return f; }
+    // One rounding, int64 to float; the division by 2^16 is exact
+    float ToFloat() const { return static_cast<float>(this->Raw) / 65536.0f; }
+
+    Fixed& operator+=(Fixed other) { this->Raw += other.Raw; return *this; }
+    Fixed& operator-=(Fixed other) { this->Raw -= other.Raw; return *this; }
+
+private:
+    // Halves away from zero like std::llround, without the library call;
+    // for a scaled float the sum cannot round across an integer
+    static std::int64_t Round(double scaled)
+    {
+        return static_cast<std::int64_t>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5);
+    }
+};
+
+inline Fixed operator-(Fixed a) { return Fixed::FromRaw(-a.Raw); }
+inline Fixed operator+(Fixed a, Fixed b) { return Fixed::FromRaw(a.Raw + b.Raw); }
+inline Fixed operator-(Fixed a, Fixed b) { return Fixed::FromRaw(a.Raw - b.Raw); }
+inline Fixed operator*(Fixed a, Fixed b)
+{
+    // a * b / 2^16 rounded down, with a split into its high and low 16
+    // bits so the 64-bit intermediate products cannot overflow
+    std::int64_t high = a.Raw >> 16, low = a.Raw & 0xFFFF;
+    return Fixed::FromRaw(high * b.Raw + ((low * b.Raw) >> 16));
+}
+inline Fixed operator/(Fixed a, Fixed b)
+{
+    // dividing by zero saturates, like float division gives infinity
+    if (b.Raw == 0)
+        return Fixed::FromRaw(a.Raw >= 0 ? INT64_MAX : INT64_MIN);
+    return Fixed::FromRaw(a.Raw * 65536 / b.Raw);
+}
+inline bool operator==(Fixed a, Fixed b) { return a.Raw == b.Raw; }
+inline bool operator!=(Fixed a, Fixed b) { return a.Raw != b.Raw; }
+inline bool operator<(Fixed a, Fixed b) { return a.Raw < b.Raw; }
+inline bool operator<=(Fixed a, Fixed b) { return a.Raw <= b.Raw; }
+inline bool operator>(Fixed a, Fixed b) { return a.Raw > b.Raw; }
+inline bool operator>=(Fixed a, Fixed b) { return a.Raw >= b.Raw; }
+
+// Two Fixed components, with the operators of glm::vec2 the physics uses
+struct FixedVec2
+{
+    typedef Fixed value_type;
+    Fixed x, y;
+
+    FixedVec2() { }
+    FixedVec2(Fixed s) : x(s), y(s) { }
+    FixedVec2(Fixed x, Fixed y) : x(x), y(y) { }
+    explicit FixedVec2(glm::vec2 v) : x(v.x), y(v.y) { }
+
+    FixedVec2& operator+=(FixedVec2 other) { this->x += other.x; this->y += other.y; return *this; }
+    FixedVec2& operator-=(FixedVec2 other) { this->x -= other.x; this->y -= other.y; return *this; }
+};
+
+inline FixedVec2 operator-(FixedVec2 a) { return FixedVec2(-a.x, -a.y); }
+inline FixedVec2 operator+(FixedVec2 a, FixedVec2 b) { return FixedVec2(a.x + b.x, a.y + b.y); }
+inline FixedVec2 operator-(FixedVec2 a, FixedVec2 b) { return FixedVec2(a.x - b.x, a.y - b.y); }
+inline FixedVec2 operator+(FixedVec2 a, Fixed s) { return FixedVec2(a.x + s, a.y + s); }
+inline FixedVec2 operator-(FixedVec2 a, Fixed s) { return FixedVec2(a.x - s, a.y - s); }
+inline FixedVec2 operator*(FixedVec2 a, Fixed s) { return FixedVec2(a.x * s, a.y * s); }
+inline FixedVec2 operator*(Fixed s, FixedVec2 a) { return FixedVec2(s * a.x, s * a.y); }
+inline FixedVec2 operator/(FixedVec2 a, Fixed s) { return FixedVec2(a.x / s, a.y / s); }
+inline bool operator==(FixedVec2 a, FixedVec2 b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(FixedVec2 a, FixedVec2 b) { return !(a == b); }
+
+// Math used by the physics, for both scalar types. The float versions
+// are exactly the glm and <cmath> calls the physics always made.
+inline GLfloat   Abs(GLfloat x) { return std::abs(x); }
+inline GLfloat   Sqrt(GLfloat x) { return std::sqrt(x); }
+inline GLfloat   Min(GLfloat a, GLfloat b) { return std::min(a, b); }
+inline GLfloat   Max(GLfloat a, GLfloat b) { return std::max(a, b); }
+inline GLfloat   Clamp(GLfloat x, GLfloat low, GLfloat high) { return glm::clamp(x, low, high); }
+inline glm::vec2 Min(glm::vec2 a, glm::vec2 b) { return glm::min(a, b); }
+inline glm::vec2 Max(glm::vec2 a, glm::vec2 b) { return glm::max(a, b); }
+inline glm::vec2 Clamp(glm::vec2 x, glm::vec2 low, glm::vec2 high) { return glm::clamp(x, low, high); }
+inline GLfloat   Dot(glm::vec2 a, glm::vec2 b) { return glm::dot(a, b); }
+inline GLfloat   Length(glm::vec2 v) { return glm::length(v); }
+inline glm::vec2 Normalize(glm::vec2 v) { return glm::normalize(v); }
+
+inline Fixed Abs(Fixed x) { return x.Raw < 0 ? -x : x; }
+inline Fixed Min(Fixed a, Fixed b) { return b < a ? b : a; }
+inline Fixed Max(Fixed a, Fixed b) { return a < b ? b : a; }
+inline Fixed Clamp(Fixed x, Fixed low, Fixed high) { return Min(Max(x, low), high); }
+// Square root rounded down. The floating-point root is only a first
+// guess; Newton's method on integers then settles on the exact floor of
+// the root of x * 2^16, whatever that guess was.
+inline Fixed Sqrt(Fixed x)
+{
+    if (x.Raw <= 0)
+        return Fixed();
+    std::uint64_t value = static_cast<std::uint64_t>(x.Raw) << 16;
+    std::uint64_t root = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(value))) + 1;
+    // one step from any guess lands on or above the floor, later steps only go down
+    std::uint64_t next = (root + value / root) / 2;
+    do
+    {
+        root = next;
+        next = (root + value / root) / 2;
+    } while (next < root);
+    return Fixed::FromRaw(static_cast<std::int64_t>(root));
+}
+inline FixedVec2 Min(FixedVec2 a, FixedVec2 b) { return FixedVec2(Min(a.x, b.x), Min(a.y, b.y)); }
+inline FixedVec2 Max(FixedVec2 a, FixedVec2 b) { return FixedVec2(Max(a.x, b.x), Max(a.y, b.y)); }
+inline FixedVec2 Clamp(FixedVec2 x, FixedVec2 low, FixedVec2 high)
+{
+    return FixedVec2(Clamp(x.x, low.x, high.x), Clamp(x.y, low.y, high.y));
+}
+inline Fixed     Dot(FixedVec2 a, FixedVec2 b) { return a.x * b.x + a.y * b.y; }
+inline Fixed     Length(FixedVec2 v) { return Sqrt(Dot(v, v)); }
+inline FixedVec2 Normalize(FixedVec2 v) { return v / Length(v); }
+
+// The number type of the ball, paddle and brick physics, chosen when
+// building: define BREAKOUT_FIXED_POINT for Fixed, which replays bit for
+// bit across builds, or leave it out for float, which is faster. Object
+// state stays in glm::vec2 either way; the physics converts it with
+// ToScalar and ToVec2, which do nothing in a float build.
+#ifdef BREAKOUT_FIXED_POINT
+typedef Fixed     Scalar;
+typedef FixedVec2 Vec2;
+inline Scalar    ToScalar(GLfloat x) { return Fixed(x); }
+inline Vec2      ToVec2(glm::vec2 v) { return FixedVec2(v); }
+#else
+typedef GLfloat   Scalar;
+typedef glm::vec2 Vec2;
+inline Scalar    ToScalar(GLfloat x) { return x; }
+inline Vec2      ToVec2(glm::vec2 v) { return v; }
+#endif
+// Back to the state's float, from either number type
+inline GLfloat   ToFloat(GLfloat x) { return x; }
+inline GLfloat   ToFloat(Fixed x) { return x.ToFloat(); }
+inline glm::vec2 ToGlm(glm::vec2 v) { return v; }
+inline glm::vec2 ToGlm(FixedVec2 v) { return glm::vec2(v.x.ToFloat(), v.y.ToFloat()); }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <GL/glew.h>
+
+
+// FixedTimestep turns variable frame times into a whole number of
+// fixed-length simulation ticks. Leftover time is carried over to the
+// next frame and exposed as an interpolation factor for rendering.
+// To avoid a spiral of death at most MaxTicks ticks are run per frame;
+// any time beyond that is dropped.
+class FixedTimestep
+{
+public:
+    // Simulation ticks per second
+    GLdouble TickRate;
+    // Cap on the number of catch-up ticks run within a single frame
+    GLuint   MaxTicks;
+    // Constructor
+    FixedTimestep(GLdouble tickRate = 120.0, GLuint maxTicks = 8);
+    // Adds the elapsed frame time (in seconds) and returns how many ticks to run
+    GLuint  Advance(GLdouble frameTime);
+    // Length of a single tick in seconds
+    GLfloat Dt() const;
+    // Fraction of a tick left in the accumulator, in [0, 1)
+    GLfloat Alpha() const;
+private:
+    GLdouble accumulator;
+};
\ No newline at end of file
@@ -2,20 +2,45 @@
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
-#include <irrKlang/irrKlang.h>
+#include <cstring>
 #include <vector>
-#include <sstream>
 
-#include "resource_manager.h"
-#include "sprite_renderer.h"
+#include "collision.h"
 #include "game_level.h"
+#include "game_object.h"
 #include "ball_object.h"
-#include "particle_generator.h"
-#include "post_processor.h"
+#include "ball_pool.h"
 #include "powerup.h"
-#include "text_renderer.h"
+#include "game_event.h"
+#include "job_system.h"
+#include "physics_world.h"
+#include "random.h"
 
 
+// 初始化挡板的大小
+const glm::vec2 PLAYER_SIZE(100, 20);
+// 初始化挡板的速率
+const GLfloat PLAYER_VELOCITY(500.0f);
+// 初始化球的速度
+const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+// 球的半径
+const GLfloat BALL_RADIUS = 12.5f;
+// 每一步中球最多处理的碰撞次数
+const GLuint MAX_BOUNCES = 8;
+// 压力测试场景：球池中保持的球数和每个球的半径
+const GLuint  STRESS_BALLS = 10000;
+const GLfloat STRESS_BALL_RADIUS = 2.0f;
+
+// Mixes the raw bytes of a value into an FNV-1a hash (see Game::Checksum)
+template <typename T>
+void HashValue(std::uint32_t& hash, const T& value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char byte : bytes)
+        hash = (hash ^ byte) * 16777619u;
+}
+
 // Represents the current state of the game
 enum GameState {
     GAME_ACTIVE,
@@ -24,16 +49,13 @@ enum GameState {
     GAME_START
 };
 
-enum Direction {
-    UP,
-    RIGHT,
-    DOWN,
-    LEFT
-};
-
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// Game is pure simulation: it never touches GL, GLFW or the audio
+// device, so any number of instances can be stepped headless.
+// Side effects are only recorded in Events; rendering and audio read
+// them after each tick (see GameRenderer::HandleEvent).
 class Game
 {
 public:
@@ -46,22 +68,66 @@ public:
     std::vector<PowerUp> PowerUps;
     unsigned int Lives;
     bool KeyProcessed[1024];
+    // World objects
+    GameObject Player;
+    BallObject Ball;
+    // Extra balls of the multi-ball powerup; Ball stays the one that
+    // sticks to the paddle and costs a life when the pool is empty
+    BallPool   Balls;
+    // Collision bodies of the current tick, rebuilt from the objects above
+    PhysicsWorld Physics;
+    // Post-processing effects, toggled by the simulation and drawn by the renderer
+    GLboolean Confuse, Chaos;
+    // Per-world random generator driving every gameplay decision
+    Random        Rng;
+    std::uint64_t RandomSeed;
+    // Events of the last tick, cleared when the next one starts
+    GameEventQueue Events;
+    // Scheduler for the data-parallel parts of a tick, nullptr runs them inline
+    JobSystem*     Jobs;
+    // Rule switch: whether multi-ball powerups spawn. BatchedBreakout
+    // plays the rules with it off.
+    GLboolean      MultiBall;
+    // Stress scenario: while playing, the pool is topped up to this many balls
+    GLuint         StressBalls;
 
     // Constructor/Destructor
     Game(GLuint width, GLuint height);
     ~Game();
-    // Initialize game state (load all shaders/textures/levels)
+    // Initialize game state (load all levels, player and ball)
     void Init();
+    // Restart the random stream; the same seed and inputs replay the same game
+    void SetSeed(std::uint64_t seed);
+    // Applies a key press/release the way the window's key callback does
+    void SetKey(GLuint key, GLboolean pressed);
+    // Hash of the complete simulation state, used to detect replay divergence
+    std::uint32_t Checksum() const;
     // GameLoop
+    // Advance the simulation by one fixed tick (ProcessInput + Update)
+    void Tick(GLfloat dt);
     void ProcessInput(GLfloat dt);
     void Update(GLfloat dt);
-    void Render();
-    // Collision
-    void DoCollisions();
+    // Moves the ball through the step and responds to the contacts the
+    // PhysicsWorld finds: ball with paddle, paddle with powerups
+    void DoCollisions(GLfloat dt);
     // Reset
     void ResetLevel();
     void ResetPlayer();
     // Powerup
     void SpawnPowerUps(GameObject& block);
     void UpdatePowerUps(GLfloat dt);
+    // Adds count balls at random places below the bricks, flying upwards
+    void SpawnBalls(GLuint count);
+private:
+    // Sweeps a ball along its velocity for dt, bouncing off walls, bricks
+    // and the paddle in order of contact; a sticky ball becomes stuck when
+    // it hits the paddle. Returns whether the paddle was hit.
+    GLboolean sweepBall(glm::vec2& position, glm::vec2& velocity, GLfloat radius,
+        GLboolean sticky, GLboolean& stuck, GLfloat dt);
+    // Moves the pool's balls like sweepBall, drops the ones that fell out
+    // and lets all balls collide with each other
+    void sweepBalls(GLfloat dt);
+    void hitBrick(GLuint index, Vec2 normal, glm::vec2& velocity);
+    void bouncePaddle(glm::vec2 position, glm::vec2& velocity, GLfloat radius);
+    void activatePowerUp(PowerUp& powerUp);
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+
+// Gameplay events a tick can produce. The simulation only records
+// them; audio, particles, post-processing and statistics react to
+// them after the tick.
+enum GameEventType {
+    EVENT_BRICK_DESTROYED, // Index: brick, Position: brick position
+    EVENT_SOLID_HIT,       // Index: brick, Position: brick position
+    EVENT_PADDLE_HIT,      // Position: ball position
+    EVENT_POWERUP_COLLECTED, // Index: powerup in Game::PowerUps, Position: powerup position
+    EVENT_POWERUP_SPAWNED, // Index: type in POWERUP_TYPES, Position: brick position
+    EVENT_LIFE_LOST,       // Index: lives left
+    EVENT_LEVEL_COMPLETED  // Index: level
+};
+
+struct GameEvent
+{
+    GameEventType Type;
+    GLuint        Index;
+    glm::vec2     Position;
+};
+
+// Fixed-capacity list of the events of one tick. It never allocates;
+// events past the capacity are counted in Dropped instead of stored.
+class GameEventQueue
+{
+public:
+    static const GLuint CAPACITY = 64;
+    GLuint Dropped;
+
+    GameEventQueue() : Dropped(0), count(0) { }
+    void Push(GameEventType type, GLuint index, glm::vec2 position)
+    {
+        if (this->count == CAPACITY)
+        {
+            ++this->Dropped;
+            return;
+        }
+        GameEvent& event = this->events[this->count++];
+        event.Type = type;
+        event.Index = index;
+        event.Position = position;
+    }
+    void Clear() { this->count = 0; this->Dropped = 0; }
+    GLuint Size() const { return this->count; }
+    const GameEvent* begin() const { return this->events; }
+    const GameEvent* end() const { return this->events + this->count; }
+private:
+    GameEvent events[CAPACITY];
+    GLuint count;
+};
\ No newline at end of file
@@ -2,26 +2,83 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
+#include "collision.h"
+#include "collision_batch.h"
 #include "game_object.h"
-#include "sprite_renderer.h"
-#include "resource_manager.h"
 
 
+// λ1ڵλãwordΪ0
+inline GLuint LowestBit(std::uint64_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, static_cast<unsigned long>(word)))
+        return index;
+    _BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+    return index + 32;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
 class GameLevel
 {
 public:
     std::vector<GameObject> Bricks;
+    // שλͼiλӦBricks[i]1ʾδݻ
+    std::vector<std::uint64_t> Alive;
+    // ʣδݻٵķʵש
+    GLuint Remaining;
+    // שľÿӶӦؿļеһש
+    // ŸøשBricksе±꣬ոΪ-1
+    std::vector<GLint> Cells;
+    // ÿשİΧ (SoA)ոΪպУصʹ
+    BoxBatch CellBounds;
+    GLuint GridWidth, GridHeight;
+    glm::vec2 CellSize;
 
-    GameLevel() { }
+    GameLevel() : Remaining(0), GridWidth(0), GridHeight(0), CellSize(0.0f) { }
     // ļмعؿ
     void Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight);
-    // Ⱦؿ
-    void Draw(SpriteRenderer& renderer);
+    // שɹؿ
+    void Load(const std::vector<std::vector<GLuint>>& tileData, GLuint levelWidth, GLuint levelHeight);
     // һؿǷ (зǼӲĴשݻ)
-    GLboolean IsCompleted();
+    GLboolean IsCompleted() const { return this->Remaining == 0; }
+    GLboolean IsAlive(GLuint index) const { return (this->Alive[index >> 6] >> (index & 63)) & 1; }
+    // ݻһש飺λͼ񣬲ͬשDestroyed
+    void Destroy(GLuint index);
+    // ָһ鱻ݻٵש飬Destroy
+    void Revive(GLuint index);
+    // λͼÿשĴ״ֻ̬뵱ǰ״̬ͬש
+    void SetAlive(const std::uint64_t* alive);
+    // ָש飬¼عؿļĽͬ
+    void Reset();
+    // ζÿδݻٵש±fѴݻٵש
+    template <typename F>
+    void ForEachAlive(F f) const
+    {
+        for (GLuint word = 0; word < this->Alive.size(); ++word)
+            for (std::uint64_t bits = this->Alive[word]; bits; bits &= bits - 1)
+                f(word * 64 + LowestBit(bits));
+    }
+    // motionɨԲֻɨӷΧǵĸӡرhit.Time
+    // һδש±겢hitû򷵻-1
+    // 밴Bricks˳Ľȫһ¡
+    // aliveΪʱжשǷ (ͬĲ)Թһ
+    // ש鶼Ĺؿֻλͼ
+    // VΪglm::vec2FixedVec2ȷɨõֵ
+    template <typename V>
+    GLint SweepBricks(V center, typename V::value_type radius, V motion, BasicSweepHit<V>& hit,
+        const std::uint64_t* alive = nullptr) const;
 private:
+    // ÿשڵĸ
+    std::vector<GLuint> brickCells;
     // שݳʼؿ
-    void init(std::vector<std::vector<GLuint>> tileData, GLuint levelWidth, GLuint levelHeight);
+    void init(const std::vector<std::vector<GLuint>>& tileData, GLuint levelWidth, GLuint levelHeight);
 };
\ No newline at end of file
@@ -3,28 +3,25 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
-#include "texture.h"
-#include "sprite_renderer.h"
-
 
 // Container object for holding all state relevant for a single
 // game object entity. Each object in the game likely needs the
 // minimal of state as described within GameObject.
+// GameObject only holds simulation state; how it is drawn is
+// decided by the GameRenderer so the simulation never touches GL.
 class GameObject
 {
 public:
     // Object state
     glm::vec2   Position, Size, Velocity;
+    // Position at the start of the current tick, used to interpolate rendering
+    glm::vec2   PrevPosition;
     glm::vec3   Color;
     GLfloat     Rotation;
     GLboolean   IsSolid;
     GLboolean   Destroyed;
-    // Render state
-    Texture2D   Sprite;
     // Constructor(s)
     GameObject();
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, 
+    GameObject(glm::vec2 pos, glm::vec2 size, 
         glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    // Draw sprite
-    virtual void Draw(SpriteRenderer& renderer);
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <irrKlang/irrKlang.h>
+
+#include "game_event.h"
+#include "job_system.h"
+#include "render_snapshot.h"
+#include "sprite_renderer.h"
+#include "brick_renderer.h"
+#include "particle_generator.h"
+#include "gpu_particle_generator.h"
+#include "post_processor.h"
+#include "text_renderer.h"
+
+
+// GameRenderer owns every GL and audio resource of the game and
+// draws RenderSnapshots of it. It turns gameplay events into sounds and
+// screen shake, and runs the particles along the simulated ticks.
+// It never sees the Game itself, so the game may run on another thread.
+// All GL work happens in Init() and later, so it may be constructed
+// before a context exists.
+class GameRenderer
+{
+public:
+    // Constructor/Destructor. Particle updates are spread over jobs if given,
+    // or run on the GPU with gpuParticles. maxTicks is the most ticks the
+    // simulation catches up at once; particles catch up no further.
+    GameRenderer(GLuint width, GLuint height, JobSystem* jobs = nullptr, GLboolean gpuParticles = GL_FALSE,
+        GLuint maxTicks = 8);
+    ~GameRenderer();
+    // Load all shaders/textures/fonts and start the audio device
+    void Init();
+    // Render the given snapshot. Moving objects are drawn at alpha
+    // between their position at the start and the end of its tick.
+    void Render(const RenderSnapshot& snapshot, GLfloat time, GLfloat alpha = 1.0f);
+    // React to a gameplay event (sounds, screen shake)
+    void HandleEvent(const GameEvent& event);
+    // Advance particles and effects by the ticks simulated up to the
+    // snapshot, each dt seconds long
+    void Update(const RenderSnapshot& snapshot, GLfloat dt);
+    // Play a sound effect (or looping music) if an audio device exists
+    void PlaySound(const GLchar* file, GLboolean loop = GL_FALSE);
+private:
+    GLuint width, height;
+    JobSystem* jobs;
+    SpriteRenderer* renderer;
+    // Instanced bricks and the level whose bricks it holds (-1: none)
+    BrickRenderer* bricks;
+    GLint brickLevel;
+    // Exactly one of the two exists, depending on gpuParticles
+    ParticleGenerator* particles;
+    GpuParticleGenerator* gpuParticles;
+    GLboolean useGpuParticles;
+    PostProcessor* effects;
+    TextRenderer* text;
+    // Sprite of each powerup kind, indexed like POWERUP_TYPES
+    SpriteRegion powerupSprites[POWERUP_KINDS];
+    irrklang::ISoundEngine* soundEngine;
+    // Remaining screen shake time after hitting a solid brick
+    GLfloat shakeTime;
+    // Particles draw from their own stream of the game's seed so that
+    // rendering can never perturb the gameplay random sequence
+    Random particleRng;
+    std::uint64_t particleSeed;
+    // Tick of the snapshot the particles were last advanced to, and the
+    // most ticks they are advanced in one Update
+    std::uint64_t lastTick;
+    GLuint maxTicks;
+};
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+#include "shader.h"
+#include "texture.h"
+#include "game_object.h"
+#include "random.h"
+
+
+// Most emitters one simulation pass can respawn particles for
+const GLuint GPU_PARTICLE_EMITTERS = 16;
+// Outputs of the update program, in the layout of a particle's state
+extern const GLchar* const PARTICLE_VARYINGS[4];
+
+// GpuParticleGenerator behaves like ParticleGenerator, but its particles
+// never leave the GPU. Their state lives in two vertex buffers; each
+// Update runs a transform feedback pass reading one buffer and writing
+// the other, which respawns, moves and fades every particle. The CPU
+// only sends the emitters (position and velocity) of the tick and a seed
+// for the respawn jitter. Respawned particles take the slots after the
+// previously respawned ones, in a ring; as every particle lives equally
+// long, those are the oldest, dead first.
+// Needs OpenGL 3.3: the update program is linked with
+// ResourceManager::LoadFeedbackShader, capturing PARTICLE_VARYINGS.
+class GpuParticleGenerator
+{
+public:
+    // Constructor; updateShader simulates, shader draws
+    GpuParticleGenerator(Shader updateShader, Shader shader, Texture2D texture, GLuint amount);
+    // Destructor
+    ~GpuParticleGenerator();
+    // Respawn newParticles at object plus the ones queued by Spawn, then advance every particle by dt
+    void Update(GLfloat dt, const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset = glm::vec2(0.0f));
+    // Queue newParticles at object for the next Update, for objects beyond the one Update follows
+    void Spawn(const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset = glm::vec2(0.0f));
+    // Render all live particles
+    void Draw();
+private:
+    // Position and velocity the queued particles respawn with, and how many
+    std::vector<glm::vec4> emitters;
+    std::vector<GLint> emitterEnds;
+    GLuint queued;
+    GLuint amount;
+    // Ring slot of the next respawned particle, and the buffer holding the current state
+    GLuint nextParticle, current;
+    // Render state
+    Shader updateShader, shader;
+    Texture2D texture;
+    GLuint quadVBO, buffers[2], updateVAO[2], drawVAO[2];
+    // Uniform locations of the update program
+    GLint dtLocation, seedLocation, beginLocation, countLocation, emitterLocation, endLocation;
+    // Initializes buffers and vertex attributes
+    void init();
+    // Runs one transform feedback pass: respawns the queued particles, then advances all by dt
+    void simulate(GLfloat dt, Random& rng);
+};
\ No newline at end of file
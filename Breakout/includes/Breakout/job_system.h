@@ -0,0 +1,112 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Counts the unfinished jobs of one fork/join group
+struct JobCounter
+{
+    std::atomic<GLuint> Pending;
+    JobCounter() : Pending(0) { }
+};
+
+// A unit of work: Function(Data, Begin, End) processes the items [Begin, End)
+struct Job
+{
+    void      (*Function)(void* data, GLuint begin, GLuint end);
+    void*       Data;
+    GLuint      Begin, End;
+    JobCounter* Counter;
+};
+
+// JobSystem is a small work-stealing scheduler. Every thread owns a
+// deque of jobs: it pushes and pops its own work at the bottom while
+// idle threads steal the oldest (usually largest) jobs from the top of
+// another thread's deque. Threads that are not workers share deque 0.
+//
+// Fork/join: Run() queues a job against a JobCounter and Wait() runs
+// queued jobs itself until the counter drops to zero, so a waiting
+// thread never sits idle and jobs may fork and join nested work.
+// Nothing allocates after construction; when a deque is full the job
+// simply runs inline.
+class JobSystem
+{
+public:
+    // Constructor/Destructor. workers = 0 starts one worker per core
+    // besides the calling thread; pin binds worker i to core i + 1.
+    JobSystem(GLuint workers = 0, GLboolean pin = GL_FALSE);
+    ~JobSystem();
+    // Threads that run jobs, counting the calling thread
+    GLuint Concurrency() const;
+    // Fork: queue function(data, begin, end) on the calling thread's deque
+    void   Run(JobCounter& counter, void (*function)(void*, GLuint, GLuint), void* data, GLuint begin = 0, GLuint end = 0);
+    // Join: help run jobs until every job counted by counter has finished
+    void   Wait(JobCounter& counter);
+    // Calls f(begin, end) for chunks of at most grain items covering [0, count)
+    // on all threads and returns once they are done. Small ranges run inline.
+    template <typename F>
+    void   ParallelFor(GLuint count, GLuint grain, const F& f);
+    // Name a thread for debuggers and profilers
+    static void NameThread(std::thread& thread, const GLchar* name);
+    static void NameCurrentThread(const GLchar* name);
+    // Restrict a thread to a single core
+    static void PinThread(std::thread& thread, GLuint core);
+private:
+    // A mutex-guarded ring of jobs; the owner uses the bottom, thieves the top
+    struct Deque
+    {
+        static const GLuint CAPACITY = 1024;
+        std::mutex Lock;
+        Job        Jobs[CAPACITY];
+        GLuint     Top = 0, Bottom = 0;
+        GLboolean  Push(const Job& job);
+        GLboolean Pop(Job& job);
+        GLboolean Steal(Job& job);
+    };
+    std::vector<std::unique_ptr<Deque>> deques;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+    // Jobs sitting in any deque, and workers asleep waiting for one
+    std::atomic<GLint> queued, sleeping;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    // Body of worker thread index
+    void work(GLuint index);
+    // The deque owned by the calling thread
+    GLuint self() const;
+    // Pop a job from deque index, or steal one from another deque
+    GLboolean take(GLuint index, Job& job);
+    // Run a job and count it as finished
+    static void execute(const Job& job);
+    // Calls a ParallelFor body
+    template <typename F>
+    static void invoke(void* data, GLuint begin, GLuint end)
+    {
+        (*static_cast<const F*>(data))(begin, end);
+    }
+};
+
+template <typename F>
+void JobSystem::ParallelFor(GLuint count, GLuint grain, const F& f)
+{
+    grain = std::max(grain, 1u);
+    if (count <= grain || this->workers.empty())
+    {
+        if (count > 0)
+            f(0, count);
+        return;
+    }
+    // queue every chunk but the first, which this thread starts on right away
+    JobCounter counter;
+    for (GLuint begin = grain; begin < count; begin += grain)
+        this->Run(counter, &JobSystem::invoke<F>, const_cast<F*>(&f), begin, std::min(begin + grain, count));
+    f(0, grain);
+    this->Wait(counter);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GL/glew.h>
+
+
+// Monte Carlo difficulty analysis of a single level file, run from
+// breakout_sim with --analyze <file>. The level is loaded once through
+// GameLevel::Load; every game then plays its own copy of the world with
+// the AutoPlayer (game g is seeded with seed + g) until the level is
+// cleared or maxTicks pass, restarting through the menu after a game
+// over. Games are spread over a JobSystem (threads 0 = every core) and
+// only write their own result slot, so the report does not depend on
+// the thread count.
+//
+// Reports the game time a clear takes, lives lost, how often each
+// powerup type spawns and how many bricks one shot hits. Returns the
+// process exit code.
+int RunAnalyzer(const GLchar* file, GLuint width, GLuint height, unsigned int games, unsigned int maxTicks,
+    GLfloat dt, std::uint64_t seed, GLuint threads);
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "shader.h"
 #include "texture.h"
 #include "game_object.h"
+#include "job_system.h"
+#include "random.h"
 
 
 // Represents a single particle and its state
@@ -18,30 +20,44 @@ struct Particle
 	Particle() :Position(0.0f), Velocity(0.0f), Color(0.0f), Life(0.0f) { };
 };
 
+// What the shader needs to draw one live particle
+struct ParticleInstance
+{
+	glm::vec2 Offset;
+	glm::vec4 Color;
+};
+
 // ParticleGenerator acts as a container for rendering a large number of 
 // particles by repeatedly spawning and updating particles and killing 
-// them after a given amount of time.
+// them after a given amount of time. Draw gathers the live particles into
+// a streamed instance buffer and draws them all with one instanced call.
 class ParticleGenerator
 {
 public:
 	// Constructor
 	ParticleGenerator(Shader shader, Texture2D texture, GLuint amount);
-	// Update all particles
-	void Update(GLfloat dt, GameObject& object, GLuint newParticles, glm::vec2 offset = glm::vec2(0.0f));
-	// Render all particles
+	// Update all particles, drawing respawn jitter from rng; jobs spreads the update over its threads
+	void Update(GLfloat dt, const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset = glm::vec2(0.0f), JobSystem* jobs = nullptr);
+	// Add newParticles at object without updating the others, for objects beyond the one Update follows
+	void Spawn(const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset = glm::vec2(0.0f));
+	// Render all live particles
 	void Draw();
 private:
 	// State
 	std::vector<Particle> particles;
 	GLuint amount;
+	// Stores the index of the last particle used (for quick access to next dead particle)
+	GLuint lastUsedParticle;
 	// Render state
 	Shader shader;
 	Texture2D texture;
-	GLuint VAO;
+	GLuint VAO, instanceVBO;
+	// Live particles of the last Draw, room for all of them
+	std::vector<ParticleInstance> instances;
 	// Initializes buffer and vertex attributes
 	void init();
 	// Returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
 	GLuint firstUnusedParticle();
 	// Respawns particle
-	void respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset = glm::vec2(0.0f));
+	void respawnParticle(Particle& particle, const GameObject& object, Random& rng, glm::vec2 offset = glm::vec2(0.0f));
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "collision.h"
+#include "game_level.h"
+
+
+// What a body is; a body collides with the layers in its Mask
+enum PhysicsLayer {
+    LAYER_BALL    = 1,
+    LAYER_POWERUP = 2,
+    LAYER_PADDLE  = 4,
+    LAYER_BRICK   = 8
+};
+
+// The set the other body of a contact belongs to
+enum ContactKind {
+    CONTACT_WALL,      // the left, right or top edge of the world
+    CONTACT_STATIC,    // a brick, Other is its index in the level
+    CONTACT_KINEMATIC, // Other is an index in Kinematics
+    CONTACT_DYNAMIC    // Other is an index in Dynamics, always above Body
+};
+
+// A box or, with Radius > 0, a circle of diameter Size.x; Position is
+// the top left corner of its bounds in both cases
+struct PhysicsBody
+{
+    Vec2      Position, Size;
+    Scalar    Radius;
+    GLuint    Layer, Mask;
+    // Index of the game object the body stands for
+    GLuint    Owner;
+};
+
+// A dynamic body touching another body
+struct Contact
+{
+    GLuint      Body, Other;
+    ContactKind Kind;
+};
+
+// PhysicsWorld finds the collisions of one tick. Static bodies are the
+// bricks of a level, queried through its uniform grid; kinematic bodies
+// (the paddle) are moved by the game; dynamic bodies (balls, falling
+// powerups) are what collisions are found for. The world does not move
+// anything: the game adds its bodies after a Reset, asks for the first
+// contact of a moving circle with Sweep or for every overlapping pair
+// with FindContacts, and applies the responses itself.
+//
+// FindContacts runs sweep-and-prune over the kinematic and dynamic
+// bodies: they are sorted along x, an insertion sort that is linear when
+// the order barely changed since the last call, and a sweep keeps only
+// bodies whose x extents still overlap; a world of a few bodies just
+// tests every pair. Narrow tests use the same
+// arithmetic as CheckCollision, so results match it exactly.
+class PhysicsWorld
+{
+public:
+    // Walls on the left, right and top; the bottom edge at Height is open
+    Scalar                   Width, Height;
+    const GameLevel*         Statics;
+    std::vector<PhysicsBody> Kinematics, Dynamics;
+    // Result of FindContacts, ordered by Body, Kind, then Other
+    std::vector<Contact>     Contacts;
+
+    PhysicsWorld() : Width(0.0f), Height(0.0f), Statics(nullptr) { }
+    // Removes every kinematic and dynamic body and sets the level and walls
+    void      Reset(const GameLevel* statics, GLfloat width, GLfloat height);
+    // Adds a body and returns its index in Kinematics or Dynamics; the
+    // bounds are converted to the physics' number type
+    GLuint    AddKinematic(glm::vec2 position, glm::vec2 size, GLuint layer, GLuint mask, GLuint owner = 0);
+    GLuint    AddBox(glm::vec2 position, glm::vec2 size, GLuint layer, GLuint mask, GLuint owner = 0);
+    GLuint    AddCircle(glm::vec2 position, GLfloat radius, GLuint layer, GLuint mask, GLuint owner = 0);
+    // First contact of a circle moving from center along motion with the
+    // walls and the static and kinematic bodies in mask; fills hit (Time
+    // in [0, 1]) and contact, whose Body is unused. Ties go to the walls,
+    // then the bricks (in SweepBricks order), then the kinematic bodies.
+    GLboolean Sweep(Vec2 center, Scalar radius, GLuint mask, Vec2 motion,
+        SweepHit& hit, Contact& contact) const;
+    // Fills Contacts with the overlapping pairs of kinematic and dynamic
+    // bodies where either body's Mask has the other's Layer, skipping
+    // dynamic bodies below firstDynamic. Static bodies are only swept.
+    void      FindContacts(GLuint firstDynamic = 0);
+private:
+    // Sweep-and-prune state; ids below Kinematics.size() are kinematic
+    std::vector<GLuint>  order, active;
+    std::vector<Scalar>  minX, maxX;
+    const PhysicsBody& body(GLuint id) const;
+    void testPair(GLuint one, GLuint two, GLuint firstDynamic);
+    void sortContacts();
+};
\ No newline at end of file
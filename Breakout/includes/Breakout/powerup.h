@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "game_object.h"
 
 
@@ -7,6 +9,30 @@
 const glm::vec2 SIZE(60, 20);
 // Velocity a PowerUp block has when spawned
 const glm::vec2 VELOCITY(0.0f, 150.0f);
+// Every powerup type; snapshots, save states and events refer to a type by its index
+const GLchar* const POWERUP_TYPES[] = { "speed", "sticky", "pass-through", "pad-size-increase", "confuse", "chaos", "multi-ball" };
+const GLuint POWERUP_KINDS = 7;
+// The types before multi-ball, all that BatchedBreakout plays with
+const GLuint CLASSIC_POWERUP_KINDS = 6;
+// Per type: a destroyed brick spawns it with a chance of 1 in POWERUP_CHANCES,
+// it stays active for POWERUP_DURATIONS seconds (0 for instant effects)
+// and is drawn in POWERUP_COLORS. Negative powerups spawn more often.
+const GLuint    POWERUP_CHANCES[] = { 45, 30, 30, 30, 15, 15, 30 };
+const GLfloat   POWERUP_DURATIONS[] = { 0.0f, 20.0f, 10.0f, 0.0f, 15.0f, 15.0f, 0.0f };
+const glm::vec3 POWERUP_COLORS[] = {
+    glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 0.5f, 1.0f), glm::vec3(0.5f, 1.0f, 0.5f),
+    glm::vec3(1.0f, 0.6f, 0.4f), glm::vec3(1.0f, 0.3f, 0.3f), glm::vec3(0.9f, 0.25f, 0.25f),
+    glm::vec3(0.5f, 0.8f, 1.0f)
+};
+
+// Index of a powerup type in POWERUP_TYPES (0 for unknown types)
+inline GLuint PowerUpKind(const std::string& type)
+{
+    for (GLuint i = 0; i < POWERUP_KINDS; ++i)
+        if (type == POWERUP_TYPES[i])
+            return i;
+    return 0;
+}
 
 // PowerUp inherits its state and rendering functions from
 // GameObject but also holds extra information to state its
@@ -21,7 +47,7 @@ public:
 	GLboolean Activated;
 	// Constructor
 	PowerUp(std::string type, glm::vec3 color, GLfloat duration,
-		glm::vec2 position, Texture2D texture)
-		:GameObject(position, SIZE, texture, color, VELOCITY),
+		glm::vec2 position)
+		:GameObject(position, SIZE, color, VELOCITY),
 		Type(type), Duration(duration), Activated() { };
 };
\ No newline at end of file
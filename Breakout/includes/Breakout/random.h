@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Random is a small seedable PCG32 generator (XSH-RR, 64-bit state).
+// Every world owns its own instance instead of sharing the global rand(),
+// so worlds can run on any thread and replay exactly.
+//
+// Stream contract: for a given (seed, stream) pair, Next() returns the
+// reference PCG32 sequence on every platform and build, and Below()/
+// Float() are defined purely in terms of Next() with integer arithmetic.
+// Changing any of these functions changes every recorded game.
+class Random
+{
+public:
+    // Constructor
+    Random(std::uint64_t seed = 0x853c49e6748fea9bULL, std::uint64_t stream = 0xda3e39cb94b95bdbULL);
+    // Restarts the sequence for the given seed and stream
+    void          Seed(std::uint64_t seed, std::uint64_t stream = 0xda3e39cb94b95bdbULL);
+    // Next 32 random bits
+    std::uint32_t Next();
+    // Uniform integer in [0, bound), bound > 0
+    std::uint32_t Below(std::uint32_t bound);
+    // Uniform float in [0, 1) with 24 bits of precision
+    float         Float();
+    // Raw generator state, for save states
+    std::uint64_t State, Increment;
+};
\ No newline at end of file
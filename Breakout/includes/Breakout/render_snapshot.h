@@ -0,0 +1,54 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+
+// What the renderer needs to draw one object
+struct SpriteState
+{
+    glm::vec2 Position, PrevPosition, Size;
+    glm::vec3 Color;
+    GLfloat   Rotation;
+    // bricks: 1 for solid bricks; powerups: index in POWERUP_TYPES
+    GLuint    Kind;
+};
+
+// RenderSnapshot is a compact copy of everything the renderer draws,
+// taken after a simulation tick. It holds no pointers into the Game, so
+// it can be handed to another thread while the game keeps running.
+// Capturing into the same snapshot again reuses its vectors' storage.
+struct RenderSnapshot
+{
+    GameState State;
+    GLuint    Level, Lives;
+    GLboolean Confuse, Chaos;
+    SpriteState Player, Ball;
+    glm::vec2   BallVelocity;
+    GLfloat     BallRadius;
+    // Every brick of level BricksLevel in GameLevel order, destroyed ones
+    // included. Bricks never move, so they are only copied again when the
+    // level changes; BricksAlive says which of them are still standing.
+    std::vector<SpriteState>   Bricks;
+    std::vector<std::uint64_t> BricksAlive;
+    GLuint                     BricksLevel;
+    // Powerups that are still falling
+    std::vector<SpriteState> PowerUps;
+    // Balls of the ball pool; Kind is unused
+    std::vector<SpriteState> Balls;
+    // Seed of the game, so renderer-side randomness can follow it
+    std::uint64_t Seed;
+    // Ticks simulated so far and the time (in the simulation clock's
+    // seconds) at which the captured tick was due
+    std::uint64_t Tick;
+    GLdouble      Time;
+
+    RenderSnapshot();
+    // Copy the drawable state of game
+    void Capture(const Game& game);
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+#include "game.h"
+
+
+// Replays capture a session as the RNG seed plus every key transition,
+// tagged with the tick it applies to, and a checksum of the game state
+// after every tick. Feeding the same transitions to a freshly
+// initialized Game reproduces the session, and the checksums point at
+// the first tick where a replay diverges.
+//
+// File layout (varint = unsigned LEB128, fixed32 = little endian):
+//   "BKRP" | version:u8 | seed:varint | dt:fixed32 (float bits)
+//   | ticks:varint | events:varint
+//   | events x (tickDelta:varint, key << 1 | pressed:varint)
+//   | ticks x checksum:fixed32
+// tickDelta is the distance to the previous event's tick, so held keys
+// and idle stretches cost nothing.
+
+// A single recorded key transition
+struct ReplayEvent
+{
+    GLuint    Tick;
+    GLuint    Key;
+    GLboolean Pressed;
+};
+
+// ReplayRecorder collects key transitions and per-tick checksums while
+// a game is running and writes them to a replay file.
+class ReplayRecorder
+{
+public:
+    // Constructor
+    ReplayRecorder(std::uint64_t seed, GLfloat dt);
+    // Records a key transition that applies to the upcoming tick
+    void      Key(GLuint key, GLboolean pressed);
+    // Must be called after every Game::Tick
+    void      EndTick(const Game& game);
+    // Writes the replay to disk
+    GLboolean Save(const GLchar* file) const;
+private:
+    std::uint64_t seed;
+    GLfloat dt;
+    GLuint ticks, events, lastEventTick;
+    std::vector<std::uint8_t> eventBytes;
+    std::vector<std::uint32_t> checksums;
+};
+
+// ReplayPlayer feeds a recorded session back into a Game.
+class ReplayPlayer
+{
+public:
+    // Recorded session parameters
+    std::uint64_t Seed;
+    GLfloat       Dt;
+    GLuint        Ticks;
+    // Constructor
+    ReplayPlayer();
+    // Reads a replay file, returns GL_FALSE if it is missing or malformed
+    GLboolean Load(const GLchar* file);
+    // Applies the recorded input for the next tick, call before Game::Tick
+    void      BeginTick(Game& game);
+    // Checks the state after Game::Tick; returns GL_FALSE on a mismatch
+    GLboolean EndTick(const Game& game);
+    // Number of ticks played so far
+    GLuint    Tick() const;
+    // Whether every recorded tick has been played
+    GLboolean Done() const;
+private:
+    std::vector<ReplayEvent> events;
+    std::vector<std::uint32_t> checksums;
+    GLuint tick, nextEvent;
+};
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <GL/glew.h>
 
 #include "texture.h"
+#include "texture_array.h"
 #include "shader.h"
 
 
@@ -19,18 +20,32 @@ public:
     // Resource storage
     static std::map<std::string, Shader>    Shaders;
     static std::map<std::string, Texture2D> Textures;
+    // Sprites packed into one texture array, and their regions in it
+    static TextureArray                        SpriteArray;
+    static std::map<std::string, SpriteRegion> Sprites;
     // Loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code.
     // If gShaderFile is not nullptr, it also loads a geometry shader
     static Shader   LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, std::string name);
+    // Loads (and generates) a vertex-only shader program whose outputs named in varyings are captured by transform feedback
+    static Shader   LoadFeedbackShader(const GLchar* vShaderFile, const GLchar* const* varyings, GLsizei count, std::string name);
     // Retrieves a stored shader
     static Shader&   GetShader(std::string name);
     // Loads (and generates) a texture from file
     static Texture2D LoadTexture(const GLchar* file, GLboolean alpha, std::string name);
     // Retrieves a stored texture
     static Texture2D& GetTexture(std::string name);
+    // Queues a sprite image for packing into SpriteArray; its region is
+    // available once GenerateSprites has run
+    static void      LoadSprite(const GLchar* file, GLboolean alpha, std::string name);
+    // Packs and uploads every sprite loaded so far
+    static GLboolean GenerateSprites();
+    // Retrieves the region of a stored sprite
+    static SpriteRegion& GetSprite(std::string name);
     // Properly de-allocates all loaded resources
     static void      Clear();
 private:
+    // Index in SpriteArray of every sprite loaded so far
+    static std::map<std::string, GLuint> spriteIndices;
     // Private constructor, that is we do not want any actual resource manager objects.
     // Its members and functions should be publicly available (static).
     ResourceManager() { }
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game.h"
+
+
+// A save state is the complete simulation state of a Game as one flat
+// blob of plain data: a fixed header followed by the variable parts,
+// each starting on an 8 byte boundary:
+//   SaveStateHeader
+//   | Keys x u16        key | KEY_HELD | KEY_PROCESSED, for every key that is either
+//   | PowerUps x SavedPowerUp
+//   | Balls x SavedBall    the balls of Game::Balls
+//   | Bricks x u64      liveness words of the current level (full frames)
+//     or Bricks x u32   bricks flipped since the previous frame (delta frames, rewind only)
+// Only the current level's bricks are saved; every other level is in
+// its initial state whenever the game runs (ResetLevel restores a level
+// before it is left). Blobs are raw structs, so they can only be read by
+// the same build that wrote them.
+
+// Fixed-size part of a save state
+struct SaveStateHeader
+{
+    std::uint32_t Magic, Size;
+    GameState     State;
+    GLuint        Level, Lives;
+    GLboolean     Confuse, Chaos, Delta;
+    GameObject    Player;
+    BallObject    Ball;
+    std::uint64_t RngState, RngIncrement, RandomSeed;
+    std::uint32_t Keys, PowerUps, Balls, Bricks;
+};
+
+// A powerup in a save state, its type stored as the index in POWERUP_TYPES
+struct SavedPowerUp
+{
+    GameObject Object;
+    GLfloat    Duration;
+    GLuint     Kind;
+    GLboolean  Activated;
+};
+
+// A ball of the ball pool in a save state
+struct SavedBall
+{
+    GLfloat X, Y, VX, VY, PrevX, PrevY;
+};
+
+// SaveState holds one full save state of a Game. Capturing into the
+// same SaveState again reuses its storage.
+class SaveState
+{
+public:
+    std::vector<std::uint8_t> Bytes;
+    // Copy the complete simulation state of game
+    void      Capture(const Game& game);
+    // Put game back into the captured state; game must have the same
+    // levels loaded. Returns GL_FALSE if the blob does not fit it.
+    GLboolean Restore(Game& game) const;
+};
+
+// RewindBuffer keeps the last few seconds of a game, one frame per tick,
+// in memory that is allocated once. Frames are save states packed back
+// to back into a circular arena; the oldest ones are dropped as new ones
+// arrive. Most frames only store the bricks destroyed since the frame
+// before, with a full brick bitmap at least every keyframeInterval
+// frames, so a frame costs a few hundred bytes however large the level.
+// Restoring a frame rebuilds its bricks from the keyframe before it.
+class RewindBuffer
+{
+public:
+    // Keep up to ticks frames in an arena of bytes (0: 512 bytes per frame)
+    RewindBuffer(GLuint ticks, std::size_t bytes = 0, GLuint keyframeInterval = 60);
+    // Record the game's state, call after every Game::Tick
+    void        Record(const Game& game);
+    // Number of frames that can be restored
+    GLuint      Frames() const;
+    // Arena bytes used by those frames
+    std::size_t Bytes() const;
+    // Put game into the state recorded ago frames before the newest one
+    GLboolean   Restore(Game& game, GLuint ago);
+    // Restore and forget every newer frame, so recording continues from there
+    GLboolean   Rewind(Game& game, GLuint ago);
+    // Forget all frames
+    void        Clear();
+private:
+    // Where a frame lives in the arena
+    struct Frame
+    {
+        std::size_t Offset, Size;
+        GLboolean   Keyframe;
+    };
+    std::vector<std::uint8_t> arena;
+    std::vector<Frame> frames;
+    // Ring position of the oldest frame, frames held and the end of the newest one
+    GLuint first, count;
+    std::size_t writeOffset;
+    GLuint keyframeInterval, sinceKeyframe;
+    // Level and brick words of the newest frame, the base of the next delta
+    GLuint level;
+    std::vector<std::uint64_t> alive;
+    // Scratch space for deltas and restoring bricks
+    std::vector<std::uint32_t> flipped;
+    std::vector<std::uint64_t> bricks;
+    // The i-th oldest frame
+    Frame& frame(GLuint i);
+    // Find room for a frame of size bytes, dropping the oldest frames as needed
+    std::size_t allocate(std::size_t size);
+    // Drop the oldest frame and the delta frames that depended on it
+    void dropOldest();
+};
\ No newline at end of file
@@ -20,6 +20,9 @@ public:
     Shader& Use();
     // Compiles the shader from given source code
     void    Compile(const GLchar* vertexSource, const GLchar* fragmentSource, const GLchar* geometrySource = nullptr); // Note: geometry source code is optional 
+    // Compiles a vertex-only program whose outputs named in varyings are
+    // captured, interleaved in that order, by transform feedback
+    void    CompileFeedback(const GLchar* vertexSource, const GLchar* const* varyings, GLsizei count);
     // Utility functions
     void    SetFloat(const GLchar* name, GLfloat value, GLboolean useShader = false);
     void    SetInteger(const GLchar* name, GLint value, GLboolean useShader = false);
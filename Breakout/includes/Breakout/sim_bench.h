@@ -0,0 +1,34 @@
+#pragma once
+
+#include <GL/glew.h>
+
+
+// Micro benchmarks for the headless simulation, run from breakout_sim
+// with --bench <name>. Each prints a small table and returns the
+// process exit code (non-zero if an optimized path disagrees with the
+// straightforward version it replaces).
+//
+//   broadphase  GameLevel::SweepBricks grid query vs a linear scan over
+//               every brick, for levels of 100 to 100k bricks
+//   overlap     scalar, SSE2 and AVX2 batch circle-vs-box kernels vs
+//               CheckCollision, one brick at a time
+//   jobs        JobSystem fork/join cost per empty job and ParallelFor
+//               scaling on a particle update, 1 thread to every core
+//   savestate   SaveState capture/restore and RewindBuffer record/restore
+//               cost; restored states must replay to the same checksums
+//   throughput  the AutoPlayer clears levels one to four at full speed:
+//               ticks per second, ticks per level clear, allocations per tick
+//   batched     BatchedBreakout worlds must step exactly like a Game given
+//               the same keys; steps per second against Game::Tick
+//   raster      SoftwareRasterizer frames must not depend on the kernels
+//               or on drawing a Game or its batched world; frames per second
+//   physics     PhysicsWorld::FindContacts sweep-and-prune vs testing every
+//               pair of bodies, for 100 to 10k balls and powerups
+//   fixed       float vs fixed-point collision kernels; scripted games
+//               whose digest a fixed-point build must reproduce exactly
+//   multiball   SpatialHash ball pairs vs testing every pair; the 10k ball
+//               stress scenario's tick, snapshot and raster cost, and its
+//               digest, which a fixed-point build must reproduce
+//   replay      a recorded game must play back from its file; truncated
+//               files and oversized header counts must fail to load
+int RunBenchmark(const GLchar* name);
\ No newline at end of file
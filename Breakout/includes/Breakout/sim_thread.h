@@ -0,0 +1,79 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "fixed_timestep.h"
+#include "game.h"
+#include "render_snapshot.h"
+#include "replay.h"
+#include "save_state.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+
+// Holding this key plays the game backwards through the rewind buffer
+const GLuint REWIND_KEY = GLFW_KEY_BACKSPACE;
+
+// A key change sent from the window thread to the simulation
+struct KeyInput
+{
+    GLuint    Key;
+    GLboolean Pressed;
+};
+
+// SimThread steps a Game on its own thread at a fixed tick rate, so a
+// slow buffer swap or vsync wait on the window thread never delays the
+// physics. The two threads share nothing but three lock-free channels:
+//   - key changes go in through an SPSC queue and apply at the next tick
+//   - gameplay events come out through an SPSC queue, none are skipped
+//   - after each batch of ticks a RenderSnapshot is published through a
+//     triple buffer; the window thread always draws the newest one
+// While the thread runs, only it may touch the Game (and the recorder).
+// With a RewindBuffer every tick is recorded into it, and while
+// REWIND_KEY is held each tick steps one frame back instead. Rewinding
+// rewrites history, so it cannot be combined with a replay recorder.
+class SimThread
+{
+public:
+    // Constructor/Destructor
+    SimThread(Game& game, GLdouble tickRate = 120.0, GLuint maxTicks = 8, ReplayRecorder* recorder = nullptr,
+        RewindBuffer* rewind = nullptr);
+    ~SimThread();
+    // Start/stop the simulation thread. Stop waits for it to finish.
+    void Start();
+    void Stop();
+    // Window thread: queue a key change, returns false if the queue is full
+    GLboolean SendKey(GLuint key, GLboolean pressed);
+    // Window thread: take the next gameplay event, returns false when there is none
+    GLboolean PollEvent(GameEvent& event);
+    // Window thread: the newest complete snapshot
+    const RenderSnapshot& Snapshot();
+    // Window thread: how far the current time is past the snapshot's tick, in [0, 1]
+    GLfloat Alpha(const RenderSnapshot& snapshot) const;
+    // Length of a single tick in seconds
+    GLfloat Dt() const;
+private:
+    Game& game;
+    FixedTimestep timestep;
+    ReplayRecorder* recorder;
+    RewindBuffer* rewind;
+    // Whether REWIND_KEY is held, and the keys the player holds right now
+    GLboolean rewinding;
+    GLboolean held[1024];
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t ticks;
+    SpscQueue<KeyInput, 256> input;
+    SpscQueue<GameEvent, 1024> events;
+    TripleBuffer<RenderSnapshot> snapshots;
+    std::atomic<bool> running;
+    std::thread thread;
+    // Body of the simulation thread
+    void run();
+    // Publish the game's current state
+    void publish(GLdouble time);
+    // Seconds since the thread was created
+    GLdouble now() const;
+};
\ No newline at end of file
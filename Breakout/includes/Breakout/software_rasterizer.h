@@ -0,0 +1,80 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "batched_breakout.h"
+#include "game.h"
+
+
+// Layout of a rendered frame: one byte per pixel, or three (R, G, B)
+enum PixelFormat {
+    PIXELS_GRAY = 1,
+    PIXELS_RGB  = 3
+};
+
+// One mip level of a RasterTexture: premultiplied RGBA, one u32 per texel
+struct RasterImage
+{
+    GLuint Width, Height;
+    std::vector<std::uint32_t> Pixels;
+};
+
+// A sprite texture prepared for the rasterizer: mip levels from the full
+// image down to 1x1, each half the size of the one before
+struct RasterTexture
+{
+    std::vector<RasterImage> Levels;
+};
+
+// SoftwareRasterizer draws the playfield on the CPU into a small 8-bit
+// image, e.g. 84x84, for agents that learn from pixels. It needs no GL
+// context: it decodes the same textures as the GameRenderer and draws
+// the same sprites in the same order (background, bricks, paddle,
+// powerups, ball), tinted and alpha blended like sprite.fs. Text and
+// particles are left out; with ApplyConfuse the confuse effect of the
+// post-processor (colors inverted, picture turned upside down) is applied.
+//
+// A sprite covers the pixels whose centers it contains, like GL
+// rasterization. Each pixel takes the nearest texel of the mip level
+// closest to one texel per pixel. Bricks are small enough at agent
+// resolutions that filtering further buys nothing.
+// Blending and the final conversion run four pixels at a time with
+// SSE2 where the CPU has it; the scalar code gives the same bytes.
+//
+// Render reuses an internal canvas, so use one rasterizer per thread.
+class SoftwareRasterizer
+{
+public:
+    GLuint      Width, Height;
+    PixelFormat Format;
+    GLboolean   ApplyConfuse;
+    // Use the SSE2 kernels (GL_FALSE forces the scalar ones)
+    GLboolean   UseSimd;
+
+    // Constructor, fieldWidth x fieldHeight is the size of the playfield
+    SoftwareRasterizer(GLuint width, GLuint height, GLuint fieldWidth, GLuint fieldHeight,
+        PixelFormat format = PIXELS_RGB, GLboolean applyConfuse = GL_TRUE);
+    // Load the sprite textures from directory; prints an error and returns GL_FALSE if one is missing
+    GLboolean Load(const std::string& directory = "resources/textures");
+    // Draw the current tick of game into out, Width * Height * Format bytes
+    void      Render(const Game& game, GLubyte* out);
+    // Draw one world of a batch, as Render of the matching Game would
+    void      Render(const BatchedBreakout& batch, GLuint world, GLubyte* out);
+    // Whether the SSE2 kernels are compiled in
+    static GLboolean SimdAvailable();
+private:
+    glm::vec2                  scale;
+    std::vector<std::uint32_t> background, canvas;
+    std::vector<GLuint>        columns;
+    RasterTexture              block, blockSolid, paddle, face, powerups[POWERUP_KINDS];
+    // Copy the background into the canvas
+    void begin();
+    // Blend a sprite into the canvas
+    void draw(const RasterTexture& texture, glm::vec2 position, glm::vec2 size, glm::vec3 color);
+    // Convert the canvas into out, applying confuse if asked to
+    void finish(GLubyte* out, GLboolean confuse);
+};
\ No newline at end of file
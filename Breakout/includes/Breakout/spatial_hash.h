@@ -0,0 +1,63 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cmath>
+#include <vector>
+
+
+// SpatialHash buckets points by the square cell they fall into, with the
+// cells hashed into a table of twice as many buckets as points. Finding
+// every point near another only looks at the 3x3 cells around it, so
+// with cells as large as the largest distance of interest a query costs
+// the same however many points there are. Build sorts the points into
+// their buckets with a counting sort and keeps its storage, so building
+// again every tick does not allocate once the arrays have grown.
+//
+// A cell's bucket is its column plus its row times a stride near 0.618
+// of the table: the three cells of a row are three buckets in a row,
+// whose points lie next to each other in the sorted order, so a query
+// walks three runs of points instead of nine buckets. The stride keeps
+// the runs of neighbouring rows from overlapping.
+class SpatialHash
+{
+public:
+    // Constructor
+    SpatialHash();
+    // Buckets the count points (x[i], y[i]) into cells of cellSize
+    void Build(const GLfloat* x, const GLfloat* y, GLuint count, GLfloat cellSize);
+    // Calls f(index) for every point in the cells around (x, y) and the
+    // points that share their buckets, each point once
+    template <typename F>
+    void ForEachNear(GLfloat x, GLfloat y, const F& f) const;
+private:
+    GLfloat inverseCell;
+    GLuint  mask, rowStride;
+    // Points of bucket b are indices[starts[b]] to indices[starts[b + 1]]
+    std::vector<GLuint> starts, indices, buckets;
+    // Bucket of the cell (column, row)
+    GLuint bucket(GLint column, GLint row) const;
+};
+
+inline GLuint SpatialHash::bucket(GLint column, GLint row) const
+{
+    return (static_cast<GLuint>(column) + static_cast<GLuint>(row) * this->rowStride) & this->mask;
+}
+
+template <typename F>
+void SpatialHash::ForEachNear(GLfloat x, GLfloat y, const F& f) const
+{
+    if (this->starts.empty())
+        return;
+    GLint column = static_cast<GLint>(std::floor(x * this->inverseCell));
+    GLint row = static_cast<GLint>(std::floor(y * this->inverseCell));
+    for (GLint dy = -1; dy <= 1; ++dy)
+    {
+        GLuint first = this->bucket(column - 1, row + dy);
+        // the run of three buckets may wrap around the end of the table
+        GLuint last = first + 3 <= this->mask + 1 ? first + 3 : this->mask + 1;
+        for (GLuint i = this->starts[first]; i < this->starts[last]; ++i)
+            f(this->indices[i]);
+        for (GLuint i = 0; i < this->starts[first + 3 - last]; ++i)
+            f(this->indices[i]);
+    }
+}
\ No newline at end of file
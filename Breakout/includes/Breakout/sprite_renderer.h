@@ -3,25 +3,72 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <vector>
 
 #include "shader.h"
 #include "texture.h"
+#include "texture_array.h"
 
 
+// A corner of a batched sprite: screen position, texture coordinates,
+// color and texture array layer (negative for a plain 2D texture)
+struct SpriteVertex
+{
+    GLfloat X, Y, U, V;
+    GLfloat R, G, B, Layer;
+};
+
+// SpriteRenderer draws textured quads. Outside Begin/End every
+// DrawSprite is drawn at once with its own draw call (immediate mode).
+// Between Begin and End, DrawSprite only computes the sprite's four
+// corners on the CPU and queues them; the queue is drawn with one draw
+// call when the texture changes, when it is full, or on Flush and End.
+// Sprites are drawn in the order they were queued, so anything drawn
+// with other GL state while batching must be preceded by a Flush.
+// Sprites of one TextureArray share a texture, so any mix of them is
+// drawn with a single draw call.
 class SpriteRenderer
 {
 public:
-    // Constructor (inits shaders/shapes)
+    // Draw calls issued and sprites drawn since the last Begin
+    GLuint DrawCalls, Sprites;
+    // Constructor (inits shaders/shapes); batchShader draws the queued
+    // sprites, without it Begin is ignored and every sprite is immediate
     SpriteRenderer(Shader& shader);
+    SpriteRenderer(Shader& shader, Shader& batchShader, GLuint maxSprites = 2048);
     // Destructor
     ~SpriteRenderer();
     // Renders a defined quad textured with given sprite
     void DrawSprite(Texture2D& texture, glm::vec2 position, 
         glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Renders a sprite of a texture array; needs the batch shader, and is
+    // drawn at once outside Begin/End like any other sprite
+    void DrawSprite(const TextureArray& sprites, const SpriteRegion& region, glm::vec2 position,
+        glm::vec2 size = glm::vec2(10, 10), GLfloat rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Starts queuing sprites
+    void Begin();
+    // Draws the queued sprites
+    void Flush();
+    // Draws the queued sprites and returns to immediate mode
+    void End();
 private:
     // Render state
     Shader shader;
     GLuint quadVAO;
+    // Batch state: the streamed vertex buffer and a fixed index buffer
+    // holding two triangles for each of maxSprites quads
+    Shader batchShader;
+    GLuint batchVAO, batchVBO, batchEBO;
+    GLuint maxSprites;
+    GLboolean batching;
+    // Texture of the queued sprites, and whether it is a texture array
+    GLuint batchTexture;
+    GLboolean batchArray;
+    std::vector<SpriteVertex> vertices;
     // Initializes and configures the quad's buffer and vertex attributes
     void initRenderData();
-};
+    void initBatchData();
+    // Queues a sprite's four corners, flushing first if the texture changes or the queue is full
+    void queue(GLuint texture, GLboolean array, const glm::vec4& uv, GLfloat layer,
+        glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color);
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+
+
+// SpscQueue is a bounded lock-free ring buffer for exactly one
+// producer thread and one consumer thread. Capacity must be a power of
+// two. Neither side ever blocks or allocates: Push fails when the queue
+// is full and Pop fails when it is empty.
+template <typename T, unsigned Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+public:
+    SpscQueue() : head(0), tail(0) { }
+    // Producer: append a value, returns false if the queue is full
+    bool Push(const T& value)
+    {
+        unsigned t = this->tail.load(std::memory_order_relaxed);
+        if (t - this->head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        this->items[t & (Capacity - 1)] = value;
+        this->tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer: take the oldest value, returns false if the queue is empty
+    bool Pop(T& value)
+    {
+        unsigned h = this->head.load(std::memory_order_relaxed);
+        if (h == this->tail.load(std::memory_order_acquire))
+            return false;
+        value = this->items[h & (Capacity - 1)];
+        this->head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+private:
+    // the indices only ever grow; they live on separate cache lines so
+    // the two threads do not fight over one line
+    alignas(64) std::atomic<unsigned> head;
+    alignas(64) std::atomic<unsigned> tail;
+    T items[Capacity];
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+
+// Where a sprite lives in a TextureArray: the layer and the texture
+// coordinates <u0, v0, u1, v1> of its rectangle in that layer
+struct SpriteRegion
+{
+    GLuint    Layer;
+    glm::vec4 UV;
+    SpriteRegion() : Layer(0), UV(0.0f, 0.0f, 1.0f, 1.0f) { }
+};
+
+// TextureArray packs sprite images of any size into the layers of one
+// GL_TEXTURE_2D_ARRAY, so that sprites of different images can be drawn
+// with a single bound texture. Images are queued with Add, then Generate
+// shelf-packs them into square layers of LayerSize texels and uploads
+// them. Each image gets a one texel border copied from its opposite
+// edges, so linear filtering at the rim of its rectangle samples what
+// GL_REPEAT would sample on a texture of its own.
+class TextureArray
+{
+public:
+    // Holds the ID of the texture object, 0 until Generate
+    GLuint ID;
+    // Width and height of every layer, and the number of layers in use
+    GLuint LayerSize, Layers;
+    // Filtering modes
+    GLuint Filter_Min, Filter_Max;
+    // Constructor (no GL work, so it may exist before a context does)
+    TextureArray(GLuint layerSize = 1024);
+    // Queues an RGBA image of width*height texels, returns its index
+    GLuint Add(GLuint width, GLuint height, const unsigned char* rgba);
+    // Packs and uploads all queued images; fails if one is larger than a layer
+    GLboolean Generate();
+    // Region of the image with the given index, valid after Generate
+    const SpriteRegion& Region(GLuint index) const;
+    // Binds the array as the current active GL_TEXTURE_2D_ARRAY texture object
+    void Bind() const;
+    // Deletes the texture object and every queued image
+    void Clear();
+private:
+    struct Image
+    {
+        GLuint Width, Height;
+        std::vector<unsigned char> Pixels;
+    };
+    std::vector<Image> images;
+    std::vector<SpriteRegion> regions;
+};
\ No newline at end of file
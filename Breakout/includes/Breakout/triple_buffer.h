@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+
+// TripleBuffer hands complete values from one writer thread to one
+// reader thread without locks or copies. The writer fills Back() and
+// publishes it; the reader calls Update() and then reads Front(), which
+// is always the newest published value. Neither side waits: the writer
+// overwrites values the reader skipped, and the reader keeps the old
+// value while nothing new has been published.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back(0), front(2), middle(1) { }
+    // Writer: the slot to fill next
+    T& Back() { return this->slots[this->back]; }
+    // Writer: publish the back slot and continue with a free one
+    void Publish()
+    {
+        this->back = this->middle.exchange(this->back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+    // Reader: switch to the newest published slot, returns whether there was one
+    bool Update()
+    {
+        if (!(this->middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        this->front = this->middle.exchange(this->front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    // Reader: the slot read by the last Update
+    const T& Front() const { return this->slots[this->front]; }
+private:
+    // middle holds a slot index plus a flag telling whether the writer
+    // published it since the reader last took it
+    static const unsigned INDEX = 3, FRESH = 4;
+    T slots[3];
+    unsigned back, front;
+    std::atomic<unsigned> middle;
+};
\ No newline at end of file
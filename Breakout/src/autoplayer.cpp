@@ -0,0 +1,131 @@
+#include "autoplayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+// Horizontal speed Game::bouncePaddle gives the ball for a hit at the paddle's edge
+const GLfloat EDGE_SPEED = 200.0f;
+// Furthest from the center (as a fraction of half the paddle) the ball is hit
+const GLfloat MAX_OFFSET = 0.8f;
+// Hit offsets tried when planning
+const GLuint PLAN_OFFSETS = 17;
+// Movement keys
+const GLuint MOVE_KEYS[3] = { GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_SPACE };
+
+AutoPlayer::AutoPlayer(GLuint level)
+    : level(level), offset(0.0f), falling(GL_FALSE), falls(0) { }
+
+void AutoPlayer::Update(Game& game, GLfloat dt, ReplayRecorder* recorder)
+{
+    if (game.State != GAME_ACTIVE)
+    {
+        for (GLuint key : MOVE_KEYS)
+            this->press(game, key, GL_FALSE, recorder);
+        this->falling = GL_FALSE;
+        // pick the level in the menu, every other screen continues with enter
+        if (game.State == GAME_MENU && game.Level != this->level % game.Levels.size())
+            this->tap(game, GLFW_KEY_W, recorder);
+        else
+            this->tap(game, GLFW_KEY_ENTER, recorder);
+        return;
+    }
+    this->press(game, GLFW_KEY_ENTER, GL_FALSE, recorder);
+    this->press(game, GLFW_KEY_W, GL_FALSE, recorder);
+
+    GLfloat landing = PredictLanding(game);
+    if (game.Ball.Velocity.y > 0.0f && !this->falling)
+    {
+        ++this->falls;
+        this->plan(game, landing);
+    }
+    this->falling = game.Ball.Velocity.y > 0.0f;
+    GLfloat half = game.Player.Size.x / 2;
+    GLfloat target = std::max(half, std::min(landing - this->offset * half, game.Width - half));
+    GLfloat paddle = game.Player.Position.x + game.Player.Size.x / 2;
+    // stop within half a tick's movement, so the paddle does not jitter around the target
+    GLfloat slack = 250.0f * dt;
+    this->press(game, GLFW_KEY_A, paddle > target + slack, recorder);
+    this->press(game, GLFW_KEY_D, paddle < target - slack, recorder);
+    this->press(game, GLFW_KEY_SPACE, game.Ball.Stuck, recorder);
+}
+
+GLfloat AutoPlayer::PredictLanding(const Game& game)
+{
+    const BallObject& ball = game.Ball;
+    glm::vec2 center = ball.Position + ball.Radius;
+    GLfloat contact = game.Player.Position.y - ball.Radius;
+    // vertical distance until the ball is back at the paddle, via the ceiling if it is rising
+    GLfloat distance = ball.Velocity.y > 0.0f ? contact - center.y : (center.y - ball.Radius) + (contact - ball.Radius);
+    if (ball.Velocity.y == 0.0f || distance < 0.0f)
+        return center.x;
+    GLfloat x = center.x + ball.Velocity.x * distance / std::abs(ball.Velocity.y);
+    // fold the straight path back into the playfield, the side walls mirror it
+    GLfloat span = game.Width - 2.0f * ball.Radius;
+    GLfloat offset = std::fmod(x - ball.Radius, 2.0f * span);
+    if (offset < 0.0f)
+        offset += 2.0f * span;
+    if (offset > span)
+        offset = 2.0f * span - offset;
+    return ball.Radius + offset;
+}
+
+void AutoPlayer::press(Game& game, GLuint key, GLboolean pressed, ReplayRecorder* recorder)
+{
+    if (game.Keys[key] == pressed)
+        return;
+    game.SetKey(key, pressed);
+    if (recorder)
+        recorder->Key(key, pressed);
+}
+
+void AutoPlayer::tap(Game& game, GLuint key, ReplayRecorder* recorder)
+{
+    this->press(game, key, !game.Keys[key], recorder);
+}
+
+void AutoPlayer::plan(const Game& game, GLfloat landing)
+{
+    const GameLevel& level = game.Levels[game.Level];
+    const BallObject& ball = game.Ball;
+    glm::vec2 contact(landing, game.Player.Position.y - ball.Radius);
+    GLfloat bottom = level.GridHeight * level.CellSize.y;
+    GLfloat best = std::numeric_limits<GLfloat>::max();
+    for (GLuint i = 0; i < PLAN_OFFSETS; ++i)
+    {
+        // try the offsets from the center outwards, so ties prefer gentle angles
+        GLint step = static_cast<GLint>(i + 1) / 2 * (i % 2 ? 1 : -1);
+        GLfloat offset = MAX_OFFSET * step / (PLAN_OFFSETS / 2);
+        // bouncePaddle turns the offset into a horizontal speed and keeps the vertical one
+        glm::vec2 direction(EDGE_SPEED * offset, -std::abs(ball.Velocity.y));
+        if (direction.y == 0.0f)
+            return;
+        direction /= -direction.y;
+        // follow the path up to the level in one sweep, then a row of bricks at a time,
+        // so every sweep only looks at a few cells
+        glm::vec2 position = contact;
+        GLfloat rise = 0.0f;
+        while (rise < best && position.y > ball.Radius && position.x > ball.Radius && position.x < game.Width - ball.Radius)
+        {
+            GLfloat length = std::min(position.y > bottom ? position.y - bottom + 1.0f : level.CellSize.y, position.y - ball.Radius);
+            // planning only needs to be close, so it stays in float in a fixed-point build too
+            BasicSweepHit<glm::vec2> hit = { 1.0f, glm::vec2(0.0f) };
+            GLint brick = level.SweepBricks(position, ball.Radius, direction * length, hit);
+            if (brick >= 0)
+            {
+                if (!level.Bricks[brick].IsSolid && rise + hit.Time * length < best)
+                {
+                    best = rise + hit.Time * length;
+                    this->offset = offset;
+                }
+                break;
+            }
+            position += direction * length;
+            rise += length;
+        }
+    }
+    // every path runs into solid bricks: vary the angle, so the ball does not repeat itself
+    if (best == std::numeric_limits<GLfloat>::max())
+        this->offset = MAX_OFFSET * (static_cast<GLint>(this->falls % 5) - 2) / 2.0f;
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "ball_pool.h"
+
+#include <algorithm>
+
+
+// Cells a little larger than a ball, so rounding in the float cell
+// lookup never puts two touching balls more than one cell apart
+const GLfloat CELL_SLACK = 1.0f;
+// Balls per job of the pair search; only the stress scenario has enough to split
+const GLuint PAIR_GRAIN = 1024;
+
+
+BallPool::BallPool(GLfloat radius) : Radius(radius) { }
+
+GLuint BallPool::Size() const
+{
+    return static_cast<GLuint>(this->X.size());
+}
+
+void BallPool::Add(glm::vec2 position, glm::vec2 velocity)
+{
+    this->X.push_back(position.x);
+    this->Y.push_back(position.y);
+    this->VX.push_back(velocity.x);
+    this->VY.push_back(velocity.y);
+    this->PrevX.push_back(position.x);
+    this->PrevY.push_back(position.y);
+}
+
+void BallPool::Remove(GLuint index)
+{
+    GLuint last = this->Size() - 1;
+    this->X[index] = this->X[last];
+    this->Y[index] = this->Y[last];
+    this->VX[index] = this->VX[last];
+    this->VY[index] = this->VY[last];
+    this->PrevX[index] = this->PrevX[last];
+    this->PrevY[index] = this->PrevY[last];
+    this->X.pop_back();
+    this->Y.pop_back();
+    this->VX.pop_back();
+    this->VY.pop_back();
+    this->PrevX.pop_back();
+    this->PrevY.pop_back();
+}
+
+void BallPool::Clear()
+{
+    this->X.clear();
+    this->Y.clear();
+    this->VX.clear();
+    this->VY.clear();
+    this->PrevX.clear();
+    this->PrevY.clear();
+}
+
+void BallPool::StorePrevious()
+{
+    this->PrevX.assign(this->X.begin(), this->X.end());
+    this->PrevY.assign(this->Y.begin(), this->Y.end());
+}
+
+GLuint BallPool::Collide(BallObject* other, JobSystem* jobs)
+{
+    GLuint count = this->Size(), total = count + (other ? 1 : 0);
+    if (total < 2)
+        return 0;
+    // other takes part as ball number count
+    auto position = [this, other, count](GLuint i) {
+        return i < count ? glm::vec2(this->X[i], this->Y[i]) : other->Position;
+    };
+    auto velocity = [this, other, count](GLuint i) {
+        return i < count ? glm::vec2(this->VX[i], this->VY[i]) : other->Velocity;
+    };
+    this->cornerX.resize(total);
+    this->cornerY.resize(total);
+    this->corners.resize(total);
+    for (GLuint i = 0; i < total; ++i)
+    {
+        glm::vec2 p = position(i);
+        this->cornerX[i] = p.x;
+        this->cornerY[i] = p.y;
+        this->corners[i] = ToVec2(p);
+    }
+    // only the pool goes into the grid, so its cells stay as small as its
+    // balls whatever the size of other
+    this->grid.Build(this->cornerX.data(), this->cornerY.data(), count, this->Radius * 2.0f + CELL_SLACK);
+
+    // every touching pair once, found before any of them moves. Most
+    // candidates are rejected at random, so each one is written and only
+    // kept by advancing the end, which spares a mispredicted branch.
+    Scalar diameter = ToScalar(this->Radius * 2.0f), reach = diameter * diameter;
+    const Vec2* corners = this->corners.data();
+    auto keep = [](std::vector<std::uint64_t>& pairs, size_t& found, GLuint i, GLuint j, Vec2 offset, Scalar reach) {
+        if (found == pairs.size())
+            pairs.resize(found * 2 + 64);
+        pairs[found] = static_cast<std::uint64_t>(i) << 32 | j;
+        found += j > i && Dot(offset, offset) <= reach;
+    };
+    // the grid is only read, so chunks of balls search in parallel, each
+    // into its own list; the sort below makes the order they finish in moot
+    GLuint chunks = (count + PAIR_GRAIN - 1) / PAIR_GRAIN;
+    this->chunkPairs.resize(std::max(chunks, 1u));
+    this->chunkFound.resize(std::max(chunks, 1u));
+    auto search = [&](GLuint begin, GLuint end) {
+        GLuint chunk = begin / PAIR_GRAIN;
+        std::vector<std::uint64_t>& pairs = this->chunkPairs[chunk];
+        size_t found = 0;
+        for (GLuint i = begin; i < end; ++i)
+        {
+            Vec2 one = corners[i];
+            this->grid.ForEachNear(this->cornerX[i], this->cornerY[i], [&](GLuint j) {
+                keep(pairs, found, i, j, corners[j] - one, reach);
+            });
+        }
+        this->chunkFound[chunk] = found;
+    };
+    if (jobs)
+        jobs->ParallelFor(count, PAIR_GRAIN, search);
+    else
+        for (GLuint begin = 0; begin < count; begin += PAIR_GRAIN)
+            search(begin, std::min(begin + PAIR_GRAIN, count));
+    size_t found = 0;
+    for (GLuint chunk = 0; chunk < chunks; ++chunk)
+        found += this->chunkFound[chunk];
+    if (this->pairs.size() < found)
+        this->pairs.resize(found);
+    found = 0;
+    for (GLuint chunk = 0; chunk < chunks; ++chunk)
+    {
+        std::copy(this->chunkPairs[chunk].begin(), this->chunkPairs[chunk].begin() + this->chunkFound[chunk],
+            this->pairs.begin() + found);
+        found += this->chunkFound[chunk];
+    }
+    // other's radius may differ from the pool's, so it is tested against
+    // every ball, center to center
+    Scalar shift = 0.0f, contact = diameter;
+    if (other)
+    {
+        shift = ToScalar(other->Radius - this->Radius);
+        contact = ToScalar(other->Radius + this->Radius);
+        for (GLuint i = 0; i < count; ++i)
+            keep(this->pairs, found, i, count, corners[count] - corners[i] + shift, contact * contact);
+    }
+    this->pairs.resize(found);
+    // the hash visits buckets in no particular order; resolving in index
+    // order keeps the outcome independent of how the cells were hashed
+    std::sort(this->pairs.begin(), this->pairs.end());
+
+    GLuint resolved = 0;
+    for (std::uint64_t pair : this->pairs)
+    {
+        GLuint i = static_cast<GLuint>(pair >> 32), j = static_cast<GLuint>(pair);
+        // pool balls share a radius, so their corners are as far apart as
+        // their centers; other's center is shift further along both axes
+        Scalar touch = j < count ? diameter : contact;
+        Vec2 one = ToVec2(position(i)), two = ToVec2(position(j));
+        Vec2 offset = j < count ? two - one : two - one + shift;
+        Scalar distance = Length(offset);
+        // an earlier pair may have pushed these two apart already
+        if (distance > touch || distance == 0.0f)
+            continue;
+        Vec2 normal = offset / distance;
+        Vec2 push = normal * ((touch - distance) / 2.0f);
+        one -= push;
+        two += push;
+        Vec2 oneVelocity = ToVec2(velocity(i)), twoVelocity = ToVec2(velocity(j));
+        Scalar approach = Dot(oneVelocity - twoVelocity, normal);
+        if (approach > 0.0f)
+        {
+            oneVelocity -= normal * approach;
+            twoVelocity += normal * approach;
+        }
+        glm::vec2 results[4] = { ToGlm(one), ToGlm(two), ToGlm(oneVelocity), ToGlm(twoVelocity) };
+        for (GLuint k = 0; k < 2; ++k)
+        {
+            GLuint ball = k == 0 ? i : j;
+            if (ball < count)
+            {
+                this->X[ball] = results[k].x;
+                this->Y[ball] = results[k].y;
+                this->VX[ball] = results[k + 2].x;
+                this->VY[ball] = results[k + 2].y;
+            }
+            else
+            {
+                other->Position = results[k];
+                other->Velocity = results[k + 2];
+            }
+        }
+        ++resolved;
+    }
+    return resolved;
+}
@@ -0,0 +1,397 @@
+#include "batched_breakout.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Worlds stepped by one job
+const GLuint WORLD_GRAIN = 256;
+
+
+BatchedBreakout::BatchedBreakout(const GameLevel& level, GLuint worlds, GLuint width, GLuint height,
+    std::uint64_t seed, unsigned int maxTicks)
+    : Worlds(worlds), Width(width), Height(height), MaxTicks(maxTicks), Level(level),
+    AliveWords(static_cast<GLuint>(level.Alive.size())),
+    BallX(worlds), BallY(worlds), BallVX(worlds), BallVY(worlds), Stuck(worlds), Sticky(worlds), PassThrough(worlds),
+    PaddleX(worlds), PaddleWidth(worlds), PaddleY(height - PLAYER_SIZE.y),
+    Lives(worlds), Remaining(worlds), Alive(worlds * level.Alive.size()), Confuse(worlds), Chaos(worlds),
+    PowerUpCount(worlds), PowerUpsDropped(worlds), PowerUpX(worlds * POWERUP_SLOTS), PowerUpY(worlds * POWERUP_SLOTS),
+    PowerUpDuration(worlds * POWERUP_SLOTS), PowerUpType(worlds * POWERUP_SLOTS),
+    PowerUpActivated(worlds * POWERUP_SLOTS), PowerUpDestroyed(worlds * POWERUP_SLOTS),
+    Rng(worlds), Seeds(worlds), Ticks(worlds), Rewards(worlds), Dones(worlds), Jobs(nullptr)
+{
+    // every world starts from the full level, whatever state it was given in
+    this->Level.Reset();
+    for (GLuint w = 0; w < worlds; ++w)
+        this->Reset(w, seed + w);
+}
+
+void BatchedBreakout::Reset(GLuint world, std::uint64_t seed)
+{
+    this->Seeds[world] = seed;
+    this->Rng[world].Seed(seed);
+    this->Ticks[world] = 0;
+    this->Lives[world] = 3;
+    this->Remaining[world] = this->Level.Remaining;
+    std::copy(this->Level.Alive.begin(), this->Level.Alive.end(), this->Alive.begin() + world * this->AliveWords);
+    this->PowerUpCount[world] = 0;
+    this->resetPlayer(world);
+}
+
+void BatchedBreakout::resetPlayer(GLuint w)
+{
+    this->PaddleWidth[w] = PLAYER_SIZE.x;
+    this->PaddleX[w] = (this->Width - PLAYER_SIZE.x) / 2;
+    this->BallX[w] = this->PaddleX[w] + (this->PaddleWidth[w] / 2 - BALL_RADIUS);
+    this->BallY[w] = this->PaddleY + -BALL_RADIUS * 2;
+    this->BallVX[w] = INITIAL_BALL_VELOCITY.x;
+    this->BallVY[w] = INITIAL_BALL_VELOCITY.y;
+    this->Stuck[w] = GL_TRUE;
+    this->Sticky[w] = this->PassThrough[w] = GL_FALSE;
+    this->Confuse[w] = this->Chaos[w] = GL_FALSE;
+}
+
+void BatchedBreakout::Step(const GLubyte* actions, GLfloat dt)
+{
+    if (this->Jobs)
+        this->Jobs->ParallelFor(this->Worlds, WORLD_GRAIN, [this, actions, dt](GLuint begin, GLuint end) {
+            this->stepRange(actions, dt, begin, end);
+        });
+    else
+        this->stepRange(actions, dt, 0, this->Worlds);
+}
+
+void BatchedBreakout::stepRange(const GLubyte* actions, GLfloat dt, GLuint begin, GLuint end)
+{
+    // Same order as Game::Tick. Moving the powerups only depends on the
+    // collisions of their own world, so it can run for the whole range at once.
+    std::fill(this->Rewards.begin() + begin, this->Rewards.begin() + end, 0.0f);
+    std::fill(this->Dones.begin() + begin, this->Dones.begin() + end, static_cast<GLubyte>(EPISODE_RUNNING));
+    this->moveRange(actions, dt, begin, end);
+    for (GLuint w = begin; w < end; ++w)
+        this->collide(w, dt);
+    this->advancePowerUps(dt, begin, end);
+    for (GLuint w = begin; w < end; ++w)
+    {
+        this->expirePowerUps(w);
+        if (this->Dones[w] == EPISODE_RUNNING && this->Remaining[w] == 0)
+            this->Dones[w] = EPISODE_CLEARED;
+        ++this->Ticks[w];
+        if (this->Dones[w] == EPISODE_RUNNING && this->MaxTicks && this->Ticks[w] >= this->MaxTicks)
+            this->Dones[w] = EPISODE_TRUNCATED;
+        if (this->Dones[w] != EPISODE_RUNNING)
+            this->Reset(w, this->Seeds[w] + this->Worlds);
+    }
+}
+
+void BatchedBreakout::moveRange(const GLubyte* actions, GLfloat dt, GLuint begin, GLuint end)
+{
+    // Branch-free version of ProcessInput for GAME_ACTIVE; adding or
+    // subtracting 0 leaves a position bit for bit unchanged
+    Scalar velocity = ToScalar(dt) * PLAYER_VELOCITY;
+    GLfloat width = static_cast<GLfloat>(this->Width);
+    for (GLuint w = begin; w < end; ++w)
+    {
+        GLubyte action = actions[w];
+        GLfloat x = this->PaddleX[w];
+        Scalar left = (action & ACTION_LEFT) && x >= 0.0f ? velocity : Scalar(0.0f);
+        x = ToFloat(ToScalar(x) - left);
+        Scalar right = (action & ACTION_RIGHT) && x <= width - this->PaddleWidth[w] ? velocity : Scalar(0.0f);
+        x = ToFloat(ToScalar(x) + right);
+        this->PaddleX[w] = x;
+        GLboolean stuck = this->Stuck[w];
+        GLfloat ball = ToFloat(ToScalar(this->BallX[w]) - left);
+        ball = ToFloat(ToScalar(ball) + right);
+        this->BallX[w] = stuck ? ball : this->BallX[w];
+        this->Stuck[w] = stuck && !(action & ACTION_FIRE) ? GL_TRUE : GL_FALSE;
+    }
+}
+
+void BatchedBreakout::collide(GLuint w, GLfloat dt)
+{
+    GLboolean hitPaddle = this->sweepBall(w, dt);
+    // the paddle moved onto the ball (CheckCollision(Ball, Player))
+    Scalar radius = ToScalar(BALL_RADIUS);
+    Vec2 paddle = ToVec2(glm::vec2(this->PaddleX[w], this->PaddleY));
+    if (!hitPaddle && !this->Stuck[w] && this->BallVY[w] > 0.0f
+        && OverlapCircleAABB(ToVec2(glm::vec2(this->BallX[w], this->BallY[w])) + radius, radius,
+            paddle, ToVec2(glm::vec2(this->PaddleWidth[w], PLAYER_SIZE.y))))
+        this->bouncePaddle(w);
+    // powerups reaching the bottom or the paddle
+    GLuint base = w * POWERUP_SLOTS;
+    Vec2 paddleSize = ToVec2(glm::vec2(this->PaddleWidth[w], PLAYER_SIZE.y));
+    for (GLuint slot = base; slot < base + this->PowerUpCount[w]; ++slot)
+    {
+        if (this->PowerUpDestroyed[slot])
+            continue;
+        glm::vec2 position(this->PowerUpX[slot], this->PowerUpY[slot]);
+        if (position.y >= this->Height)
+            this->PowerUpDestroyed[slot] = GL_TRUE;
+        if (OverlapAABB(paddle, paddleSize, ToVec2(position), ToVec2(SIZE)))
+        {
+            this->activatePowerUp(w, this->PowerUpType[slot]);
+            this->PowerUpDestroyed[slot] = GL_TRUE;
+            this->PowerUpActivated[slot] = GL_TRUE;
+            // activating "pad-size-increase" widens the paddle for later powerups
+            paddleSize = ToVec2(glm::vec2(this->PaddleWidth[w], PLAYER_SIZE.y));
+        }
+    }
+    // the ball fell off the bottom
+    if (this->BallY[w] >= this->Height)
+    {
+        if (--this->Lives[w] == 0)
+            this->Dones[w] = EPISODE_LOST;
+        this->resetPlayer(w);
+    }
+}
+
+GLboolean BatchedBreakout::sweepBall(GLuint w, GLfloat dt)
+{
+    const std::uint64_t* alive = this->Alive.data() + w * this->AliveWords;
+    GLboolean hitPaddle = GL_FALSE;
+    Scalar radius = ToScalar(BALL_RADIUS), width = ToScalar(static_cast<GLfloat>(this->Width));
+    Scalar remaining = ToScalar(dt);
+    for (GLuint bounce = 0; bounce < MAX_BOUNCES && !this->Stuck[w] && remaining > 0.0f; ++bounce)
+    {
+        Vec2 position = ToVec2(glm::vec2(this->BallX[w], this->BallY[w]));
+        Vec2 velocity = ToVec2(glm::vec2(this->BallVX[w], this->BallVY[w]));
+        Vec2 paddle = ToVec2(glm::vec2(this->PaddleX[w], this->PaddleY));
+        Vec2 center = position + radius;
+        Vec2 motion = velocity * remaining;
+        // earliest contact, tested in the same order as Game::sweepBall
+        SweepHit first = { 1.0f, Vec2(0.0f) };
+        GLboolean found = GL_FALSE, paddleFirst = GL_FALSE;
+        if (motion.x < 0.0f && (radius - center.x) / motion.x <= first.Time)
+        {
+            first.Time = Max((radius - center.x) / motion.x, 0.0f);
+            first.Normal = Vec2(1.0f, 0.0f);
+            found = GL_TRUE;
+        }
+        else if (motion.x > 0.0f && (width - radius - center.x) / motion.x <= first.Time)
+        {
+            first.Time = Max((width - radius - center.x) / motion.x, 0.0f);
+            first.Normal = Vec2(-1.0f, 0.0f);
+            found = GL_TRUE;
+        }
+        if (motion.y < 0.0f && (radius - center.y) / motion.y <= first.Time)
+        {
+            first.Time = Max((radius - center.y) / motion.y, 0.0f);
+            first.Normal = Vec2(0.0f, 1.0f);
+            found = GL_TRUE;
+        }
+        GLint brick = this->Level.SweepBricks(center, radius, motion, first, alive);
+        if (brick >= 0)
+            found = GL_TRUE;
+        SweepHit hit;
+        if (SweepCircleAABB(center, radius, motion, paddle, paddle + ToVec2(glm::vec2(this->PaddleWidth[w], PLAYER_SIZE.y)), hit)
+            && hit.Time < first.Time)
+        {
+            first = hit;
+            paddleFirst = found = GL_TRUE;
+        }
+        if (!found)
+        {
+            glm::vec2 moved = ToGlm(position + motion);
+            this->BallX[w] = moved.x;
+            this->BallY[w] = moved.y;
+            break;
+        }
+        position += motion * first.Time;
+        remaining -= remaining * first.Time;
+        glm::vec2 moved = ToGlm(position);
+        this->BallX[w] = moved.x;
+        this->BallY[w] = moved.y;
+        if (paddleFirst)
+        {
+            hitPaddle = GL_TRUE;
+            this->bouncePaddle(w);
+        }
+        else if (brick >= 0)
+            this->hitBrick(w, brick, first.Normal);
+        else
+        {   // wall: clamp back inside and bounce
+            position.x = Clamp(position.x, 0.0f, ToScalar(this->Width - BALL_RADIUS * 2));
+            position.y = Max(position.y, 0.0f);
+            Reflect(velocity, first.Normal);
+            moved = ToGlm(position);
+            glm::vec2 bounced = ToGlm(velocity);
+            this->BallX[w] = moved.x;
+            this->BallY[w] = moved.y;
+            this->BallVX[w] = bounced.x;
+            this->BallVY[w] = bounced.y;
+        }
+    }
+    return hitPaddle;
+}
+
+void BatchedBreakout::hitBrick(GLuint w, GLuint index, Vec2 normal)
+{
+    const GameObject& box = this->Level.Bricks[index];
+    if (!box.IsSolid)
+    {
+        this->Alive[w * this->AliveWords + (index >> 6)] &= ~(std::uint64_t(1) << (index & 63));
+        --this->Remaining[w];
+        this->spawnPowerUps(w, box.Position);
+        this->Rewards[w] += 1.0f;
+    }
+    if (!(this->PassThrough[w] && !box.IsSolid))
+    {
+        Vec2 velocity = ToVec2(glm::vec2(this->BallVX[w], this->BallVY[w]));
+        Reflect(velocity, normal);
+        glm::vec2 bounced = ToGlm(velocity);
+        this->BallVX[w] = bounced.x;
+        this->BallVY[w] = bounced.y;
+    }
+}
+
+void BatchedBreakout::bouncePaddle(GLuint w)
+{
+    // the further from the paddle's center, the more sideways the bounce
+    Scalar centerBoard = ToScalar(this->PaddleX[w]) + ToScalar(this->PaddleWidth[w]) / 2;
+    Scalar distance = (ToScalar(this->BallX[w]) + ToScalar(BALL_RADIUS)) - centerBoard;
+    Scalar percentage = distance / (ToScalar(this->PaddleWidth[w]) / 2);
+    Scalar strength = 2.0f;
+    Vec2 oldVelocity = ToVec2(glm::vec2(this->BallVX[w], this->BallVY[w]));
+    Vec2 velocity(ToScalar(INITIAL_BALL_VELOCITY.x) * percentage * strength, -Abs(oldVelocity.y));
+    glm::vec2 bounced = ToGlm(Normalize(velocity) * Length(oldVelocity));
+    this->BallVX[w] = bounced.x;
+    this->BallVY[w] = bounced.y;
+    this->Stuck[w] = this->Sticky[w];
+}
+
+void BatchedBreakout::spawnPowerUps(GLuint w, glm::vec2 position)
+{
+    for (GLuint kind = 0; kind < CLASSIC_POWERUP_KINDS; ++kind)
+    {
+        if (this->Rng[w].Below(POWERUP_CHANCES[kind]) != 0)
+            continue;
+        if (this->PowerUpCount[w] == POWERUP_SLOTS)
+        {
+            ++this->PowerUpsDropped[w];
+            continue;
+        }
+        GLuint slot = w * POWERUP_SLOTS + this->PowerUpCount[w]++;
+        this->PowerUpX[slot] = position.x;
+        this->PowerUpY[slot] = position.y;
+        this->PowerUpDuration[slot] = POWERUP_DURATIONS[kind];
+        this->PowerUpType[slot] = static_cast<GLubyte>(kind);
+        this->PowerUpActivated[slot] = this->PowerUpDestroyed[slot] = GL_FALSE;
+    }
+}
+
+void BatchedBreakout::activatePowerUp(GLuint w, GLuint kind)
+{
+    switch (kind)
+    {
+    case 0: // speed
+        this->BallVX[w] *= static_cast<GLfloat>(1.2);
+        this->BallVY[w] *= static_cast<GLfloat>(1.2);
+        break;
+    case 1: // sticky
+        this->Sticky[w] = GL_TRUE;
+        break;
+    case 2: // pass-through
+        this->PassThrough[w] = GL_TRUE;
+        break;
+    case 3: // pad-size-increase
+        this->PaddleWidth[w] += 50;
+        break;
+    case 4: // confuse
+        if (!this->Chaos[w])
+            this->Confuse[w] = GL_TRUE;
+        break;
+    case 5: // chaos
+        if (!this->Confuse[w])
+            this->Chaos[w] = GL_TRUE;
+        break;
+    }
+}
+
+void BatchedBreakout::advancePowerUps(GLfloat dt, GLuint begin, GLuint end)
+{
+    // Every slot of the range, used or not: one loop without branches.
+    // The powerups only fall; x still takes Game's trip through the
+    // physics number type, which changes nothing in a float build.
+    Scalar fall = ToScalar(VELOCITY.y) * ToScalar(dt);
+    for (GLuint slot = begin * POWERUP_SLOTS; slot < end * POWERUP_SLOTS; ++slot)
+    {
+        this->PowerUpX[slot] = ToFloat(ToScalar(this->PowerUpX[slot]));
+        this->PowerUpY[slot] = ToFloat(ToScalar(this->PowerUpY[slot]) + fall);
+        this->PowerUpDuration[slot] -= this->PowerUpActivated[slot] ? dt : 0.0f;
+    }
+}
+
+void BatchedBreakout::expirePowerUps(GLuint w)
+{
+    GLuint base = w * POWERUP_SLOTS, count = this->PowerUpCount[w];
+    if (count == 0)
+        return;
+    // in order, since an effect ends only once no other powerup of its type is active
+    for (GLuint slot = base; slot < base + count; ++slot)
+    {
+        if (!this->PowerUpActivated[slot] || this->PowerUpDuration[slot] > 0.0f)
+            continue;
+        this->PowerUpActivated[slot] = GL_FALSE;
+        GLubyte kind = this->PowerUpType[slot];
+        GLboolean other = GL_FALSE;
+        for (GLuint i = base; i < base + count && !other; ++i)
+            other = this->PowerUpActivated[i] && this->PowerUpType[i] == kind;
+        if (other)
+            continue;
+        if (kind == 1)
+            this->Sticky[w] = GL_FALSE;
+        else if (kind == 2)
+            this->PassThrough[w] = GL_FALSE;
+        else if (kind == 4)
+            this->Confuse[w] = GL_FALSE;
+        else if (kind == 5)
+            this->Chaos[w] = GL_FALSE;
+    }
+    // drop the finished ones, keeping the others in order
+    GLuint kept = base;
+    for (GLuint slot = base; slot < base + count; ++slot)
+    {
+        if (this->PowerUpDestroyed[slot] && !this->PowerUpActivated[slot])
+            continue;
+        if (kept != slot)
+        {
+            this->PowerUpX[kept] = this->PowerUpX[slot];
+            this->PowerUpY[kept] = this->PowerUpY[slot];
+            this->PowerUpDuration[kept] = this->PowerUpDuration[slot];
+            this->PowerUpType[kept] = this->PowerUpType[slot];
+            this->PowerUpActivated[kept] = this->PowerUpActivated[slot];
+            this->PowerUpDestroyed[kept] = this->PowerUpDestroyed[slot];
+        }
+        ++kept;
+    }
+    this->PowerUpCount[w] = kept - base;
+}
+
+std::uint32_t BatchedBreakout::Checksum(GLuint w) const
+{
+    // the fields of Game::Checksum, in the same order and types
+    std::uint32_t hash = 2166136261u;
+    HashValue(hash, GAME_ACTIVE);
+    HashValue(hash, GLuint(0));
+    HashValue(hash, static_cast<unsigned int>(this->Lives[w]));
+    HashValue(hash, glm::vec2(this->PaddleX[w], this->PaddleY));
+    HashValue(hash, glm::vec2(this->PaddleWidth[w], PLAYER_SIZE.y));
+    HashValue(hash, glm::vec2(this->BallX[w], this->BallY[w]));
+    HashValue(hash, glm::vec2(this->BallVX[w], this->BallVY[w]));
+    HashValue(hash, this->Stuck[w]);
+    HashValue(hash, this->Sticky[w]);
+    HashValue(hash, this->PassThrough[w]);
+    HashValue(hash, this->Confuse[w]);
+    HashValue(hash, this->Chaos[w]);
+    HashValue(hash, this->Rng[w].State);
+    for (GLuint word = 0; word < this->AliveWords; ++word)
+        HashValue(hash, this->Alive[w * this->AliveWords + word]);
+    for (GLuint slot = w * POWERUP_SLOTS; slot < w * POWERUP_SLOTS + this->PowerUpCount[w]; ++slot)
+    {
+        HashValue(hash, glm::vec2(this->PowerUpX[slot], this->PowerUpY[slot]));
+        HashValue(hash, this->PowerUpDuration[slot]);
+        HashValue(hash, this->PowerUpActivated[slot]);
+        HashValue(hash, this->PowerUpDestroyed[slot]);
+    }
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 TexCoords;
+in vec3 BrickColor;
+flat in float Layer;
+out vec4 color;
+
+uniform sampler2DArray sprites;
+
+void main()
+{
+    color = vec4(BrickColor, 1.0) * texture(sprites, vec3(TexCoords, Layer));
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 brick;  // <vec2 position, vec2 size>
+layout (location = 2) in vec4 tint;   // <vec3 color, float layer>
+layout (location = 3) in vec4 rect;   // <vec2 uv0, vec2 uv1>
+
+out vec2 TexCoords;
+out vec3 BrickColor;
+flat out float Layer;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = mix(rect.xy, rect.zw, vertex.zw);
+    BrickColor = tint.rgb;
+    Layer = tint.a;
+    gl_Position = projection * vec4(brick.xy + vertex.xy * brick.zw, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "brick_renderer.h"
+
+#include "game_level.h"
+
+
+BrickRenderer::BrickRenderer(Shader& shader)
+    : Count(0), shader(shader), VAO(0), quadVBO(0), instanceVBO(0)
+{
+    this->initRenderData();
+}
+
+BrickRenderer::~BrickRenderer()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->quadVBO);
+    glDeleteBuffers(1, &this->instanceVBO);
+}
+
+void BrickRenderer::initRenderData()
+{
+    GLfloat vertices[] = {
+        // position // texture
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->quadVBO);
+    glGenBuffers(1, &this->instanceVBO);
+
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+
+    // one BrickInstance per instance: <position, size>, <color, layer>, uv rectangle
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (GLvoid*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (GLvoid*)(4 * sizeof(GLfloat)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (GLvoid*)(8 * sizeof(GLfloat)));
+    glVertexAttribDivisor(3, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void BrickRenderer::Load(const std::vector<SpriteState>& bricks, const SpriteRegion& block, const SpriteRegion& solid)
+{
+    this->Count = static_cast<GLuint>(bricks.size());
+    this->instances.resize(bricks.size());
+    for (GLuint i = 0; i < this->Count; ++i)
+    {
+        const SpriteState& brick = bricks[i];
+        BrickInstance& instance = this->instances[i];
+        instance.X = brick.Position.x;
+        instance.Y = brick.Position.y;
+        instance.Width = brick.Size.x;
+        instance.Height = brick.Size.y;
+        instance.R = brick.Color.r;
+        instance.G = brick.Color.g;
+        instance.B = brick.Color.b;
+        const SpriteRegion& region = brick.Kind ? solid : block;
+        instance.Layer = static_cast<GLfloat>(region.Layer);
+        instance.UV = region.UV;
+    }
+    this->alive.assign((this->Count + 63) / 64, 0);
+    for (GLuint i = 0; i < this->Count; ++i)
+        this->alive[i >> 6] |= std::uint64_t(1) << (i & 63);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->instances.size() * sizeof(BrickInstance), this->instances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BrickRenderer::SetAlive(const std::uint64_t* alive)
+{
+    // Collect the flipped bricks into runs of neighbouring slots
+    GLint runBegin = -1, runEnd = -1;
+    for (GLuint word = 0; word < this->alive.size(); ++word)
+    {
+        std::uint64_t flips = this->alive[word] ^ alive[word];
+        this->alive[word] = alive[word];
+        for (; flips; flips &= flips - 1)
+        {
+            GLint index = static_cast<GLint>(word * 64 + LowestBit(flips));
+            if (index != runEnd)
+            {
+                if (runBegin >= 0)
+                    this->upload(runBegin, runEnd);
+                runBegin = index;
+            }
+            runEnd = index + 1;
+        }
+    }
+    if (runBegin >= 0)
+        this->upload(runBegin, runEnd);
+}
+
+void BrickRenderer::upload(GLuint begin, GLuint end)
+{
+    BrickInstance run[64];
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    while (begin < end)
+    {
+        GLuint count = end - begin < 64 ? end - begin : 64;
+        for (GLuint i = 0; i < count; ++i)
+        {
+            GLuint index = begin + i;
+            run[i] = this->instances[index];
+            if (!((this->alive[index >> 6] >> (index & 63)) & 1))
+                run[i].Width = run[i].Height = 0.0f;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, begin * sizeof(BrickInstance), count * sizeof(BrickInstance), run);
+        begin += count;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BrickRenderer::Draw(const TextureArray& sprites)
+{
+    if (this->Count == 0)
+        return;
+    this->shader.Use();
+    glActiveTexture(GL_TEXTURE1);
+    sprites.Bind();
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(this->VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->Count);
+    glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "collision.h"
+
+#include <cmath>
+
+
+// function declaration
+template <typename S>
+GLboolean SweepFace(S center, S motion, S plane, S otherCenter, S otherMotion, S otherMin, S otherMax, S& best);
+template <typename V>
+void SweepCorner(V center, typename V::value_type radius, V motion, V corner,
+    typename V::value_type& best, V& normal, GLboolean& found);
+
+
+template <typename V>
+GLboolean SweepCircleAABB(V center, typename V::value_type radius, V motion,
+    V boxMin, V boxMax, BasicSweepHit<V>& hit)
+{
+    typedef typename V::value_type S;
+    // Cheap reject: the box lies outside the bounds of the whole sweep
+    V sweepMin = Min(center, center + motion) - radius;
+    V sweepMax = Max(center, center + motion) + radius;
+    if (sweepMax.x < boxMin.x || sweepMin.x > boxMax.x || sweepMax.y < boxMin.y || sweepMin.y > boxMax.y)
+        return GL_FALSE;
+    // Already overlapping: report an immediate hit if still moving inwards
+    V closest = Clamp(center, boxMin, boxMax);
+    V offset = center - closest;
+    S distance2 = Dot(offset, offset);
+    if (distance2 < radius * radius)
+    {
+        V normal;
+        if (distance2 > 0.0f)
+            normal = offset / Sqrt(distance2);
+        else
+        {   // center inside the box, push out along the shallowest axis
+            V toMin = center - boxMin, toMax = boxMax - center;
+            S depth[4] = { toMin.x, toMax.x, toMin.y, toMax.y };
+            const V normals[4] = { V(-1, 0), V(1, 0), V(0, -1), V(0, 1) };
+            int axis = 0;
+            for (int i = 1; i < 4; ++i)
+                if (depth[i] < depth[axis])
+                    axis = i;
+            normal = normals[axis];
+        }
+        if (Dot(motion, normal) >= 0.0f)
+            return GL_FALSE;
+        hit.Time = 0.0f;
+        hit.Normal = normal;
+        return GL_TRUE;
+    }
+    // The box grown by the radius has flat faces and rounded corners;
+    // test the four face segments and the four corner circles
+    S best = 1.0f;
+    V normal(0.0f);
+    GLboolean found = GL_FALSE;
+    if (motion.x > 0.0f && SweepFace(center.x, motion.x, boxMin.x - radius, center.y, motion.y, boxMin.y, boxMax.y, best))
+    {
+        normal = V(-1.0f, 0.0f);
+        found = GL_TRUE;
+    }
+    else if (motion.x < 0.0f && SweepFace(center.x, motion.x, boxMax.x + radius, center.y, motion.y, boxMin.y, boxMax.y, best))
+    {
+        normal = V(1.0f, 0.0f);
+        found = GL_TRUE;
+    }
+    if (motion.y > 0.0f && SweepFace(center.y, motion.y, boxMin.y - radius, center.x, motion.x, boxMin.x, boxMax.x, best))
+    {
+        normal = V(0.0f, -1.0f);
+        found = GL_TRUE;
+    }
+    else if (motion.y < 0.0f && SweepFace(center.y, motion.y, boxMax.y + radius, center.x, motion.x, boxMin.x, boxMax.x, best))
+    {
+        normal = V(0.0f, 1.0f);
+        found = GL_TRUE;
+    }
+    SweepCorner(center, radius, motion, V(boxMin.x, boxMin.y), best, normal, found);
+    SweepCorner(center, radius, motion, V(boxMax.x, boxMin.y), best, normal, found);
+    SweepCorner(center, radius, motion, V(boxMin.x, boxMax.y), best, normal, found);
+    SweepCorner(center, radius, motion, V(boxMax.x, boxMax.y), best, normal, found);
+    if (!found)
+        return GL_FALSE;
+    hit.Time = best;
+    hit.Normal = normal;
+    return GL_TRUE;
+}
+
+// Lowers best to the time at which the center crosses the (grown) face
+// plane, if that is earlier and the crossing lies within the face's
+// extent along the other axis. The caller only tests faces the motion
+// points into, so a negative time means the center is behind the plane.
+template <typename S>
+GLboolean SweepFace(S center, S motion, S plane, S otherCenter, S otherMotion, S otherMin, S otherMax, S& best)
+{
+    S t = (plane - center) / motion;
+    if (t < 0.0f || t > best)
+        return GL_FALSE;
+    S other = otherCenter + otherMotion * t;
+    if (other < otherMin || other > otherMax)
+        return GL_FALSE;
+    best = t;
+    return GL_TRUE;
+}
+
+// Earliest time at which the center comes within radius of the corner
+template <typename V>
+void SweepCorner(V center, typename V::value_type radius, V motion, V corner,
+    typename V::value_type& best, V& normal, GLboolean& found)
+{
+    typedef typename V::value_type S;
+    V m = center - corner;
+    S b = Dot(m, motion);
+    if (b >= 0.0f) // moving away from the corner
+        return;
+    S a = Dot(motion, motion);
+    S c = Dot(m, m) - radius * radius;
+    S discriminant = b * b - a * c;
+    if (discriminant < 0.0f)
+        return;
+    S t = (-b - Sqrt(discriminant)) / a;
+    if (t < 0.0f || t > best)
+        return;
+    best = t;
+    normal = Normalize(m + motion * t);
+    found = GL_TRUE;
+}
+
+Direction VectorDirection(glm::vec2 target)
+{
+    glm::vec2 compass[] = {
+        glm::vec2(0.0f,1.0f),  // 上
+        glm::vec2(1.0f,0.0f),  // 右
+        glm::vec2(0.0f,-1.0f), // 下
+        glm::vec2(-1.0f,0.0f), // 左
+    };
+    GLfloat max = 0.0f;
+    GLuint best_match = -1;
+    glm::vec2 normal_target = glm::normalize(target);
+    for (GLuint i = 0; i < 4; i++)
+    {
+        GLfloat dot_res = glm::dot(normal_target, compass[i]);
+        if (dot_res > max)
+        {
+            max = dot_res;
+            best_match = i;
+        }
+    }
+    return (Direction)best_match;
+}
+
+GLboolean CheckCollision(GameObject& one, GameObject& two) // AABB - AABB collision
+{
+    return OverlapAABB(one.Position, one.Size, two.Position, two.Size);
+}
+
+template <typename V>
+GLboolean OverlapAABB(V onePosition, V oneSize, V twoPosition, V twoSize)
+{
+    // x方向碰撞
+    bool collisionX = onePosition.x + oneSize.x >= twoPosition.x 
+        && twoPosition.x + twoSize.x >= onePosition.x;
+    // y方向碰撞
+    bool collisionY = onePosition.y + oneSize.y >= twoPosition.y 
+        && twoPosition.y + twoSize.y >= onePosition.y;
+    // 两个轴都碰撞则判定碰撞
+    return collisionX && collisionY;
+}
+
+Collision CheckCollision(BallObject& one, GameObject& two) // AABB - Circle collision
+{
+    // 获取圆心
+    glm::vec2 center(one.Position + one.Radius);
+    // 获取aabb中心
+    glm::vec2 aabb_half_extends(two.Size.x / 2, two.Size.y / 2);
+    glm::vec2 aabb_center(two.Position.x + aabb_half_extends.x, two.Position.y + aabb_half_extends.y);
+    // 两中心的矢量差
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extends, aabb_half_extends);
+    // AABB_center加上clamped这样就得到了碰撞箱上距离圆最近的点closest
+    glm::vec2 closest = aabb_center + clamped;
+    // 获得圆心center和最近点closest的矢量并判断是否 length <= radius
+    difference = closest - center;
+    if (glm::length(difference) <= one.Radius)
+        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
+    else
+        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
+}
+
+template <typename V>
+GLboolean OverlapCircleAABB(V center, typename V::value_type radius, V position, V size)
+{
+    // 与CheckCollision(BallObject&, GameObject&)的运算顺序完全相同
+    V aabb_half_extends(size.x / 2, size.y / 2);
+    V aabb_center(position.x + aabb_half_extends.x, position.y + aabb_half_extends.y);
+    V clamped = Clamp(center - aabb_center, -aabb_half_extends, aabb_half_extends);
+    return Length(aabb_center + clamped - center) <= radius;
+}
+
+template <typename V>
+void Reflect(V& velocity, V normal)
+{
+    // 沿法线的主轴反弹 (与原先按VectorDirection翻转一致)，并保证速度离开接触面；
+    // 同一步内连续碰到两块砖也不会把速度翻转回去
+    V incoming = velocity;
+    if (Abs(normal.x) > Abs(normal.y))
+        velocity.x = normal.x > 0.0f ? Abs(velocity.x) : -Abs(velocity.x);
+    else
+        velocity.y = normal.y > 0.0f ? Abs(velocity.y) : -Abs(velocity.y);
+    // 撞到砖角时只翻转一个轴可能仍然朝向砖块，此时沿角的法线做镜面反射。
+    // 两个轴都翻转会让球原路返回，在实心砖之间可能永远来回弹
+    if (Dot(velocity, normal) < 0.0f)
+        velocity = incoming - 2.0f * Dot(incoming, normal) * normal;
+}
+
+// Both number types are built here, so a float build can still measure
+// and check the fixed-point physics (see --bench fixed)
+template GLboolean OverlapAABB(glm::vec2, glm::vec2, glm::vec2, glm::vec2);
+template GLboolean OverlapAABB(FixedVec2, FixedVec2, FixedVec2, FixedVec2);
+template GLboolean OverlapCircleAABB(glm::vec2, GLfloat, glm::vec2, glm::vec2);
+template GLboolean OverlapCircleAABB(FixedVec2, Fixed, FixedVec2, FixedVec2);
+template GLboolean SweepCircleAABB(glm::vec2, GLfloat, glm::vec2, glm::vec2, glm::vec2, BasicSweepHit<glm::vec2>&);
+template GLboolean SweepCircleAABB(FixedVec2, Fixed, FixedVec2, FixedVec2, FixedVec2, BasicSweepHit<FixedVec2>&);
+template void      Reflect(glm::vec2&, glm::vec2);
+template void      Reflect(FixedVec2&, FixedVec2);
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "collision_batch.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles intrinsics for any instruction set; GCC and Clang need
+// the target enabled on the function that uses them
+#if defined(BATCH_X86) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+
+// function declaration
+OverlapKernel SelectOverlapKernel();
+
+
+const OverlapKernel OverlapCircleBoxes = SelectOverlapKernel();
+
+void BoxBatch::Resize(GLuint count)
+{
+    // empty boxes sit infinitely far away: their distance is never <= radius
+    GLuint padded = count + BOX_BATCH - 1;
+    this->Count = count;
+    this->CenterX.assign(padded, std::numeric_limits<GLfloat>::max());
+    this->CenterY.assign(padded, std::numeric_limits<GLfloat>::max());
+    this->HalfX.assign(padded, 0.0f);
+    this->HalfY.assign(padded, 0.0f);
+}
+
+void BoxBatch::Set(GLuint index, glm::vec2 position, glm::vec2 size)
+{
+    // same arithmetic as CheckCollision
+    this->HalfX[index] = size.x / 2;
+    this->HalfY[index] = size.y / 2;
+    this->CenterX[index] = position.x + this->HalfX[index];
+    this->CenterY[index] = position.y + this->HalfY[index];
+}
+
+void BoxBatch::Clear(GLuint index)
+{
+    this->CenterX[index] = this->CenterY[index] = std::numeric_limits<GLfloat>::max();
+    this->HalfX[index] = this->HalfY[index] = 0.0f;
+}
+
+// Reference version, CheckCollision unrolled over the batch
+GLuint OverlapCircleBoxesScalar(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY)
+{
+    GLuint mask = 0;
+    for (GLuint i = 0; i < BOX_BATCH; ++i)
+    {
+        GLuint k = first + i;
+        GLfloat clampedX = glm::min(glm::max(center.x - boxes.CenterX[k], -boxes.HalfX[k]), boxes.HalfX[k]);
+        GLfloat clampedY = glm::min(glm::max(center.y - boxes.CenterY[k], -boxes.HalfY[k]), boxes.HalfY[k]);
+        diffX[i] = (boxes.CenterX[k] + clampedX) - center.x;
+        diffY[i] = (boxes.CenterY[k] + clampedY) - center.y;
+        if (std::sqrt(diffX[i] * diffX[i] + diffY[i] * diffY[i]) <= radius)
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+#ifdef BATCH_X86
+
+// _mm_max_ps(a, b) is (a > b ? a : b) and _mm_min_ps(a, b) is (a < b ? a : b);
+// the operand order below matches glm::max(x, lo) and glm::min(x, hi) exactly,
+// including signed zeros. Products and sums stay separate (no FMA) so every
+// lane rounds like the scalar code.
+GLuint OverlapCircleBoxesSSE2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY)
+{
+    const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y);
+    const __m128 r = _mm_set1_ps(radius), sign = _mm_set1_ps(-0.0f);
+    GLuint mask = 0;
+    for (GLuint i = 0; i < BOX_BATCH; i += 4)
+    {
+        GLuint k = first + i;
+        __m128 bx = _mm_loadu_ps(&boxes.CenterX[k]), by = _mm_loadu_ps(&boxes.CenterY[k]);
+        __m128 hx = _mm_loadu_ps(&boxes.HalfX[k]), hy = _mm_loadu_ps(&boxes.HalfY[k]);
+        __m128 clampedX = _mm_min_ps(hx, _mm_max_ps(_mm_xor_ps(hx, sign), _mm_sub_ps(cx, bx)));
+        __m128 clampedY = _mm_min_ps(hy, _mm_max_ps(_mm_xor_ps(hy, sign), _mm_sub_ps(cy, by)));
+        __m128 dx = _mm_sub_ps(_mm_add_ps(bx, clampedX), cx);
+        __m128 dy = _mm_sub_ps(_mm_add_ps(by, clampedY), cy);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        _mm_storeu_ps(diffX + i, dx);
+        _mm_storeu_ps(diffY + i, dy);
+        mask |= static_cast<GLuint>(_mm_movemask_ps(_mm_cmple_ps(length, r))) << i;
+    }
+    return mask;
+}
+
+TARGET_AVX2 GLuint OverlapCircleBoxesAVX2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY)
+{
+    const __m256 cx = _mm256_set1_ps(center.x), cy = _mm256_set1_ps(center.y);
+    const __m256 r = _mm256_set1_ps(radius), sign = _mm256_set1_ps(-0.0f);
+    __m256 bx = _mm256_loadu_ps(&boxes.CenterX[first]), by = _mm256_loadu_ps(&boxes.CenterY[first]);
+    __m256 hx = _mm256_loadu_ps(&boxes.HalfX[first]), hy = _mm256_loadu_ps(&boxes.HalfY[first]);
+    __m256 clampedX = _mm256_min_ps(hx, _mm256_max_ps(_mm256_xor_ps(hx, sign), _mm256_sub_ps(cx, bx)));
+    __m256 clampedY = _mm256_min_ps(hy, _mm256_max_ps(_mm256_xor_ps(hy, sign), _mm256_sub_ps(cy, by)));
+    __m256 dx = _mm256_sub_ps(_mm256_add_ps(bx, clampedX), cx);
+    __m256 dy = _mm256_sub_ps(_mm256_add_ps(by, clampedY), cy);
+    __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    _mm256_storeu_ps(diffX, dx);
+    _mm256_storeu_ps(diffY, dy);
+    return static_cast<GLuint>(_mm256_movemask_ps(_mm256_cmp_ps(length, r, _CMP_LE_OQ)));
+}
+
+// AVX2 needs the CPU to support it and the OS to save the YMM registers
+GLboolean CpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return GL_FALSE;
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+        return GL_FALSE;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+GLuint OverlapKernelLevel()
+{
+    // SSE2 is part of every x86-64 CPU and the default for 32-bit MSVC builds
+    return CpuHasAVX2() ? 2 : 1;
+}
+
+#else
+
+GLuint OverlapCircleBoxesSSE2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY)
+{
+    return OverlapCircleBoxesScalar(center, radius, boxes, first, diffX, diffY);
+}
+
+GLuint OverlapCircleBoxesAVX2(glm::vec2 center, GLfloat radius, const BoxBatch& boxes, GLuint first,
+    GLfloat* diffX, GLfloat* diffY)
+{
+    return OverlapCircleBoxesScalar(center, radius, boxes, first, diffX, diffY);
+}
+
+GLuint OverlapKernelLevel()
+{
+    return 0;
+}
+
+#endif
+
+OverlapKernel SelectOverlapKernel()
+{
+    const OverlapKernel kernels[3] = { OverlapCircleBoxesScalar, OverlapCircleBoxesSSE2, OverlapCircleBoxesAVX2 };
+    return kernels[OverlapKernelLevel()];
+}
\ No newline at end of file
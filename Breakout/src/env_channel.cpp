@@ -0,0 +1,247 @@
+#include "env_channel.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Polls of a word before a waiter goes to sleep on it
+const GLuint SPIN_COUNT = 20000;
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex words must be plain 32 bit integers");
+
+
+// Byte offsets of the parts of a frame, each on a 64 byte boundary
+struct FrameLayout
+{
+    std::size_t Actions, Features, Rewards, Dones, Bricks, Bytes;
+};
+
+// function declaration
+std::size_t AlignUp(std::size_t bytes);
+FrameLayout LayoutFrame(GLuint worlds, GLuint aliveWords);
+std::string ObjectName(const std::string& name);
+
+
+EnvChannel::EnvChannel() : Header(nullptr), memory(nullptr), size(0), owner(GL_FALSE) { }
+
+EnvChannel::~EnvChannel()
+{
+    this->Close();
+}
+
+#if defined(__linux__)
+GLboolean EnvChannel::Create(const std::string& name, GLuint slots, GLuint worlds, GLuint aliveWords, GLuint ring)
+{
+    this->Close();
+    std::size_t slotBytes = AlignUp(sizeof(EnvSlot)) + ring * LayoutFrame(worlds, aliveWords).Bytes;
+    std::size_t size = AlignUp(sizeof(EnvHeader)) + slots * slotBytes;
+    // an object left behind by a server that did not shut down cleanly is replaced
+    std::string object = ObjectName(name);
+    shm_unlink(object.c_str());
+    int fd = shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, size) != 0)
+    {
+        std::cout << "ERROR::ENV: Failed to create shared memory " << object << std::endl;
+        if (fd >= 0)
+        {
+            close(fd);
+            shm_unlink(object.c_str());
+        }
+        return GL_FALSE;
+    }
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "ERROR::ENV: Failed to map shared memory " << object << std::endl;
+        shm_unlink(object.c_str());
+        return GL_FALSE;
+    }
+    this->name = object;
+    this->memory = memory;
+    this->size = size;
+    this->owner = GL_TRUE;
+    // the object starts zeroed; the atomics are constructed in place
+    this->Header = new (memory) EnvHeader();
+    this->Header->Version = ENV_VERSION;
+    this->Header->Slots = slots;
+    this->Header->Worlds = worlds;
+    this->Header->AliveWords = aliveWords;
+    this->Header->Ring = ring;
+    this->Header->SlotBytes = slotBytes;
+    this->Header->TotalBytes = size;
+    for (GLuint slot = 0; slot < slots; ++slot)
+        new (this->Slot(slot)) EnvSlot();
+    return GL_TRUE;
+}
+
+GLboolean EnvChannel::Open(const std::string& name)
+{
+    this->Close();
+    std::string object = ObjectName(name);
+    int fd = shm_open(object.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        std::cout << "ERROR::ENV: No server is serving " << name << std::endl;
+        return GL_FALSE;
+    }
+    std::size_t size = static_cast<std::size_t>(lseek(fd, 0, SEEK_END));
+    void* memory = size >= sizeof(EnvHeader) ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "ERROR::ENV: Failed to map shared memory " << object << std::endl;
+        return GL_FALSE;
+    }
+    this->memory = memory;
+    this->size = size;
+    this->Header = static_cast<EnvHeader*>(memory);
+    // the server publishes Magic last, once the header is complete
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->Header->Magic != ENV_MAGIC || this->Header->Version != ENV_VERSION || this->Header->TotalBytes != size)
+    {
+        std::cout << "ERROR::ENV: " << object << " is not a compatible environment server" << std::endl;
+        this->Close();
+        return GL_FALSE;
+    }
+    return GL_TRUE;
+}
+
+void EnvChannel::Close()
+{
+    if (!this->memory)
+        return;
+    munmap(this->memory, this->size);
+    if (this->owner)
+        shm_unlink(this->name.c_str());
+    this->Header = nullptr;
+    this->memory = nullptr;
+    this->size = 0;
+    this->owner = GL_FALSE;
+}
+#else
+GLboolean EnvChannel::Create(const std::string& name, GLuint slots, GLuint worlds, GLuint aliveWords, GLuint ring)
+{
+    std::cout << "ERROR::ENV: The environment server needs Linux shared memory and futexes" << std::endl;
+    return GL_FALSE;
+}
+
+GLboolean EnvChannel::Open(const std::string& name)
+{
+    std::cout << "ERROR::ENV: The environment server needs Linux shared memory and futexes" << std::endl;
+    return GL_FALSE;
+}
+
+void EnvChannel::Close() { }
+#endif
+
+EnvSlot* EnvChannel::Slot(GLuint slot) const
+{
+    std::uint8_t* base = static_cast<std::uint8_t*>(this->memory) + AlignUp(sizeof(EnvHeader));
+    return reinterpret_cast<EnvSlot*>(base + slot * this->Header->SlotBytes);
+}
+
+EnvFrame EnvChannel::Frame(GLuint slot, std::uint32_t request) const
+{
+    FrameLayout layout = LayoutFrame(this->Header->Worlds, this->Header->AliveWords);
+    std::uint8_t* base = reinterpret_cast<std::uint8_t*>(this->Slot(slot)) + AlignUp(sizeof(EnvSlot))
+        + (request % this->Header->Ring) * layout.Bytes;
+    EnvFrame frame;
+    frame.Actions = base + layout.Actions;
+    frame.Features = reinterpret_cast<GLfloat*>(base + layout.Features);
+    frame.Rewards = reinterpret_cast<GLfloat*>(base + layout.Rewards);
+    frame.Dones = base + layout.Dones;
+    frame.Bricks = reinterpret_cast<std::uint64_t*>(base + layout.Bricks);
+    return frame;
+}
+
+void WriteObservation(const BatchedBreakout& batch, const EnvFrame& frame)
+{
+    for (GLuint w = 0; w < batch.Worlds; ++w)
+    {
+        GLfloat* row = frame.Features + w * ENV_FEATURES;
+        row[FEATURE_BALL_X] = batch.BallX[w];
+        row[FEATURE_BALL_Y] = batch.BallY[w];
+        row[FEATURE_BALL_VX] = batch.BallVX[w];
+        row[FEATURE_BALL_VY] = batch.BallVY[w];
+        row[FEATURE_PADDLE_X] = batch.PaddleX[w];
+        row[FEATURE_PADDLE_WIDTH] = batch.PaddleWidth[w];
+        row[FEATURE_LIVES] = static_cast<GLfloat>(batch.Lives[w]);
+        row[FEATURE_REMAINING] = static_cast<GLfloat>(batch.Remaining[w]);
+        row[FEATURE_STUCK] = batch.Stuck[w];
+        row[FEATURE_STICKY] = batch.Sticky[w];
+        row[FEATURE_PASS_THROUGH] = batch.PassThrough[w];
+        row[FEATURE_CONFUSE] = batch.Confuse[w];
+        row[FEATURE_CHAOS] = batch.Chaos[w];
+    }
+    std::memcpy(frame.Rewards, batch.Rewards.data(), batch.Worlds * sizeof(GLfloat));
+    std::memcpy(frame.Dones, batch.Dones.data(), batch.Worlds);
+    if (!batch.Alive.empty())
+        std::memcpy(frame.Bricks, batch.Alive.data(), batch.Alive.size() * sizeof(std::uint64_t));
+}
+
+std::uint32_t WaitForChange(std::atomic<std::uint32_t>& word, std::uint32_t old,
+    std::atomic<std::uint32_t>& waiting, GLuint timeoutMs)
+{
+    std::uint32_t value = old;
+    for (GLuint spin = 0; spin < SPIN_COUNT; ++spin)
+    {
+        value = word.load(std::memory_order_acquire);
+        if (value != old)
+            return value;
+        if (spin % 64 == 63)
+            std::this_thread::yield();
+    }
+    // raising waiting before the last check pairs with the other side
+    // storing the word before it reads waiting; both are seq_cst
+    waiting.store(1);
+    value = word.load();
+#if defined(__linux__)
+    if (value == old)
+    {
+        timespec timeout = { static_cast<time_t>(timeoutMs / 1000), static_cast<long>(timeoutMs % 1000) * 1000000 };
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, old, &timeout, nullptr, 0);
+        value = word.load(std::memory_order_acquire);
+    }
+#endif
+    waiting.store(0);
+    return value;
+}
+
+void WakeAll(std::atomic<std::uint32_t>& word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+std::size_t AlignUp(std::size_t bytes)
+{
+    return (bytes + 63) & ~static_cast<std::size_t>(63);
+}
+
+FrameLayout LayoutFrame(GLuint worlds, GLuint aliveWords)
+{
+    FrameLayout layout;
+    layout.Actions = 0;
+    layout.Features = AlignUp(layout.Actions + worlds);
+    layout.Rewards = AlignUp(layout.Features + worlds * ENV_FEATURES * sizeof(GLfloat));
+    layout.Dones = AlignUp(layout.Rewards + worlds * sizeof(GLfloat));
+    layout.Bricks = AlignUp(layout.Dones + worlds);
+    layout.Bytes = AlignUp(layout.Bricks + worlds * aliveWords * sizeof(std::uint64_t));
+    return layout;
+}
+
+std::string ObjectName(const std::string& name)
+{
+    return "/breakout-" + name;
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "env_client.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "batched_breakout.h"
+#include "random.h"
+
+// How long a waiting client sleeps before it checks that the server is still running
+const GLuint SERVER_CHECK_MS = 100;
+
+
+EnvClient::EnvClient() : slot(0), sequence(0), connected(GL_FALSE) { }
+
+EnvClient::~EnvClient()
+{
+    this->Disconnect();
+}
+
+GLboolean EnvClient::Connect(const std::string& name)
+{
+    this->Disconnect();
+    if (!this->Channel.Open(name))
+        return GL_FALSE;
+#if defined(__linux__)
+    std::uint32_t pid = static_cast<std::uint32_t>(getpid());
+#else
+    std::uint32_t pid = 1;
+#endif
+    for (GLuint s = 0; s < this->Channel.Header->Slots; ++s)
+    {
+        EnvSlot& slot = *this->Channel.Slot(s);
+        std::uint32_t free = 0;
+        if (!slot.Owner.compare_exchange_strong(free, pid))
+            continue;
+        this->slot = s;
+        this->connected = GL_TRUE;
+        // a client that exited mid-request may have left one for the server to finish
+        this->sequence = slot.Request.load();
+        while (slot.Response.load(std::memory_order_acquire) != this->sequence)
+        {
+            if (!this->Channel.Header->Running.load())
+            {
+                this->Disconnect();
+                return GL_FALSE;
+            }
+            WaitForChange(slot.Response, slot.Response.load(), slot.ClientWaiting, SERVER_CHECK_MS);
+        }
+        return GL_TRUE;
+    }
+    std::cout << "ERROR::ENV: All " << this->Channel.Header->Slots << " slots of " << name << " are taken" << std::endl;
+    this->Channel.Close();
+    return GL_FALSE;
+}
+
+void EnvClient::Disconnect()
+{
+    if (this->connected)
+        this->Channel.Slot(this->slot)->Owner.store(0);
+    this->connected = GL_FALSE;
+    this->Channel.Close();
+}
+
+GLboolean EnvClient::Observe()
+{
+    return this->request(ENV_OBSERVE, 0);
+}
+
+GLboolean EnvClient::Reset(std::uint64_t seed)
+{
+    return this->request(ENV_RESET, seed);
+}
+
+GLboolean EnvClient::Step()
+{
+    return this->request(ENV_STEP, 0);
+}
+
+GLboolean EnvClient::request(EnvCommand command, std::uint64_t seed)
+{
+    EnvHeader& header = *this->Channel.Header;
+    EnvSlot& slot = *this->Channel.Slot(this->slot);
+    std::uint32_t request = this->sequence + 1;
+    slot.Command = command;
+    slot.Seed = seed;
+    // publishes the frame's actions and the arguments above
+    slot.Request.store(request);
+    header.Doorbell.fetch_add(1);
+    if (header.ServerSleeping.load())
+        WakeAll(header.Doorbell);
+    while (slot.Response.load(std::memory_order_acquire) != request)
+    {
+        if (!header.Running.load())
+        {
+            std::cout << "ERROR::ENV: The server shut down" << std::endl;
+            return GL_FALSE;
+        }
+        WaitForChange(slot.Response, this->sequence, slot.ClientWaiting, SERVER_CHECK_MS);
+    }
+    this->sequence = request;
+    return GL_TRUE;
+}
+
+int RunEnvClient(const GLchar* name, const Game& prototype, unsigned int steps, std::uint64_t seed)
+{
+    EnvClient client;
+    if (!client.Connect(name))
+        return 1;
+    const EnvHeader& header = *client.Channel.Header;
+    if (header.Level >= prototype.Levels.size() || prototype.Levels[header.Level].Alive.size() != header.AliveWords)
+    {
+        std::cout << "ERROR::ENV: The server plays a level this client did not load" << std::endl;
+        return 1;
+    }
+    GLuint worlds = header.Worlds;
+
+    // what the server should answer, computed locally
+    BatchedBreakout reference(prototype.Levels[header.Level], worlds, header.Width, header.Height, seed);
+    std::vector<GLfloat> features(worlds * ENV_FEATURES), rewards(worlds);
+    std::vector<GLubyte> dones(worlds), actions(worlds);
+    std::vector<std::uint64_t> bricks(worlds * header.AliveWords);
+    EnvFrame expected = { nullptr, features.data(), rewards.data(), dones.data(), bricks.data() };
+    auto matches = [&](const EnvFrame& frame) {
+        WriteObservation(reference, expected);
+        return std::memcmp(frame.Features, expected.Features, features.size() * sizeof(GLfloat)) == 0
+            && std::memcmp(frame.Rewards, expected.Rewards, rewards.size() * sizeof(GLfloat)) == 0
+            && std::memcmp(frame.Dones, expected.Dones, dones.size()) == 0
+            && std::memcmp(frame.Bricks, expected.Bricks, bricks.size() * sizeof(std::uint64_t)) == 0;
+    };
+
+    if (!client.Reset(seed))
+        return 1;
+    unsigned int mismatches = matches(client.Last()) ? 0 : 1;
+    Random rng(seed);
+    std::vector<GLdouble> roundTrips(steps);
+    for (unsigned int step = 0; step < steps; ++step)
+    {
+        // an agent would hold its choice for a few frames
+        if (step % 8 == 0)
+            for (GLubyte& action : actions)
+                action = static_cast<GLubyte>(rng.Below(8));
+        EnvFrame next = client.Next();
+        std::memcpy(next.Actions, actions.data(), worlds);
+        auto start = std::chrono::steady_clock::now();
+        if (!client.Step())
+            return 1;
+        roundTrips[step] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        reference.Step(actions.data(), header.Dt);
+        if (!matches(client.Last()))
+            ++mismatches;
+    }
+
+    GLdouble total = 0.0;
+    for (GLdouble roundTrip : roundTrips)
+        total += roundTrip;
+    std::sort(roundTrips.begin(), roundTrips.end());
+    std::cout << "slot " << client.Slot() << ": " << steps << " steps of " << worlds << " worlds, "
+        << mismatches << " mismatches" << std::endl;
+    if (steps)
+    {
+        std::cout << "round trip:   mean " << total / steps << " us, p50 " << roundTrips[steps / 2] << " us, p99 "
+            << roundTrips[steps * 99 / 100] << " us" << std::endl;
+        std::cout << "world steps/second: " << worlds * steps / (total * 1e-6) << std::endl;
+    }
+    if (mismatches)
+        std::cout << "ERROR::ENV: The server's results differ from a local BatchedBreakout" << std::endl;
+    return mismatches ? 2 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "env_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <vector>
+#if defined(__linux__)
+#include <cerrno>
+#include <signal.h>
+#endif
+
+#include "batched_breakout.h"
+#include "env_channel.h"
+#include "job_system.h"
+
+// Frames per slot: a client can read the results of the last ENV_RING - 1
+// requests while the next one runs
+const GLuint ENV_RING = 4;
+// How long the idle server sleeps before it checks for signals
+const GLuint IDLE_TIMEOUT_MS = 100;
+// How often the server looks for dead clients, busy or not
+const GLuint DEAD_CLIENT_SCAN_MS = 100;
+
+
+// Set by SIGINT/SIGTERM
+volatile std::sig_atomic_t StopRequested = 0;
+
+
+// function declaration
+void OnStopSignal(int);
+void ReleaseDeadClients(const EnvChannel& channel);
+
+
+int RunEnvServer(const GLchar* name, const Game& prototype, GLuint level, GLuint slots, GLuint worlds,
+    GLfloat dt, GLuint threads)
+{
+    if (level >= prototype.Levels.size() || prototype.Levels[level].Bricks.empty())
+    {
+        std::cout << "ERROR::ENV: Level " << level << " is not loaded" << std::endl;
+        return 1;
+    }
+    const GameLevel& layout = prototype.Levels[level];
+    EnvChannel channel;
+    if (!channel.Create(name, slots, worlds, static_cast<GLuint>(layout.Alive.size()), ENV_RING))
+        return 1;
+    EnvHeader& header = *channel.Header;
+    header.Level = level;
+    header.Width = prototype.Width;
+    header.Height = prototype.Height;
+    header.Dt = dt;
+    header.Running.store(1);
+    // clients accept the header once they see the magic
+    std::atomic_thread_fence(std::memory_order_release);
+    header.Magic = ENV_MAGIC;
+
+    JobSystem jobs(threads == 0 ? 0 : threads - 1);
+    std::vector<BatchedBreakout> batches;
+    batches.reserve(slots);
+    for (GLuint slot = 0; slot < slots; ++slot)
+    {
+        batches.emplace_back(layout, worlds, prototype.Width, prototype.Height, static_cast<std::uint64_t>(slot) * worlds);
+        batches.back().Jobs = &jobs;
+    }
+    std::signal(SIGINT, OnStopSignal);
+    std::signal(SIGTERM, OnStopSignal);
+    std::cout << "serving " << name << ": " << slots << " slots x " << worlds << " worlds of level " << level + 1
+        << ", " << header.TotalBytes << " bytes, " << jobs.Concurrency() << " threads" << std::endl;
+
+    unsigned long long requests = 0, steps = 0;
+    auto lastScan = std::chrono::steady_clock::now();
+    while (!StopRequested)
+    {
+        // read the doorbell before scanning, so a request posted during the scan wakes the wait below
+        std::uint32_t bell = header.Doorbell.load();
+        GLboolean served = GL_FALSE;
+        for (GLuint s = 0; s < slots; ++s)
+        {
+            EnvSlot& slot = *channel.Slot(s);
+            std::uint32_t request = slot.Request.load(std::memory_order_acquire);
+            if (request == slot.Response.load(std::memory_order_relaxed))
+                continue;
+            BatchedBreakout& batch = batches[s];
+            EnvFrame frame = channel.Frame(s, request);
+            if (slot.Command == ENV_STEP)
+            {
+                // the actions are read where the client wrote them
+                batch.Step(frame.Actions, dt);
+                steps += worlds;
+            }
+            else if (slot.Command == ENV_RESET)
+            {
+                for (GLuint w = 0; w < worlds; ++w)
+                    batch.Reset(w, slot.Seed + w);
+            }
+            WriteObservation(batch, frame);
+            if (slot.Command != ENV_STEP)
+            {   // nothing happened since the last step
+                std::fill(frame.Rewards, frame.Rewards + worlds, 0.0f);
+                std::fill(frame.Dones, frame.Dones + worlds, static_cast<GLubyte>(EPISODE_RUNNING));
+            }
+            slot.Response.store(request);
+            if (slot.ClientWaiting.load())
+                WakeAll(slot.Response);
+            ++requests;
+            served = GL_TRUE;
+        }
+        if (!served)
+            WaitForChange(header.Doorbell, bell, header.ServerSleeping, IDLE_TIMEOUT_MS);
+        // a crashed client's slot is freed even while others keep the server busy
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastScan >= std::chrono::milliseconds(DEAD_CLIENT_SCAN_MS))
+        {
+            ReleaseDeadClients(channel);
+            lastScan = now;
+        }
+    }
+
+    // let waiting clients see that the server is gone
+    header.Running.store(0);
+    for (GLuint s = 0; s < slots; ++s)
+        WakeAll(channel.Slot(s)->Response);
+    std::cout << "served " << requests << " requests, " << steps << " world steps" << std::endl;
+    return 0;
+}
+
+void OnStopSignal(int)
+{
+    StopRequested = 1;
+}
+
+// Frees the slots of clients that exited without disconnecting
+void ReleaseDeadClients(const EnvChannel& channel)
+{
+#if defined(__linux__)
+    for (GLuint s = 0; s < channel.Header->Slots; ++s)
+    {
+        EnvSlot& slot = *channel.Slot(s);
+        std::uint32_t owner = slot.Owner.load();
+        if (owner != 0 && kill(static_cast<pid_t>(owner), 0) != 0 && errno == ESRCH)
+        {
+            slot.Owner.compare_exchange_strong(owner, 0);
+            std::cout << "released slot " << s << " of exited client " << owner << std::endl;
+        }
+    }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "fixed_timestep.h"
+
+#include <cmath>
+
+
+FixedTimestep::FixedTimestep(GLdouble tickRate, GLuint maxTicks)
+    : TickRate(tickRate), MaxTicks(maxTicks), accumulator(0.0) { }
+
+GLuint FixedTimestep::Advance(GLdouble frameTime)
+{
+    GLdouble dt = 1.0 / this->TickRate;
+    this->accumulator += frameTime > 0.0 ? frameTime : 0.0;
+    GLdouble ticks = std::floor(this->accumulator / dt);
+    if (ticks > this->MaxTicks)
+    {
+        // too far behind, drop the backlog but keep the sub-tick remainder
+        this->accumulator = std::fmod(this->accumulator, dt);
+        return this->MaxTicks;
+    }
+    this->accumulator -= ticks * dt;
+    if (this->accumulator < 0.0)
+        this->accumulator = 0.0;
+    return static_cast<GLuint>(ticks);
+}
+
+GLfloat FixedTimestep::Dt() const
+{
+    return static_cast<GLfloat>(1.0 / this->TickRate);
+}
+
+GLfloat FixedTimestep::Alpha() const
+{
+    return static_cast<GLfloat>(this->accumulator * this->TickRate);
+}
\ No newline at end of file
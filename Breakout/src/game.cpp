@@ -1,70 +1,32 @@
 #include "game.h"
 
+#include <algorithm>
 
-typedef std::tuple<GLboolean, Direction, glm::vec2> Collision;
 
-SpriteRenderer* Renderer;
-GameObject* Player;
-BallObject* Ball;
-ParticleGenerator* Particles;
-PostProcessor* Effects;
-irrklang::ISoundEngine* SoundEngine=irrklang::createIrrKlangDevice();
-TextRenderer* Text;
-
-// 初始化挡板的大小
-const glm::vec2 PLAYER_SIZE(100, 20);
-// 初始化挡板的速率
-const GLfloat PLAYER_VELOCITY(500.0f);
-// 初始化球的速度
-const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
-// 球的半径
-const GLfloat BALL_RADIUS = 12.5f;
-// shake时间
-GLfloat ShakeTime = 0.0f;
+// 并行更新道具时每个任务处理的道具数
+const GLuint POWERUP_GRAIN = 64;
+// 多球道具分出的球相对原来的速度方向偏转30度
+const GLfloat SPLIT_COS = 0.8660254f;
+const GLfloat SPLIT_SIN = 0.5f;
 
 
 // function declaration
-Direction VectorDirection(glm::vec2 target);
-GLboolean CheckCollision(GameObject& one, GameObject& two);
-Collision CheckCollision(BallObject& one, GameObject& two);
-GLboolean ShouldSpawn(GLuint chance);
-void ActivatePowerUp(PowerUp& powerUp);
+GLboolean ShouldSpawn(Random& rng, GLuint chance);
 GLboolean IsOtherPowerUpActive(std::vector<PowerUp>& powerUps, std::string type);
 
 
 Game::Game(GLuint width, GLuint height)
-    : State(GAME_START), Keys(), Width(width), Height(height) { }
+    : State(GAME_START), Keys(), Width(width), Height(height), Level(0), Lives(3), KeyProcessed(),
+    Confuse(GL_FALSE), Chaos(GL_FALSE), RandomSeed(0), Jobs(nullptr),
+    MultiBall(GL_TRUE), StressBalls(0)
+{
+    this->SetSeed(this->RandomSeed);
+}
 
 Game::~Game() { }
 
 void Game::Init()
 {
-    // 加载着色器
-    ResourceManager::LoadShader("src/sprite.vs", "src/sprite.fs", nullptr, "sprite");
-    ResourceManager::LoadShader("src/particle.vs", "src/particle.fs", nullptr, "particle");
-    ResourceManager::LoadShader("src/post_processing.vs", "src/post_processing.fs", nullptr, "postprocessing");
-    // 配置着色器
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<GLfloat>(this->Width), 
-        static_cast<GLfloat>(this->Height), 0.0f, -1.0f, 1.0f);
-    ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("sprite").Use().SetMatrix4("projection", projection);
-    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").Use().SetMatrix4("projection", projection);
-    // 设置专用于渲染的控制
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-    // 加载纹理
-    ResourceManager::LoadTexture("resources/textures/awesomeface.png", GL_TRUE, "face");
-    ResourceManager::LoadTexture("resources/textures/background.jpg", GL_FALSE, "background");
-    ResourceManager::LoadTexture("resources/textures/block.png", GL_TRUE, "block");
-    ResourceManager::LoadTexture("resources/textures/block_solid.png", GL_TRUE, "block_solid");
-    ResourceManager::LoadTexture("resources/textures/paddle.png", GL_TRUE, "paddle");
-    ResourceManager::LoadTexture("resources/textures/particle.png", GL_TRUE, "particle");
-    ResourceManager::LoadTexture("resources/textures/powerup_speed.png", GL_TRUE, "powerup_speed");
-    ResourceManager::LoadTexture("resources/textures/powerup_sticky.png", GL_TRUE, "powerup_sticky");
-    ResourceManager::LoadTexture("resources/textures/powerup_increase.png", GL_TRUE, "powerup_increase");
-    ResourceManager::LoadTexture("resources/textures/powerup_passthrough.png", GL_TRUE, "powerup_passthrough");
-    ResourceManager::LoadTexture("resources/textures/powerup_chaos.png", GL_TRUE, "powerup_chaos");
-    ResourceManager::LoadTexture("resources/textures/powerup_confuse.png", GL_TRUE, "powerup_confuse");
     // 加载关卡
     GameLevel one, two, three, four;
     //GameLevel test;
@@ -81,61 +43,128 @@ void Game::Init()
     this->Level = 0;
     // 加载挡板
     glm::vec2 playerPos = glm::vec2(this->Width / 2 - PLAYER_SIZE.x / 2, this->Height - PLAYER_SIZE.y);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    this->Player = GameObject(playerPos, PLAYER_SIZE);
     // 加载球
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2 - BALL_RADIUS, -BALL_RADIUS * 2);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
-    // 加载粒子
-    Particles = new ParticleGenerator(
-        ResourceManager::GetShader("particle"), 
-        ResourceManager::GetTexture("particle"), 
-        1500
-    );
-    // 加载后处理
-    Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-    // 加载声音
-    SoundEngine->play2D("resources/audio/breakout.mp3", true);
-    // 加载字
-    Text = new TextRenderer(this->Width, this->Height);
-    Text->Load("resources/fonts/ocraext.TTF", 24);
+    this->Ball = BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY);
 
     this->Lives = 3;
-    Effects->Chaos = true;
+    this->Chaos = GL_TRUE;
+}
+
+void Game::SetSeed(std::uint64_t seed)
+{
+    this->RandomSeed = seed;
+    this->Rng.Seed(seed);
 }
 
 void Game::ResetLevel()
 {
-    if (this->Level == 0)this->Levels[0].Load("resources/levels/one.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 1)this->Levels[1].Load("resources/levels/two.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 2)this->Levels[2].Load("resources/levels/three.lvl", this->Width, this->Height * 0.5f);
-    else if (this->Level == 3)this->Levels[3].Load("resources/levels/four.lvl", this->Width, this->Height * 0.5f);
-    //else if (this->Level == 4)this->Levels[4].Load("resources/levels/zero.lvl", this->Width, this->Height * 0.5f);
+    // 恢复所有砖块即可，不必重新读取关卡文件
+    this->Levels[this->Level].Reset();
     this->Lives = 3;
 }
 
 void Game::ResetPlayer()
 {
     // reset player/ball stats
-    Player->Size = PLAYER_SIZE;
-    Player->Position = glm::vec2((this->Width - Player->Size.x) / 2, this->Height - Player->Size.y);
-    Ball->Reset(Player->Position +
-        glm::vec2(Player->Size.x / 2 - Ball->Radius, -Ball->Radius * 2), INITIAL_BALL_VELOCITY);
+    this->Player.Size = PLAYER_SIZE;
+    this->Player.Position = glm::vec2((this->Width - this->Player.Size.x) / 2, this->Height - this->Player.Size.y);
+    this->Ball.Reset(this->Player.Position +
+        glm::vec2(this->Player.Size.x / 2 - this->Ball.Radius, -this->Ball.Radius * 2), INITIAL_BALL_VELOCITY);
+    this->Balls.Clear();
+    // 重置属于瞬移，不做插值
+    this->Player.PrevPosition = this->Player.Position;
+    this->Ball.PrevPosition = this->Ball.Position;
     // also disable all active powerups
-    Effects->Chaos = Effects->Confuse = false;
-    Ball->PassThrough = Ball->Sticky = false;
-    Player->Color = glm::vec3(1.0f);
-    Ball->Color = glm::vec3(1.0f);
+    this->Chaos = this->Confuse = false;
+    this->Ball.PassThrough = this->Ball.Sticky = false;
+    this->Player.Color = glm::vec3(1.0f);
+    this->Ball.Color = glm::vec3(1.0f);
+}
+
+void Game::SetKey(GLuint key, GLboolean pressed)
+{
+    if (key >= 1024)
+        return;
+    this->Keys[key] = pressed;
+    // 松开按键后允许再次触发
+    if (!pressed)
+        this->KeyProcessed[key] = GL_FALSE;
+}
+
+std::uint32_t Game::Checksum() const
+{
+    // FNV-1a，浮点数按位参与运算
+    std::uint32_t hash = 2166136261u;
+    HashValue(hash, this->State);
+    HashValue(hash, this->Level);
+    HashValue(hash, this->Lives);
+    HashValue(hash, this->Player.Position);
+    HashValue(hash, this->Player.Size);
+    HashValue(hash, this->Ball.Position);
+    HashValue(hash, this->Ball.Velocity);
+    HashValue(hash, this->Ball.Stuck);
+    HashValue(hash, this->Ball.Sticky);
+    HashValue(hash, this->Ball.PassThrough);
+    HashValue(hash, this->Confuse);
+    HashValue(hash, this->Chaos);
+    HashValue(hash, this->Rng.State);
+    if (this->Level < this->Levels.size())
+        for (std::uint64_t word : this->Levels[this->Level].Alive)
+            HashValue(hash, word);
+    for (const PowerUp& powerup : this->PowerUps)
+    {
+        HashValue(hash, powerup.Position);
+        HashValue(hash, powerup.Duration);
+        HashValue(hash, powerup.Activated);
+        HashValue(hash, powerup.Destroyed);
+    }
+    // 球池为空时不参与，没有多球的对局与BatchedBreakout的校验和一致
+    for (GLuint i = 0; i < this->Balls.Size(); ++i)
+    {
+        HashValue(hash, this->Balls.X[i]);
+        HashValue(hash, this->Balls.Y[i]);
+        HashValue(hash, this->Balls.VX[i]);
+        HashValue(hash, this->Balls.VY[i]);
+    }
+    return hash;
+}
+
+void Game::Tick(GLfloat dt)
+{
+    // 记录本次tick开始时的位置，渲染时在两次tick之间插值
+    this->Player.PrevPosition = this->Player.Position;
+    this->Ball.PrevPosition = this->Ball.Position;
+    this->Balls.StorePrevious();
+    for (PowerUp& powerup : this->PowerUps)
+        powerup.PrevPosition = powerup.Position;
+    this->Events.Clear();
+    this->ProcessInput(dt);
+    this->Update(dt);
 }
 
 void Game::Update(GLfloat dt)
 {
-    // update ball
-    Ball->Move(dt, this->Width);
-    // update collision
-    this->DoCollisions();
-    if (Ball->Position.y >= this->Height)
+    // 压力测试：补足球池中的球
+    if (this->State == GAME_ACTIVE && this->Balls.Size() < this->StressBalls)
+        this->SpawnBalls(this->StressBalls - this->Balls.Size());
+    // update ball and collision
+    this->DoCollisions(dt);
+    if (this->Ball.Position.y >= this->Height && this->Balls.Size() > 0)
+    {   // 球池中还有球时不扣生命，由最后一个球接替
+        GLuint last = this->Balls.Size() - 1;
+        // 两种球半径可能不同，按球心换算左上角位置
+        GLfloat offset = this->Balls.Radius - this->Ball.Radius;
+        this->Ball.Position = glm::vec2(this->Balls.X[last], this->Balls.Y[last]) + offset;
+        this->Ball.PrevPosition = glm::vec2(this->Balls.PrevX[last], this->Balls.PrevY[last]) + offset;
+        this->Ball.Velocity = glm::vec2(this->Balls.VX[last], this->Balls.VY[last]);
+        this->Balls.Remove(last);
+    }
+    else if (this->Ball.Position.y >= this->Height)
     {
         --this->Lives;
+        this->Events.Push(EVENT_LIFE_LOST, this->Lives, this->Ball.Position);
         if (this->Lives == 0)
         {
             this->ResetLevel();
@@ -143,15 +172,6 @@ void Game::Update(GLfloat dt)
         }
         this->ResetPlayer();
     }
-    // update particles
-    Particles->Update(dt, *Ball, 1, glm::vec2(BALL_RADIUS / 2));
-    // update shake time
-    if (ShakeTime > 0.0f)
-    {
-        ShakeTime -= dt;
-        if (ShakeTime <= 0.0f)
-            Effects->Shake = false;
-    }
     // update powerup
     this->UpdatePowerUps(dt);
     // check win
@@ -159,9 +179,9 @@ void Game::Update(GLfloat dt)
     {
         this->ResetLevel();
         this->ResetPlayer();
-        Effects->Chaos = true;
+        this->Chaos = true;
         this->State = GAME_WIN;
-        SoundEngine->play2D("resources/audio/victory.wav", false);
+        this->Events.Push(EVENT_LEVEL_COMPLETED, this->Level, glm::vec2(0.0f));
     }
 }
 
@@ -169,29 +189,29 @@ void Game::ProcessInput(GLfloat dt)
 {
     if (this->State == GAME_ACTIVE)
     {
-        GLfloat velocity = dt * PLAYER_VELOCITY;
+        Scalar velocity = ToScalar(dt) * PLAYER_VELOCITY;
         // 移动挡板
         if (this->Keys[GLFW_KEY_A])
         {
-            if (Player->Position.x >= 0)
+            if (this->Player.Position.x >= 0)
             {
-                Player->Position.x -= velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x -= velocity;
+                this->Player.Position.x = ToFloat(ToScalar(this->Player.Position.x) - velocity);
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x = ToFloat(ToScalar(this->Ball.Position.x) - velocity);
             }
         }
         if (this->Keys[GLFW_KEY_D])
         {
-            if (Player->Position.x <= this->Width - Player->Size.x)
+            if (this->Player.Position.x <= this->Width - this->Player.Size.x)
             {
-                Player->Position.x += velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x += velocity;
+                this->Player.Position.x = ToFloat(ToScalar(this->Player.Position.x) + velocity);
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x = ToFloat(ToScalar(this->Ball.Position.x) + velocity);
             }
         }
         // 释放球
         if (this->Keys[GLFW_KEY_SPACE])
-            Ball->Stuck = false;
+            this->Ball.Stuck = false;
     }
     if (this->State == GAME_MENU)
     {
@@ -217,7 +237,7 @@ void Game::ProcessInput(GLfloat dt)
         if (this->Keys[GLFW_KEY_ENTER])
         {
             this->KeyProcessed[GLFW_KEY_ENTER] = true;
-            Effects->Chaos = false;
+            this->Chaos = false;
             this->State = GAME_MENU;
         }
     }
@@ -227,291 +247,294 @@ void Game::ProcessInput(GLfloat dt)
         {
             this->KeyProcessed[GLFW_KEY_ENTER] = true;
             this->State = GAME_MENU;
-            Effects->Chaos = false;
+            this->Chaos = false;
         }
     }
 }
 
-void Game::Render()
-{
-    if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State==GAME_START)
-    {
-        Effects->BeginRender();
-            // 绘制背景
-            Renderer->DrawSprite(ResourceManager::GetTexture("background"), 
-                glm::vec2(0, 0), glm::vec2(this->Width, this->Height), 0.0f);
-            // 绘制关卡
-            this->Levels[this->Level].Draw(*Renderer);
-            // 绘制挡板
-            Player->Draw(*Renderer);
-            // 绘制道具
-            for (PowerUp& powerup : this->PowerUps)
-                if (!powerup.Destroyed)
-                    powerup.Draw(*Renderer);
-            // 绘制粒子
-            Particles->Draw();
-            // 绘制球
-            Ball->Draw(*Renderer);
-        Effects->EndRender();
-        Effects->Render(glfwGetTime());
-        // 绘制文字
-        std::stringstream ss; ss << this->Lives;
-        Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
-    }
-    if (this->State == GAME_MENU)
-    {
-        std::stringstream levelss; levelss << this->Level + 1;
-        Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2, 1.0f);
-        Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2 + 20.0f, 0.75f);
-        Text->RenderText("Level:" + levelss.str(), 5.0f, this->Height - 20.0, 1.0f);
-    }
-    if (this->State == GAME_WIN)
-    {
-        Text->RenderText(
-            "You WON!!!", 320.0, this->Height / 2 - 20.0, 1.0, glm::vec3(1.0, 1.0, 0.0)
-        );
-        Text->RenderText(
-            "Press ENTER to retry or ESC to quit", 130.0, Height / 2, 1.0, glm::vec3(1.0, 1.0, 0.0)
-        );
-    }
-    if (this->State == GAME_START)
-    {
-        Text->RenderText(
-            "BREAKOUT", 210.0, Height * 2 / 5, 3.0, glm::vec3(1.0, 1.0, 0.0)
-        );
-        Text->RenderText(
-            "Press ENTER to start or ESC to quit", 130.0, Height * 2 / 3, 1.0, glm::vec3(1.0, 1.0, 0.0)
-        );
-    }
-}
-
-void Game::DoCollisions()
+void Game::DoCollisions(GLfloat dt)
 {
+    // 重建物理世界：砖块为静态物体，挡板为运动学物体，球和道具为动态物体
+    PhysicsWorld& physics = this->Physics;
+    physics.Reset(&this->Levels[this->Level], static_cast<GLfloat>(this->Width), static_cast<GLfloat>(this->Height));
+    physics.AddKinematic(this->Player.Position, this->Player.Size, LAYER_PADDLE, 0);
+    // 移动球：按最早接触时间依次处理墙壁、砖块和挡板的碰撞
+    GLboolean hitPaddle = this->sweepBall(this->Ball.Position, this->Ball.Velocity, this->Ball.Radius,
+        this->Ball.Sticky, this->Ball.Stuck, dt);
+    if (this->Balls.Size() > 0)
+        this->sweepBalls(dt);
     if (this->State == GAME_ACTIVE)
     {
-        // 砖块碰撞
-        for (GameObject& box : this->Levels[this->Level].Bricks)
+        // 挡板移动后压到球上时，扫掠检测不到，由重叠检测补上
+        physics.AddCircle(this->Ball.Position, this->Ball.Radius, LAYER_BALL, LAYER_PADDLE);
+        for (GLuint i = 0; i < this->PowerUps.size(); ++i)
         {
-            if (!box.Destroyed)
+            PowerUp& powerup = this->PowerUps[i];
+            if (!powerup.Destroyed)
             {
-                Collision collision = CheckCollision(*Ball, box);
-                if (std::get<0>(collision))
-                {
-                    // 如果砖块不是实心就销毁砖块
-                    if (!box.IsSolid)
-                    {
-                        box.Destroyed = GL_TRUE;
-                        this->SpawnPowerUps(box);
-                        SoundEngine->play2D("resources/audio/bleep.mp3", false);
-                    }
-                    else
-                    {   // 如果是实心的砖块则激活shake特效
-                        ShakeTime = 0.05f;
-                        Effects->Shake = true;
-                        SoundEngine->play2D("resources/audio/solid.wav", false);
-                    }
-                    // 碰撞处理
-                    Direction dir = std::get<1>(collision);
-                    glm::vec2 diff_vector = std::get<2>(collision);
-                    if (!(Ball->PassThrough && !box.IsSolid))
-                    {
-                        if (dir == LEFT || dir == RIGHT) // 水平方向碰撞
-                        {
-                            Ball->Velocity.x = -Ball->Velocity.x; // 反转水平速度
-                            // 重定位
-                            GLfloat penetration = Ball->Radius - std::abs(diff_vector.x);
-                            if (dir == LEFT)
-                                Ball->Position.x += penetration; // 将球右移
-                            else
-                                Ball->Position.x -= penetration; // 将球左移
-                        }
-                        else // 垂直方向碰撞
-                        {
-                            Ball->Velocity.y = -Ball->Velocity.y; // 反转垂直速度
-                            // 重定位
-                            GLfloat penetration = Ball->Radius - std::abs(diff_vector.y);
-                            if (dir == UP)
-                                Ball->Position.y -= penetration; // 将球上移
-                            else
-                                Ball->Position.y += penetration; // 将球下移
-                        }
-                    }
-                }
+                physics.AddBox(powerup.Position, powerup.Size, LAYER_POWERUP, LAYER_PADDLE, i);
+                // 掉出屏幕的道具被销毁，但这一帧仍可被挡板接住
+                if (powerup.Position.y >= this->Height)
+                    powerup.Destroyed = GL_TRUE;
             }
         }
-        // 挡板碰撞
-        Collision result = CheckCollision(*Ball, *Player);
-        if (!Ball->Stuck && std::get<0>(result))
-        {
-            // 检查碰到了挡板的哪个位置，并根据碰到哪个位置来改变速度
-            GLfloat centerBoard = Player->Position.x + Player->Size.x / 2;
-            GLfloat distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-            GLfloat percentage = distance / (Player->Size.x / 2);
-            // 依据结果移动，撞击点距离挡板的中心点越远，则水平方向的速度就会越大
-            GLfloat strength = 2.0f;
-            glm::vec2 oldVelocity = Ball->Velocity;
-            Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-            Ball->Velocity.y = -std::abs(Ball->Velocity.y);
-            Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
-
-            Ball->Stuck = Ball->Sticky;
-            SoundEngine->play2D("resources/audio/bleep.wav", false);
-        }
-        // 道具碰撞
-        for (PowerUp& powerup : this->PowerUps)
+        physics.FindContacts();
+        GLuint next = 0;
+        while (next < physics.Contacts.size())
         {
-            if (!powerup.Destroyed)
+            Contact contact = physics.Contacts[next++];
+            const PhysicsBody& body = physics.Dynamics[contact.Body];
+            if (body.Layer == LAYER_BALL)
             {
-                if (powerup.Position.y >= this->Height)
-                    powerup.Destroyed = GL_TRUE;
-                if (CheckCollision(*Player, powerup))
-                {   // 道具与挡板接触，激活它！
-                    ActivatePowerUp(powerup);
-                    powerup.Destroyed = GL_TRUE;
-                    powerup.Activated = GL_TRUE;
-                    SoundEngine->play2D("resources/audio/powerup.wav", false);
+                if (!hitPaddle && !this->Ball.Stuck && this->Ball.Velocity.y > 0.0f)
+                {
+                    this->bouncePaddle(this->Ball.Position, this->Ball.Velocity, this->Ball.Radius);
+                    this->Ball.Stuck = this->Ball.Sticky;
                 }
+                continue;
+            }
+            // 道具与挡板接触，激活它！
+            PowerUp& powerup = this->PowerUps[body.Owner];
+            this->activatePowerUp(powerup);
+            powerup.Destroyed = GL_TRUE;
+            powerup.Activated = GL_TRUE;
+            this->Events.Push(EVENT_POWERUP_COLLECTED, body.Owner, powerup.Position);
+            // 挡板变大后，之后的道具要按新的挡板重新检测
+            if (ToVec2(this->Player.Size) != physics.Kinematics[0].Size)
+            {
+                physics.Kinematics[0].Size = ToVec2(this->Player.Size);
+                physics.FindContacts(contact.Body + 1);
+                next = 0;
             }
         }
     }
 }
 
-Direction VectorDirection(glm::vec2 target)
+GLboolean Game::sweepBall(glm::vec2& position, glm::vec2& velocity, GLfloat radius,
+    GLboolean sticky, GLboolean& stuck, GLfloat dt)
 {
-    glm::vec2 compass[] = {
-        glm::vec2(0.0f,1.0f),  // 上
-        glm::vec2(1.0f,0.0f),  // 右
-        glm::vec2(0.0f,-1.0f), // 下
-        glm::vec2(-1.0f,0.0f), // 左
-    };
-    GLfloat max = 0.0f;
-    GLuint best_match = -1;
-    glm::vec2 normal_target = glm::normalize(target);
-    for (GLuint i = 0; i < 4; i++)
+    // 只在游戏进行中与砖块和挡板碰撞，墙壁总是有效
+    GLuint mask = this->State == GAME_ACTIVE ? LAYER_BRICK | LAYER_PADDLE : 0;
+    GLboolean hitPaddle = GL_FALSE;
+    Scalar scalarRadius = ToScalar(radius);
+    Scalar remaining = ToScalar(dt);
+    for (GLuint bounce = 0; bounce < MAX_BOUNCES && !stuck && remaining > 0.0f; ++bounce)
     {
-        GLfloat dot_res = glm::dot(normal_target, compass[i]);
-        if (dot_res > max)
+        Vec2 start = ToVec2(position);
+        Vec2 motion = ToVec2(velocity) * remaining;
+        // 找出最早的接触
+        SweepHit first;
+        Contact contact;
+        if (!this->Physics.Sweep(start + scalarRadius, scalarRadius, mask, motion, first, contact))
         {
-            max = dot_res;
-            best_match = i;
+            position = ToGlm(start + motion);
+            break;
+        }
+        // 移动到接触点并处理碰撞
+        start += motion * first.Time;
+        position = ToGlm(start);
+        remaining -= remaining * first.Time;
+        if (contact.Kind == CONTACT_KINEMATIC)
+        {
+            hitPaddle = GL_TRUE;
+            this->bouncePaddle(position, velocity, radius);
+            stuck = sticky;
+        }
+        else if (contact.Kind == CONTACT_STATIC)
+            this->hitBrick(contact.Other, first.Normal, velocity);
+        else
+        {   // 墙壁：夹回边界内并反转速度
+            start.x = Clamp(start.x, 0.0f, ToScalar(this->Width - radius * 2.0f));
+            start.y = Max(start.y, 0.0f);
+            position = ToGlm(start);
+            Vec2 reflected = ToVec2(velocity);
+            Reflect(reflected, first.Normal);
+            velocity = ToGlm(reflected);
         }
     }
-    return (Direction)best_match;
+    return hitPaddle;
 }
 
-GLboolean CheckCollision(GameObject& one, GameObject& two) // AABB - AABB collision
+void Game::sweepBalls(GLfloat dt)
 {
-    // x方向碰撞
-    bool collisionX = one.Position.x + one.Size.x >= two.Position.x 
-        && two.Position.x + two.Size.x >= one.Position.x;
-    // y方向碰撞
-    bool collisionY = one.Position.y + one.Size.y >= two.Position.y 
-        && two.Position.y + two.Size.y >= one.Position.y;
-    // 两个轴都碰撞则判定碰撞
-    return collisionX && collisionY;
+    BallPool& balls = this->Balls;
+    Vec2 paddlePosition = ToVec2(this->Player.Position), paddleSize = ToVec2(this->Player.Size);
+    Scalar radius = ToScalar(balls.Radius);
+    for (GLuint i = 0; i < balls.Size(); ++i)
+    {
+        glm::vec2 position(balls.X[i], balls.Y[i]), velocity(balls.VX[i], balls.VY[i]);
+        // 球池中的球从不粘在挡板上
+        GLboolean stuck = GL_FALSE;
+        GLboolean hitPaddle = this->sweepBall(position, velocity, balls.Radius, GL_FALSE, stuck, dt);
+        // 与主球相同，挡板压到球上时由重叠检测补上
+        if (this->State == GAME_ACTIVE && !hitPaddle && velocity.y > 0.0f &&
+            OverlapCircleAABB(ToVec2(position) + radius, radius, paddlePosition, paddleSize))
+            this->bouncePaddle(position, velocity, balls.Radius);
+        balls.X[i] = position.x;
+        balls.Y[i] = position.y;
+        balls.VX[i] = velocity.x;
+        balls.VY[i] = velocity.y;
+    }
+    // 掉出屏幕的球直接移除，从后往前删除不会漏掉换到当前位置的球
+    for (GLuint i = balls.Size(); i-- > 0; )
+        if (balls.Y[i] >= this->Height)
+            balls.Remove(i);
+    // 球与球之间的碰撞，粘在挡板上的主球不参与
+    if (balls.Collide(this->Ball.Stuck ? nullptr : &this->Ball, this->Jobs) > 0)
+    {   // 被推开的球夹回墙壁以内，下一步的扫掠才能找到墙壁
+        GLfloat right = this->Width - balls.Radius * 2.0f;
+        for (GLuint i = 0; i < balls.Size(); ++i)
+        {
+            balls.X[i] = std::min(std::max(balls.X[i], 0.0f), right);
+            balls.Y[i] = std::max(balls.Y[i], 0.0f);
+        }
+        right = this->Width - this->Ball.Radius * 2.0f;
+        this->Ball.Position.x = std::min(std::max(this->Ball.Position.x, 0.0f), right);
+        this->Ball.Position.y = std::max(this->Ball.Position.y, 0.0f);
+    }
 }
 
-Collision CheckCollision(BallObject& one, GameObject& two) // AABB - Circle collision
+void Game::hitBrick(GLuint index, Vec2 normal, glm::vec2& velocity)
 {
-    // 获取圆心
-    glm::vec2 center(one.Position + one.Radius);
-    // 获取aabb中心
-    glm::vec2 aabb_half_extends(two.Size.x / 2, two.Size.y / 2);
-    glm::vec2 aabb_center(two.Position.x + aabb_half_extends.x, two.Position.y + aabb_half_extends.y);
-    // 两中心的矢量差
-    glm::vec2 difference = center - aabb_center;
-    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extends, aabb_half_extends);
-    // AABB_center加上clamped这样就得到了碰撞箱上距离圆最近的点closest
-    glm::vec2 closest = aabb_center + clamped;
-    // 获得圆心center和最近点closest的矢量并判断是否 length <= radius
-    difference = closest - center;
-    if (glm::length(difference) <= one.Radius)
-        return std::make_tuple(GL_TRUE, VectorDirection(difference), difference);
+    GameObject& box = this->Levels[this->Level].Bricks[index];
+    // 如果砖块不是实心就销毁砖块
+    if (!box.IsSolid)
+    {
+        this->Levels[this->Level].Destroy(index);
+        this->SpawnPowerUps(box);
+        this->Events.Push(EVENT_BRICK_DESTROYED, index, box.Position);
+    }
     else
-        return std::make_tuple(GL_FALSE, UP, glm::vec2(0, 0));
+        this->Events.Push(EVENT_SOLID_HIT, index, box.Position);
+    // 碰撞处理：穿透状态下直接穿过非实心砖块
+    if (!(this->Ball.PassThrough && !box.IsSolid))
+    {
+        Vec2 reflected = ToVec2(velocity);
+        Reflect(reflected, normal);
+        velocity = ToGlm(reflected);
+    }
+}
+
+void Game::bouncePaddle(glm::vec2 position, glm::vec2& velocity, GLfloat radius)
+{
+    // 检查碰到了挡板的哪个位置，并根据碰到哪个位置来改变速度
+    Scalar centerBoard = ToScalar(this->Player.Position.x) + ToScalar(this->Player.Size.x) / 2;
+    Scalar distance = (ToScalar(position.x) + ToScalar(radius)) - centerBoard;
+    Scalar percentage = distance / (ToScalar(this->Player.Size.x) / 2);
+    // 依据结果移动，撞击点距离挡板的中心点越远，则水平方向的速度就会越大
+    Scalar strength = 2.0f;
+    Vec2 oldVelocity = ToVec2(velocity);
+    Vec2 bounced(ToScalar(INITIAL_BALL_VELOCITY.x) * percentage * strength, -Abs(oldVelocity.y));
+    velocity = ToGlm(Normalize(bounced) * Length(oldVelocity));
+
+    this->Events.Push(EVENT_PADDLE_HIT, 0, position);
 }
 
 void Game::SpawnPowerUps(GameObject& block)
 {
-    if (ShouldSpawn(45))
-        this->PowerUps.push_back(
-            PowerUp("speed", glm::vec3(0.5f, 0.5f, 0.5f), 0.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_speed"))
-        );
-    if (ShouldSpawn(30))
-        this->PowerUps.push_back(
-            PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_sticky"))
-        );
-    if (ShouldSpawn(30))
-        this->PowerUps.push_back(
-            PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_passthrough"))
-        );
-    if (ShouldSpawn(30))
-        this->PowerUps.push_back(
-            PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_increase"))
-        );
-    if (ShouldSpawn(15)) // 负面道具被更频繁地生成
-        this->PowerUps.push_back(
-            PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_confuse"))
-        );
-    if (ShouldSpawn(15))
-        this->PowerUps.push_back(
-            PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, 
-                ResourceManager::GetTexture("powerup_chaos"))
-        );
+    // 每种道具依次独立判定是否生成
+    GLuint kinds = this->MultiBall ? POWERUP_KINDS : CLASSIC_POWERUP_KINDS;
+    for (GLuint kind = 0; kind < kinds; ++kind)
+    {
+        if (ShouldSpawn(this->Rng, POWERUP_CHANCES[kind]))
+        {
+            this->PowerUps.push_back(
+                PowerUp(POWERUP_TYPES[kind], POWERUP_COLORS[kind], POWERUP_DURATIONS[kind], block.Position)
+            );
+            this->Events.Push(EVENT_POWERUP_SPAWNED, kind, block.Position);
+        }
+    }
 }
 
-GLboolean ShouldSpawn(GLuint chance)
+GLboolean ShouldSpawn(Random& rng, GLuint chance)
 {
-    GLuint random = rand() % chance;
+    GLuint random = rng.Below(chance);
     return random == 0;
 }
 
-void ActivatePowerUp(PowerUp& powerUp)
+void Game::activatePowerUp(PowerUp& powerUp)
 {
     // 根据道具类型发动道具
     if (powerUp.Type == "speed")
     {
-        Ball->Velocity *= 1.2;
+        this->Ball.Velocity *= 1.2;
     }
     else if (powerUp.Type == "sticky")
     {
-        Ball->Sticky = GL_TRUE;
-        Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
+        this->Ball.Sticky = GL_TRUE;
+        this->Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
     }
     else if (powerUp.Type == "pass-through")
     {
-        Ball->PassThrough = GL_TRUE;
-        Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
+        this->Ball.PassThrough = GL_TRUE;
+        this->Ball.Color = glm::vec3(1.0f, 0.5f, 0.5f);
     }
     else if (powerUp.Type == "pad-size-increase")
     {
-        Player->Size.x += 50;
+        this->Player.Size.x += 50;
     }
     else if (powerUp.Type == "confuse")
     {
-        if (!Effects->Chaos)
-            Effects->Confuse = GL_TRUE; // 只在chaos未激活时生效，chaos同理
+        if (!this->Chaos)
+            this->Confuse = GL_TRUE; // 只在chaos未激活时生效，chaos同理
     }
     else if (powerUp.Type == "chaos")
     {
-        if (!Effects->Confuse)
-            Effects->Chaos = GL_TRUE;
+        if (!this->Confuse)
+            this->Chaos = GL_TRUE;
+    }
+    else if (powerUp.Type == "multi-ball")
+    {
+        // 在主球处分出两个球，速度方向分别偏转正负30度，并且都向上飞
+        Vec2 velocity = ToVec2(this->Ball.Velocity);
+        Scalar cosine = ToScalar(SPLIT_COS), sine = ToScalar(SPLIT_SIN);
+        glm::vec2 position = this->Ball.Position + this->Ball.Radius - this->Balls.Radius;
+        for (GLint side = -1; side <= 1; side += 2)
+        {
+            Scalar turn = side < 0 ? -sine : sine;
+            Vec2 split(velocity.x * cosine - velocity.y * turn, velocity.x * turn + velocity.y * cosine);
+            split.y = -Abs(split.y);
+            this->Balls.Add(position, ToGlm(split));
+        }
+    }
+}
+
+void Game::SpawnBalls(GLuint count)
+{
+    // 速度大小与初始速度相同，水平分量随机，竖直分量由此求出
+    // 全部在物理数值类型中计算，定点数下不受编译选项影响
+    Scalar speed = Length(ToVec2(INITIAL_BALL_VELOCITY));
+    Scalar width = ToScalar(this->Width - this->Balls.Radius * 2.0f), height = ToScalar(static_cast<GLfloat>(this->Height));
+    for (GLuint i = 0; i < count; ++i)
+    {
+        Vec2 position(ToScalar(this->Rng.Float()) * width, height * (ToScalar(0.5f) + ToScalar(this->Rng.Float()) * 0.3f));
+        Scalar x = speed * (ToScalar(this->Rng.Float()) * 1.6f - 0.8f);
+        Vec2 velocity(x, -Sqrt(speed * speed - x * x));
+        this->Balls.Add(ToGlm(position), ToGlm(velocity));
     }
 }
 
 void Game::UpdatePowerUps(GLfloat dt)
 {
+    // 移动道具并减少持续时间，各道具互不影响，可以并行
+    std::vector<PowerUp>& powerups = this->PowerUps;
+    auto advance = [&powerups, dt](GLuint begin, GLuint end) {
+        for (GLuint i = begin; i < end; ++i)
+        {
+            powerups[i].Position = ToGlm(ToVec2(powerups[i].Position) + ToVec2(powerups[i].Velocity) * ToScalar(dt));
+            if (powerups[i].Activated)
+                powerups[i].Duration -= dt;
+        }
+    };
+    if (this->Jobs)
+        this->Jobs->ParallelFor(static_cast<GLuint>(powerups.size()), POWERUP_GRAIN, advance);
+    else
+        advance(0, static_cast<GLuint>(powerups.size()));
+    // 停用到期的道具要按顺序进行，因为要检查其他同类道具是否仍然激活
     for (PowerUp& powerup : this->PowerUps)
     {
-        powerup.Position += powerup.Velocity * dt;
         if (powerup.Activated)
         {
-            powerup.Duration -= dt;
             if (powerup.Duration <= 0.0f)
             {
                 // 之后会将这个道具移除
@@ -521,30 +544,30 @@ void Game::UpdatePowerUps(GLfloat dt)
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "sticky"))
                     {   // 仅当没有其他sticky效果处于激活状态时重置，以下同理
-                        Ball->Sticky = GL_FALSE;
-                        Player->Color = glm::vec3(1.0f);
+                        this->Ball.Sticky = GL_FALSE;
+                        this->Player.Color = glm::vec3(1.0f);
                     }
                 }
                 else if (powerup.Type == "pass-through")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "pass-through"))
                     {
-                        Ball->PassThrough = GL_FALSE;
-                        Ball->Color = glm::vec3(1.0f);
+                        this->Ball.PassThrough = GL_FALSE;
+                        this->Ball.Color = glm::vec3(1.0f);
                     }
                 }
                 else if (powerup.Type == "confuse")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
                     {
-                        Effects->Confuse = GL_FALSE;
+                        this->Confuse = GL_FALSE;
                     }
                 }
                 else if (powerup.Type == "chaos")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
                     {
-                        Effects->Chaos = GL_FALSE;
+                        this->Chaos = GL_FALSE;
                     }
                 }
             }
@@ -1,11 +1,11 @@
 #include "game_level.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 
 void GameLevel::Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight)
 {
-    // չ
-    this->Bricks.clear();
     // ļм
     GLuint tileCode;
     GameLevel level;
@@ -22,29 +22,54 @@ void GameLevel::Load(const GLchar* file, GLuint levelWidth, GLuint levelHeight)
                 row.push_back(tileCode);
             tileData.push_back(row);
         }
-        if (!tileData.empty())
-            this->init(tileData, levelWidth, levelHeight);
     }
+    // չݲؽؿ
+    this->Load(tileData, levelWidth, levelHeight);
 }
 
-void GameLevel::init(std::vector<std::vector<GLuint>> tileData, GLuint lvlWidth, GLuint lvlHeight)
+void GameLevel::Load(const std::vector<std::vector<GLuint>>& tileData, GLuint levelWidth, GLuint levelHeight)
+{
+    this->Bricks.clear();
+    this->Alive.clear();
+    this->Remaining = 0;
+    this->brickCells.clear();
+    this->Cells.clear();
+    this->CellBounds.Resize(0);
+    this->GridWidth = this->GridHeight = 0;
+    if (!tileData.empty())
+        this->init(tileData, levelWidth, levelHeight);
+}
+
+void GameLevel::init(const std::vector<std::vector<GLuint>>& tileData, GLuint lvlWidth, GLuint lvlHeight)
 {
     // ÿάȵĴС
     GLuint height = tileData.size();
     GLuint width = tileData[0].size();
     GLfloat unit_width = lvlWidth / static_cast<GLfloat>(width);
     GLfloat unit_height = lvlHeight / height;
+    // שһһӦ
+    this->GridWidth = width;
+    this->GridHeight = height;
+    this->CellSize = glm::vec2(unit_width, unit_height);
+    this->Cells.assign(width * height, -1);
+    this->CellBounds.Resize(width * height);
     // tileDataCʼؿ
     for (GLuint y = 0; y < height; ++y)
     {
         for (GLuint x = 0; x < width; ++x)
         {
+            if (tileData[y][x] > 0)
+            {
+                this->Cells[y * width + x] = static_cast<GLint>(this->Bricks.size());
+                this->brickCells.push_back(y * width + x);
+                this->CellBounds.Set(y * width + x, glm::vec2(unit_width * x, unit_height * y), glm::vec2(unit_width, unit_height));
+            }
             // ש
             if (tileData[y][x] == 1)
             {
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
+                GameObject obj(pos, size, glm::vec3(0.8f, 0.8f, 0.7f));
                 obj.IsSolid = GL_TRUE;
                 this->Bricks.push_back(obj);
             }
@@ -61,27 +86,125 @@ void GameLevel::init(std::vector<std::vector<GLuint>> tileData, GLuint lvlWidth,
                     color = glm::vec3(0.8f, 0.8f, 0.4f);
                 else if (tileData[y][x] == 5)
                     color = glm::vec3(1.0f, 0.5f, 0.0f);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                this->Bricks.push_back(GameObject(pos, size, color));
+                ++this->Remaining;
             }
         }
     }
+    // שʼ
+    this->Alive.assign((this->Bricks.size() + 63) / 64, 0);
+    for (GLuint i = 0; i < this->Bricks.size(); ++i)
+        this->Alive[i >> 6] |= std::uint64_t(1) << (i & 63);
+}
+
+void GameLevel::Destroy(GLuint index)
+{
+    if (!this->IsAlive(index))
+        return;
+    this->Alive[index >> 6] &= ~(std::uint64_t(1) << (index & 63));
+    if (!this->Bricks[index].IsSolid)
+        --this->Remaining;
+    // ĸӣⲻѡ
+    this->CellBounds.Clear(this->brickCells[index]);
+    this->Bricks[index].Destroyed = GL_TRUE;
+}
+
+void GameLevel::Revive(GLuint index)
+{
+    if (this->IsAlive(index))
+        return;
+    GameObject& brick = this->Bricks[index];
+    this->Alive[index >> 6] |= std::uint64_t(1) << (index & 63);
+    if (!brick.IsSolid)
+        ++this->Remaining;
+    this->CellBounds.Set(this->brickCells[index], brick.Position, brick.Size);
+    brick.Destroyed = GL_FALSE;
+}
+
+void GameLevel::SetAlive(const std::uint64_t* alive)
+{
+    for (GLuint word = 0; word < this->Alive.size(); ++word)
+    {
+        // ֻ״̬ıλ
+        for (std::uint64_t flips = this->Alive[word] ^ alive[word]; flips; flips &= flips - 1)
+        {
+            GLuint bit = LowestBit(flips);
+            if ((alive[word] >> bit) & 1)
+                this->Revive(word * 64 + bit);
+            else
+                this->Destroy(word * 64 + bit);
+        }
+    }
 }
 
-void GameLevel::Draw(SpriteRenderer& renderer)
+void GameLevel::Reset()
 {
-    for (GameObject& obj : this->Bricks)
+    for (GLuint word = 0; word < this->Alive.size(); ++word)
     {
-        if (!obj.Destroyed)
-            obj.Draw(renderer);
+        for (std::uint64_t dead = ~this->Alive[word]; dead; dead &= dead - 1)
+        {
+            GLuint index = word * 64 + LowestBit(dead);
+            if (index < this->Bricks.size())
+                this->Revive(index);
+        }
     }
 }
 
-GLboolean GameLevel::IsCompleted()
+template <typename V>
+GLint GameLevel::SweepBricks(V center, typename V::value_type radius, V motion, BasicSweepHit<V>& hit,
+    const std::uint64_t* alive) const
 {
-    for (GameObject& obj : this->Bricks)
+    if (this->Cells.empty())
+        return -1;
+    // ӷΧּⶼfloat (1)ֻоȷɨVֵ
+    glm::vec2 c = ToGlm(center), m = ToGlm(motion);
+    GLfloat r = ToFloat(radius);
+    // ɨӷΧ1أ֤պŸӱ߽שҲᱻ
+    glm::vec2 sweepMin = glm::min(c, c + m) - r - 1.0f;
+    glm::vec2 sweepMax = glm::max(c, c + m) + r + 1.0f;
+    glm::vec2 first = glm::floor(sweepMin / this->CellSize);
+    glm::vec2 last = glm::floor(sweepMax / this->CellSize);
+    if (last.x < 0.0f || last.y < 0.0f || first.x >= this->GridWidth || first.y >= this->GridHeight)
+        return -1;
+    GLuint x0 = static_cast<GLuint>(std::max(first.x, 0.0f));
+    GLuint y0 = static_cast<GLuint>(std::max(first.y, 0.0f));
+    GLuint x1 = static_cast<GLuint>(std::min(last.x, this->GridWidth - 1.0f));
+    GLuint y1 = static_cast<GLuint>(std::min(last.y, this->GridHeight - 1.0f));
+    // ɨӶԲڣصĸӣٶЩȷɨ
+    glm::vec2 middle = c + m * 0.5f;
+    GLfloat reach = r + glm::length(m) * 0.5f + 1.0f;
+    GLfloat diffX[BOX_BATCH], diffY[BOX_BATCH];
+    // ȱBricks˳ͬʱͬʱѡеשҲͬ
+    GLint result = -1;
+    BasicSweepHit<V> test;
+    for (GLuint y = y0; y <= y1; ++y)
     {
-        if (!obj.Destroyed && !obj.IsSolid)
-            return GL_FALSE;
+        for (GLuint x = x0; x <= x1; x += BOX_BATCH)
+        {
+            GLuint cell = y * this->GridWidth + x;
+            GLuint mask = OverlapCircleBoxes(middle, reach, this->CellBounds, cell, diffX, diffY);
+            if (x1 - x + 1 < BOX_BATCH)
+                mask &= (1u << (x1 - x + 1)) - 1;
+            // ոӺѴݻשĸǿպУmask
+            for (GLuint i = 0; mask; ++i, mask >>= 1)
+            {
+                if (!(mask & 1))
+                    continue;
+                GLint index = this->Cells[cell + i];
+                if (alive && !((alive[index >> 6] >> (index & 63)) & 1))
+                    continue;
+                const GameObject& box = this->Bricks[index];
+                if (SweepCircleAABB(center, radius, motion, V(box.Position), V(box.Position) + V(box.Size), test)
+                    && test.Time < hit.Time)
+                {
+                    hit = test;
+                    result = index;
+                }
+            }
+        }
     }
-    return GL_TRUE;
-}
\ No newline at end of file
+    return result;
+}
+
+template GLint GameLevel::SweepBricks(glm::vec2, GLfloat, glm::vec2, BasicSweepHit<glm::vec2>&, const std::uint64_t*) const;
+template GLint GameLevel::SweepBricks(FixedVec2, Fixed, FixedVec2, BasicSweepHit<FixedVec2>&, const std::uint64_t*) const;
\ No newline at end of file
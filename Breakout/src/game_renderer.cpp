@@ -0,0 +1,249 @@
+#include "game_renderer.h"
+
+#include <sstream>
+
+#include "resource_manager.h"
+
+
+// Random stream used for particles (gameplay uses the default stream)
+const std::uint64_t PARTICLE_STREAM = 0x7061727469636c65ULL;
+// 球池中带粒子尾迹的球数，球再多时粒子会不够用
+const GLuint TRAIL_BALLS = 8;
+
+GameRenderer::GameRenderer(GLuint width, GLuint height, JobSystem* jobs, GLboolean gpuParticles, GLuint maxTicks)
+    : width(width), height(height), jobs(jobs), renderer(nullptr), bricks(nullptr), brickLevel(-1), particles(nullptr), 
+    gpuParticles(nullptr), useGpuParticles(gpuParticles), 
+    effects(nullptr), text(nullptr), soundEngine(nullptr), shakeTime(0.0f), particleRng(0, PARTICLE_STREAM), particleSeed(0), lastTick(0),
+    maxTicks(maxTicks) { }
+
+GameRenderer::~GameRenderer()
+{
+    delete this->renderer;
+    delete this->bricks;
+    delete this->particles;
+    delete this->gpuParticles;
+    delete this->effects;
+    delete this->text;
+    if (this->soundEngine)
+        this->soundEngine->drop();
+}
+
+void GameRenderer::Init()
+{
+    // 加载着色器
+    ResourceManager::LoadShader("src/sprite.vs", "src/sprite.fs", nullptr, "sprite");
+    ResourceManager::LoadShader("src/sprite_batch.vs", "src/sprite_batch.fs", nullptr, "sprite_batch");
+    ResourceManager::LoadShader("src/brick.vs", "src/brick.fs", nullptr, "brick");
+    ResourceManager::LoadShader("src/particle.vs", "src/particle.fs", nullptr, "particle");
+    if (this->useGpuParticles)
+    {
+        ResourceManager::LoadShader("src/particle_gpu.vs", "src/particle.fs", nullptr, "particle_gpu");
+        ResourceManager::LoadFeedbackShader("src/particle_update.vs", PARTICLE_VARYINGS, 4, "particle_update");
+    }
+    ResourceManager::LoadShader("src/post_processing.vs", "src/post_processing.fs", nullptr, "postprocessing");
+    // 配置着色器
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<GLfloat>(this->width), 
+        static_cast<GLfloat>(this->height), 0.0f, -1.0f, 1.0f);
+    ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader("sprite").Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader("sprite_batch").Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader("sprite_batch").Use().SetInteger("sprites", 1);
+    ResourceManager::GetShader("sprite_batch").Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader("brick").Use().SetInteger("sprites", 1);
+    ResourceManager::GetShader("brick").Use().SetMatrix4("projection", projection);
+    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader("particle").Use().SetMatrix4("projection", projection);
+    if (this->useGpuParticles)
+    {
+        ResourceManager::GetShader("particle_gpu").Use().SetInteger("sprite", 0);
+        ResourceManager::GetShader("particle_gpu").Use().SetMatrix4("projection", projection);
+    }
+    // 设置专用于渲染的控制
+    this->renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"), ResourceManager::GetShader("sprite_batch"));
+    this->bricks = new BrickRenderer(ResourceManager::GetShader("brick"));
+    // 加载纹理：场景中的精灵打包进同一个纹理数组，整个场景只需绑定一次纹理
+    // (道具精灵以 "powerup_" + PowerUp::Type 命名)
+    ResourceManager::LoadTexture("resources/textures/background.jpg", GL_FALSE, "background");
+    ResourceManager::LoadTexture("resources/textures/particle.png", GL_TRUE, "particle");
+    ResourceManager::LoadSprite("resources/textures/awesomeface.png", GL_TRUE, "face");
+    ResourceManager::LoadSprite("resources/textures/block.png", GL_TRUE, "block");
+    ResourceManager::LoadSprite("resources/textures/block_solid.png", GL_TRUE, "block_solid");
+    ResourceManager::LoadSprite("resources/textures/paddle.png", GL_TRUE, "paddle");
+    ResourceManager::LoadSprite("resources/textures/powerup_speed.png", GL_TRUE, "powerup_speed");
+    ResourceManager::LoadSprite("resources/textures/powerup_sticky.png", GL_TRUE, "powerup_sticky");
+    ResourceManager::LoadSprite("resources/textures/powerup_increase.png", GL_TRUE, "powerup_pad-size-increase");
+    ResourceManager::LoadSprite("resources/textures/powerup_passthrough.png", GL_TRUE, "powerup_pass-through");
+    ResourceManager::LoadSprite("resources/textures/powerup_chaos.png", GL_TRUE, "powerup_chaos");
+    ResourceManager::LoadSprite("resources/textures/powerup_confuse.png", GL_TRUE, "powerup_confuse");
+    ResourceManager::LoadSprite("resources/textures/powerup_multiball.png", GL_TRUE, "powerup_multi-ball");
+    ResourceManager::GenerateSprites();
+    for (GLuint kind = 0; kind < POWERUP_KINDS; ++kind)
+        this->powerupSprites[kind] = ResourceManager::GetSprite(std::string("powerup_") + POWERUP_TYPES[kind]);
+    // 加载粒子 (可选在GPU上用变换反馈模拟)
+    if (this->useGpuParticles)
+        this->gpuParticles = new GpuParticleGenerator(
+            ResourceManager::GetShader("particle_update"), 
+            ResourceManager::GetShader("particle_gpu"), 
+            ResourceManager::GetTexture("particle"), 
+            1500
+        );
+    else
+        this->particles = new ParticleGenerator(
+            ResourceManager::GetShader("particle"), 
+            ResourceManager::GetTexture("particle"), 
+            1500
+        );
+    // 加载后处理
+    this->effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->width, this->height);
+    // 加载声音
+    this->soundEngine = irrklang::createIrrKlangDevice();
+    this->PlaySound("resources/audio/breakout.mp3", GL_TRUE);
+    // 加载字
+    this->text = new TextRenderer(this->width, this->height);
+    this->text->Load("resources/fonts/ocraext.TTF", 24);
+}
+
+void GameRenderer::PlaySound(const GLchar* file, GLboolean loop)
+{
+    if (this->soundEngine)
+        this->soundEngine->play2D(file, loop);
+}
+
+void GameRenderer::HandleEvent(const GameEvent& event)
+{
+    switch (event.Type)
+    {
+    case EVENT_BRICK_DESTROYED:
+        this->PlaySound("resources/audio/bleep.mp3");
+        break;
+    case EVENT_SOLID_HIT:
+        // 撞到实心砖块时激活shake特效
+        this->shakeTime = 0.05f;
+        this->PlaySound("resources/audio/solid.wav");
+        break;
+    case EVENT_PADDLE_HIT:
+        this->PlaySound("resources/audio/bleep.wav");
+        break;
+    case EVENT_POWERUP_COLLECTED:
+        this->PlaySound("resources/audio/powerup.wav");
+        break;
+    case EVENT_LEVEL_COMPLETED:
+        this->PlaySound("resources/audio/victory.wav");
+        break;
+    default:
+        break;
+    }
+}
+
+void GameRenderer::Update(const RenderSnapshot& snapshot, GLfloat dt)
+{
+    if (snapshot.Seed != this->particleSeed)
+    {
+        this->particleSeed = snapshot.Seed;
+        this->particleRng.Seed(snapshot.Seed, PARTICLE_STREAM);
+    }
+    // 每个tick更新一次粒子，窗口卡顿很久时与模拟一样最多补maxTicks个tick
+    std::uint64_t ticks = snapshot.Tick - this->lastTick;
+    this->lastTick = snapshot.Tick;
+    if (ticks > this->maxTicks)
+        ticks = this->maxTicks;
+    GameObject ball(snapshot.Ball.Position, snapshot.Ball.Size, snapshot.Ball.Color, snapshot.BallVelocity);
+    for (std::uint64_t i = 0; i < ticks; ++i)
+    {
+        // update shake time
+        if (this->shakeTime > 0.0f)
+            this->shakeTime -= dt;
+        // update particles, the pool's first balls leave trails as well
+        for (GLuint b = 0; b < snapshot.Balls.size() && b < TRAIL_BALLS; ++b)
+        {
+            const SpriteState& sprite = snapshot.Balls[b];
+            GameObject pooled(sprite.Position, sprite.Size, sprite.Color, (sprite.Position - sprite.PrevPosition) / dt);
+            if (this->gpuParticles)
+                this->gpuParticles->Spawn(pooled, 1, this->particleRng, sprite.Size / 4.0f);
+            else
+                this->particles->Spawn(pooled, 1, this->particleRng, sprite.Size / 4.0f);
+        }
+        if (this->gpuParticles)
+            this->gpuParticles->Update(dt, ball, 1, this->particleRng, glm::vec2(snapshot.BallRadius / 2));
+        else
+            this->particles->Update(dt, ball, 1, this->particleRng, glm::vec2(snapshot.BallRadius / 2), this->jobs);
+    }
+}
+
+void GameRenderer::Render(const RenderSnapshot& snapshot, GLfloat time, GLfloat alpha)
+{
+    GLfloat screenWidth = static_cast<GLfloat>(this->width), screenHeight = static_cast<GLfloat>(this->height);
+    if (snapshot.State == GAME_ACTIVE || snapshot.State == GAME_MENU || snapshot.State == GAME_START)
+    {
+        this->effects->Confuse = snapshot.Confuse;
+        this->effects->Chaos = snapshot.Chaos;
+        this->effects->Shake = this->shakeTime > 0.0f;
+        this->effects->BeginRender();
+        this->renderer->Begin();
+            // 绘制背景
+            this->renderer->DrawSprite(ResourceManager::GetTexture("background"), 
+                glm::vec2(0, 0), glm::vec2(screenWidth, screenHeight), 0.0f);
+            // 绘制关卡：换关时上传所有砖块，之后只更新被摧毁或恢复的砖块，一次实例化绘制
+            const TextureArray& sprites = ResourceManager::SpriteArray;
+            if (static_cast<GLint>(snapshot.BricksLevel) != this->brickLevel || snapshot.Bricks.size() != this->bricks->Count)
+            {
+                this->bricks->Load(snapshot.Bricks, ResourceManager::GetSprite("block"), ResourceManager::GetSprite("block_solid"));
+                this->brickLevel = snapshot.BricksLevel;
+            }
+            if (!snapshot.BricksAlive.empty())
+                this->bricks->SetAlive(snapshot.BricksAlive.data());
+            this->renderer->Flush();
+            this->bricks->Draw(sprites);
+            // 绘制挡板
+            this->renderer->DrawSprite(sprites, ResourceManager::GetSprite("paddle"), 
+                glm::mix(snapshot.Player.PrevPosition, snapshot.Player.Position, alpha), snapshot.Player.Size, snapshot.Player.Rotation, snapshot.Player.Color);
+            // 绘制道具
+            for (const SpriteState& powerup : snapshot.PowerUps)
+                this->renderer->DrawSprite(sprites, this->powerupSprites[powerup.Kind], 
+                    glm::mix(powerup.PrevPosition, powerup.Position, alpha), powerup.Size, powerup.Rotation, powerup.Color);
+            // 绘制粒子 (粒子使用自己的着色器，先画完已排队的精灵)
+            this->renderer->Flush();
+            if (this->gpuParticles)
+                this->gpuParticles->Draw();
+            else
+                this->particles->Draw();
+            // 绘制球
+            const SpriteRegion& face = ResourceManager::GetSprite("face");
+            this->renderer->DrawSprite(sprites, face, 
+                glm::mix(snapshot.Ball.PrevPosition, snapshot.Ball.Position, alpha), snapshot.Ball.Size, snapshot.Ball.Rotation, snapshot.Ball.Color);
+            for (const SpriteState& ball : snapshot.Balls)
+                this->renderer->DrawSprite(sprites, face, 
+                    glm::mix(ball.PrevPosition, ball.Position, alpha), ball.Size, ball.Rotation, ball.Color);
+        this->renderer->End();
+        this->effects->EndRender();
+        this->effects->Render(time);
+        // 绘制文字
+        std::stringstream ss; ss << snapshot.Lives;
+        this->text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
+    }
+    if (snapshot.State == GAME_MENU)
+    {
+        std::stringstream levelss; levelss << snapshot.Level + 1;
+        this->text->RenderText("Press ENTER to start", 250.0f, screenHeight / 2, 1.0f);
+        this->text->RenderText("Press W or S to select level", 245.0f, screenHeight / 2 + 20.0f, 0.75f);
+        this->text->RenderText("Level:" + levelss.str(), 5.0f, screenHeight - 20.0, 1.0f);
+    }
+    if (snapshot.State == GAME_WIN)
+    {
+        this->text->RenderText(
+            "You WON!!!", 320.0, screenHeight / 2 - 20.0, 1.0, glm::vec3(1.0, 1.0, 0.0)
+        );
+        this->text->RenderText(
+            "Press ENTER to retry or ESC to quit", 130.0, screenHeight / 2, 1.0, glm::vec3(1.0, 1.0, 0.0)
+        );
+    }
+    if (snapshot.State == GAME_START)
+    {
+        this->text->RenderText(
+            "BREAKOUT", 210.0, screenHeight * 2 / 5, 3.0, glm::vec3(1.0, 1.0, 0.0)
+        );
+        this->text->RenderText(
+            "Press ENTER to start or ESC to quit", 130.0, screenHeight * 2 / 3, 1.0, glm::vec3(1.0, 1.0, 0.0)
+        );
+    }
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "gpu_particle_generator.h"
+
+const GLchar* const PARTICLE_VARYINGS[4] = { "Position", "Velocity", "Color", "Life" };
+// Floats of a particle's state: position, velocity, color, life
+const GLuint PARTICLE_FLOATS = 2 + 2 + 4 + 1;
+
+GpuParticleGenerator::GpuParticleGenerator(Shader updateShader, Shader shader, Texture2D texture, GLuint amount)
+	:queued(0), amount(amount), nextParticle(0), current(0), updateShader(updateShader), shader(shader), texture(texture)
+{
+	this->init();
+}
+
+GpuParticleGenerator::~GpuParticleGenerator()
+{
+	glDeleteVertexArrays(2, this->updateVAO);
+	glDeleteVertexArrays(2, this->drawVAO);
+	glDeleteBuffers(2, this->buffers);
+	glDeleteBuffers(1, &this->quadVBO);
+}
+
+void GpuParticleGenerator::Update(GLfloat dt, const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset)
+{
+	this->Spawn(object, newParticles, rng, offset);
+	this->simulate(dt, rng);
+}
+
+void GpuParticleGenerator::Spawn(const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset)
+{
+	if (newParticles == 0)
+		return;
+	// A full queue is respawned by a pass that does not advance time
+	if (this->emitters.size() == GPU_PARTICLE_EMITTERS)
+		this->simulate(0.0f, rng);
+	if (newParticles > this->amount - this->queued)
+		newParticles = this->amount - this->queued;
+	this->queued += newParticles;
+	this->emitters.push_back(glm::vec4(object.Position + offset, object.Velocity * 0.1f));
+	this->emitterEnds.push_back(static_cast<GLint>(this->queued));
+}
+
+void GpuParticleGenerator::simulate(GLfloat dt, Random& rng)
+{
+	this->updateShader.Use();
+	glUniform1f(this->dtLocation, dt);
+	glUniform1i(this->seedLocation, static_cast<GLint>(rng.Next()));
+	glUniform1i(this->beginLocation, static_cast<GLint>(this->nextParticle));
+	glUniform1i(this->countLocation, static_cast<GLint>(this->emitters.size()));
+	if (!this->emitters.empty())
+	{
+		glUniform4fv(this->emitterLocation, static_cast<GLsizei>(this->emitters.size()), &this->emitters[0].x);
+		glUniform1iv(this->endLocation, static_cast<GLsizei>(this->emitterEnds.size()), this->emitterEnds.data());
+	}
+	// Read the current state, capture the next one into the other buffer
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(this->updateVAO[this->current]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->buffers[1 - this->current]);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, this->amount);
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindVertexArray(0);
+	glDisable(GL_RASTERIZER_DISCARD);
+	this->current = 1 - this->current;
+
+	this->nextParticle = (this->nextParticle + this->queued) % this->amount;
+	this->queued = 0;
+	this->emitters.clear();
+	this->emitterEnds.clear();
+}
+
+// Render all live particles
+void GpuParticleGenerator::Draw()
+{
+	// Use additive blending to give it a 'glow' effect
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	this->shader.Use();
+	glActiveTexture(GL_TEXTURE0);
+	this->texture.Bind();
+	glBindVertexArray(this->drawVAO[this->current]);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->amount);
+	glBindVertexArray(0);
+	// Don't forget to reset to default blending mode
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void GpuParticleGenerator::init()
+{
+	GLfloat particle_quad[] = {
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 0.0f,
+
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f
+	};
+	glGenBuffers(1, &this->quadVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
+	// Both state buffers start out zeroed: every particle dead
+	std::vector<GLfloat> state(this->amount * PARTICLE_FLOATS, 0.0f);
+	GLsizei stride = PARTICLE_FLOATS * sizeof(GLfloat);
+	glGenBuffers(2, this->buffers);
+	glGenVertexArrays(2, this->updateVAO);
+	glGenVertexArrays(2, this->drawVAO);
+	for (GLuint i = 0; i < 2; ++i)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffers[i]);
+		glBufferData(GL_ARRAY_BUFFER, state.size() * sizeof(GLfloat), state.data(), GL_DYNAMIC_COPY);
+		// Update: one vertex per particle
+		glBindVertexArray(this->updateVAO[i]);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(2 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(4 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(8 * sizeof(GLfloat)));
+		// Draw: the quad, and one instance per particle
+		glBindVertexArray(this->drawVAO[i]);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)0);
+		glVertexAttribDivisor(1, 1);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(4 * sizeof(GLfloat)));
+		glVertexAttribDivisor(2, 1);
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(8 * sizeof(GLfloat)));
+		glVertexAttribDivisor(3, 1);
+		glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	// Uniforms set on every pass
+	this->dtLocation = glGetUniformLocation(this->updateShader.ID, "dt");
+	this->seedLocation = glGetUniformLocation(this->updateShader.ID, "seed");
+	this->beginLocation = glGetUniformLocation(this->updateShader.ID, "spawnBegin");
+	this->countLocation = glGetUniformLocation(this->updateShader.ID, "emitters");
+	this->emitterLocation = glGetUniformLocation(this->updateShader.ID, "emitter");
+	this->endLocation = glGetUniformLocation(this->updateShader.ID, "emitterEnd");
+	this->updateShader.Use().SetInteger("amount", static_cast<GLint>(this->amount));
+}
\ No newline at end of file
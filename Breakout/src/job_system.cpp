@@ -0,0 +1,221 @@
+#include "job_system.h"
+
+#include <string>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // The system and deque the calling thread works for, if it is a worker
+    thread_local const JobSystem* CurrentSystem = nullptr;
+    thread_local GLuint CurrentDeque = 0;
+    // Failed take() attempts before an idle worker goes to sleep
+    const GLuint SPIN_COUNT = 64;
+
+#if defined(_WIN32)
+    // SetThreadDescription only exists on Windows 10 1607 and later
+    void SetDescription(HANDLE thread, const GLchar* name)
+    {
+        typedef HRESULT(WINAPI* SetThreadDescriptionFn)(HANDLE, PCWSTR);
+        static SetThreadDescriptionFn setDescription = reinterpret_cast<SetThreadDescriptionFn>(
+            GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+        if (!setDescription)
+            return;
+        std::wstring wide(name, name + std::char_traits<GLchar>::length(name));
+        setDescription(thread, wide.c_str());
+    }
+#else
+    // Linux limits thread names to 15 characters
+    void SetName(pthread_t thread, const GLchar* name)
+    {
+        std::string shortName(name);
+        shortName.resize(std::min<std::size_t>(shortName.size(), 15));
+        pthread_setname_np(thread, shortName.c_str());
+    }
+#endif
+}
+
+JobSystem::JobSystem(GLuint workers, GLboolean pin)
+    : running(true), queued(0), sleeping(0)
+{
+    if (workers == 0)
+    {
+        GLuint cores = std::thread::hardware_concurrency();
+        workers = cores > 1 ? cores - 1 : 0;
+    }
+    // deque 0 is shared by every thread that is not a worker
+    for (GLuint i = 0; i <= workers; ++i)
+        this->deques.emplace_back(new Deque());
+    for (GLuint i = 1; i <= workers; ++i)
+    {
+        this->workers.emplace_back(&JobSystem::work, this, i);
+        NameThread(this->workers.back(), ("job worker " + std::to_string(i)).c_str());
+        if (pin)
+            PinThread(this->workers.back(), i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->wakeLock);
+        this->running.store(false);
+    }
+    this->wake.notify_all();
+    for (std::thread& worker : this->workers)
+        worker.join();
+}
+
+GLuint JobSystem::Concurrency() const
+{
+    return static_cast<GLuint>(this->workers.size()) + 1;
+}
+
+void JobSystem::Run(JobCounter& counter, void (*function)(void*, GLuint, GLuint), void* data, GLuint begin, GLuint end)
+{
+    Job job = { function, data, begin, end, &counter };
+    counter.Pending.fetch_add(1, std::memory_order_relaxed);
+    if (!this->deques[this->self()]->Push(job))
+    {
+        execute(job);
+        return;
+    }
+    // a worker that went to sleep after checking queued is woken here
+    this->queued.fetch_add(1);
+    if (this->sleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(this->wakeLock);
+        this->wake.notify_one();
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    GLuint index = this->self();
+    while (counter.Pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+        if (this->take(index, job))
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::NameThread(std::thread& thread, const GLchar* name)
+{
+#if defined(_WIN32)
+    SetDescription(static_cast<HANDLE>(thread.native_handle()), name);
+#else
+    SetName(thread.native_handle(), name);
+#endif
+}
+
+void JobSystem::NameCurrentThread(const GLchar* name)
+{
+#if defined(_WIN32)
+    SetDescription(GetCurrentThread(), name);
+#else
+    SetName(pthread_self(), name);
+#endif
+}
+
+void JobSystem::PinThread(std::thread& thread, GLuint core)
+{
+    GLuint cores = std::max(std::thread::hardware_concurrency(), 1u);
+    core %= cores;
+#if defined(_WIN32)
+    if (core < sizeof(DWORD_PTR) * 8)
+        SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << core);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
+
+void JobSystem::work(GLuint index)
+{
+    CurrentSystem = this;
+    CurrentDeque = index;
+    GLuint idle = 0;
+    while (this->running.load())
+    {
+        Job job;
+        if (this->take(index, job))
+        {
+            execute(job);
+            idle = 0;
+        }
+        else if (++idle < SPIN_COUNT)
+            std::this_thread::yield();
+        else
+        {
+            std::unique_lock<std::mutex> lock(this->wakeLock);
+            this->sleeping.fetch_add(1);
+            this->wake.wait(lock, [this] { return this->queued.load() > 0 || !this->running.load(); });
+            this->sleeping.fetch_sub(1);
+            idle = 0;
+        }
+    }
+}
+
+GLuint JobSystem::self() const
+{
+    return CurrentSystem == this ? CurrentDeque : 0;
+}
+
+GLboolean JobSystem::take(GLuint index, Job& job)
+{
+    // nothing queued anywhere, don't bother taking every deque's lock
+    if (this->queued.load(std::memory_order_relaxed) <= 0)
+        return GL_FALSE;
+    GLuint count = static_cast<GLuint>(this->deques.size());
+    GLboolean found = this->deques[index]->Pop(job);
+    for (GLuint i = 1; !found && i < count; ++i)
+        found = this->deques[(index + i) % count]->Steal(job);
+    if (found)
+        this->queued.fetch_sub(1);
+    return found;
+}
+
+void JobSystem::execute(const Job& job)
+{
+    job.Function(job.Data, job.Begin, job.End);
+    job.Counter->Pending.fetch_sub(1, std::memory_order_release);
+}
+
+GLboolean JobSystem::Deque::Push(const Job& job)
+{
+    std::lock_guard<std::mutex> lock(this->Lock);
+    if (this->Bottom - this->Top == CAPACITY)
+        return GL_FALSE;
+    this->Jobs[this->Bottom++ % CAPACITY] = job;
+    return GL_TRUE;
+}
+
+GLboolean JobSystem::Deque::Pop(Job& job)
+{
+    std::lock_guard<std::mutex> lock(this->Lock);
+    if (this->Bottom == this->Top)
+        return GL_FALSE;
+    job = this->Jobs[--this->Bottom % CAPACITY];
+    return GL_TRUE;
+}
+
+GLboolean JobSystem::Deque::Steal(Job& job)
+{
+    std::lock_guard<std::mutex> lock(this->Lock);
+    if (this->Bottom == this->Top)
+        return GL_FALSE;
+    job = this->Jobs[this->Top++ % CAPACITY];
+    return GL_TRUE;
+}
\ No newline at end of file
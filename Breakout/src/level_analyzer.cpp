@@ -0,0 +1,162 @@
+#include "level_analyzer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "autoplayer.h"
+#include "game.h"
+#include "job_system.h"
+#include "powerup.h"
+
+// Everything one game contributes to the report
+struct LevelRun
+{
+    unsigned int Ticks;      // ticks until the level was cleared or time ran out
+    GLboolean    Cleared;
+    GLuint       LivesLost, GameOvers;
+    GLuint       Shots;      // launches from the paddle, including the first of every life
+    GLuint       BricksDestroyed, SolidHits;
+    GLuint       Spawned[POWERUP_KINDS];
+};
+
+// function declaration
+LevelRun PlayLevel(const Game& prototype, std::uint64_t seed, GLfloat dt, unsigned int maxTicks);
+double Percentile(const std::vector<unsigned int>& sorted, double p);
+
+int RunAnalyzer(const GLchar* file, GLuint width, GLuint height, unsigned int games, unsigned int maxTicks,
+    GLfloat dt, std::uint64_t seed, GLuint threads)
+{
+    // The world every game starts from: the analyzed level is its only one
+    Game prototype(width, height);
+    prototype.Init();
+    GameLevel level;
+    level.Load(file, width, height * 0.5f);
+    if (level.Bricks.empty())
+    {
+        std::cout << "ERROR::ANALYZER: Failed to load level " << file << std::endl;
+        return 1;
+    }
+    if (level.Remaining == 0)
+    {
+        std::cout << "ERROR::ANALYZER: Level " << file << " has no breakable bricks" << std::endl;
+        return 1;
+    }
+    prototype.Levels.assign(1, level);
+    prototype.Level = 0;
+
+    // Each game writes only its own slot; small chunks keep every core busy
+    // even though games on hard levels take much longer than on easy ones
+    JobSystem jobs(threads == 0 ? 0 : threads - 1);
+    std::vector<LevelRun> runs(games);
+    GLuint grain = std::max(1u, games / (jobs.Concurrency() * 16));
+    auto start = std::chrono::steady_clock::now();
+    jobs.ParallelFor(games, grain, [&](GLuint begin, GLuint end) {
+        for (GLuint g = begin; g < end; ++g)
+            runs[g] = PlayLevel(prototype, seed + g, dt, maxTicks);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Reduce in game order
+    std::vector<unsigned int> clearTicks;
+    clearTicks.reserve(games);
+    unsigned long long totalTicks = 0, livesLost = 0, gameOvers = 0, shots = 0, destroyed = 0, solidHits = 0;
+    unsigned long long spawned[POWERUP_KINDS] = { };
+    for (const LevelRun& run : runs)
+    {
+        totalTicks += run.Ticks;
+        if (run.Cleared)
+            clearTicks.push_back(run.Ticks);
+        livesLost += run.LivesLost;
+        gameOvers += run.GameOvers;
+        shots += run.Shots;
+        destroyed += run.BricksDestroyed;
+        solidHits += run.SolidHits;
+        for (GLuint kind = 0; kind < POWERUP_KINDS; ++kind)
+            spawned[kind] += run.Spawned[kind];
+    }
+    std::sort(clearTicks.begin(), clearTicks.end());
+    double perGame = games ? 1.0 / games : 0.0;
+
+    std::cout << "level:        " << file << " (" << level.Bricks.size() << " bricks, " << level.Remaining << " breakable)" << std::endl;
+    std::cout << "games:        " << games << " (" << clearTicks.size() << " cleared, "
+        << games - clearTicks.size() << " timed out after " << maxTicks * dt << " s)" << std::endl;
+    if (!clearTicks.empty())
+    {
+        double sum = 0.0;
+        for (unsigned int ticks : clearTicks)
+            sum += ticks;
+        std::cout << "clear time:   mean " << sum / clearTicks.size() * dt << " s, median " << Percentile(clearTicks, 0.5) * dt
+            << " s, p90 " << Percentile(clearTicks, 0.9) * dt << " s, min " << clearTicks.front() * dt
+            << " s, max " << clearTicks.back() * dt << " s" << std::endl;
+    }
+    std::cout << "lives lost:   " << livesLost * perGame << " per game (" << gameOvers << " game overs)" << std::endl;
+    std::cout << "powerups:     ";
+    for (GLuint kind = 0; kind < POWERUP_KINDS; ++kind)
+        std::cout << (kind ? ", " : "") << POWERUP_TYPES[kind] << " " << spawned[kind] * perGame;
+    std::cout << " spawned per game" << std::endl;
+    if (shots)
+        std::cout << "per shot:     " << static_cast<double>(destroyed) / shots << " bricks destroyed, "
+            << static_cast<double>(solidHits) / shots << " solid hits (" << shots * perGame << " shots per game)" << std::endl;
+    std::cout << "elapsed:      " << elapsed.count() << " s (" << totalTicks / elapsed.count() << " ticks/second)" << std::endl;
+    std::cout << "games/minute: " << games / elapsed.count() * 60.0 << std::endl;
+    std::cout << "threads:      " << jobs.Concurrency() << std::endl;
+    return 0;
+}
+
+// Plays a copy of prototype from the title screen until its only level is
+// cleared or maxTicks pass. A game over returns to the menu, where the
+// AutoPlayer simply starts the level again.
+LevelRun PlayLevel(const Game& prototype, std::uint64_t seed, GLfloat dt, unsigned int maxTicks)
+{
+    Game game = prototype;
+    game.SetSeed(seed);
+    AutoPlayer player(0);
+    LevelRun run = { };
+    GLboolean started = GL_FALSE;
+    while (run.Ticks < maxTicks && !run.Cleared)
+    {
+        player.Update(game, dt);
+        game.Tick(dt);
+        ++run.Ticks;
+        // the first launch of a game; later lives count theirs on EVENT_LIFE_LOST
+        if (!started && game.State == GAME_ACTIVE)
+        {
+            started = GL_TRUE;
+            ++run.Shots;
+        }
+        for (const GameEvent& event : game.Events)
+        {
+            switch (event.Type)
+            {
+            case EVENT_BRICK_DESTROYED: ++run.BricksDestroyed; break;
+            case EVENT_SOLID_HIT: ++run.SolidHits; break;
+            case EVENT_PADDLE_HIT: ++run.Shots; break;
+            case EVENT_POWERUP_SPAWNED: ++run.Spawned[event.Index]; break;
+            case EVENT_LIFE_LOST:
+                ++run.LivesLost;
+                if (event.Index == 0)
+                    ++run.GameOvers;
+                else
+                    ++run.Shots;
+                break;
+            case EVENT_LEVEL_COMPLETED: run.Cleared = GL_TRUE; break;
+            default: break;
+            }
+        }
+        // a game over restarts from the menu with a fresh first launch
+        if (game.State == GAME_MENU)
+            started = GL_FALSE;
+    }
+    return run;
+}
+
+// Linearly interpolated percentile p in [0, 1] of a sorted list
+double Percentile(const std::vector<unsigned int>& sorted, double p)
+{
+    double position = p * (sorted.size() - 1);
+    size_t below = static_cast<size_t>(position);
+    size_t above = std::min(below + 1, sorted.size() - 1);
+    return sorted[below] + (sorted[above] - sorted[below]) * (position - below);
+}
\ No newline at end of file
@@ -1,21 +1,85 @@
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
 
 #include "game.h"
+#include "game_renderer.h"
+#include "job_system.h"
+#include "replay.h"
+#include "resource_manager.h"
+#include "save_state.h"
+#include "sim_thread.h"
 
 // GLFW function declerations
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void SendPendingKeys();
 
 // The Width of the screen
 const GLuint SCREEN_WIDTH = 800;
 // The height of the screen
 const GLuint SCREEN_HEIGHT = 600;
+// Simulation ticks per second, independent of the display refresh rate
+const GLdouble TICK_RATE = 120.0;
+// Most ticks run in one frame to catch up after a stall
+const GLuint MAX_CATCHUP_TICKS = 8;
+// How far back the game can be rewound
+const GLuint REWIND_SECONDS = 10;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
+// Records the session when started with --record <file>
+ReplayRecorder* Recorder = nullptr;
+// Runs the game logic on its own thread; keys are sent to it
+SimThread* Simulation = nullptr;
+// The last seconds of play, for rewinding (not while recording)
+RewindBuffer* Rewind = nullptr;
+// Worker threads shared by the simulation and the renderer
+JobSystem* Jobs = nullptr;
+// Key changes the full input queue did not take yet, sent again in order
+// every frame so a release is never lost
+std::vector<KeyInput> PendingKeys;
 
 int main(int argc, char *argv[])
 {
+    const GLchar* recordFile = nullptr;
+    GLboolean stress = GL_FALSE, gpuParticles = GL_FALSE;
+    // --record <file> saves the session as a replay; --stress plays with
+    // STRESS_BALLS balls in the air and cannot be recorded;
+    // --gpu-particles simulates the particles on the GPU
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--record") == 0)
+        {
+            if (i + 1 == argc)
+            {
+                std::cout << "ERROR::MAIN: --record needs a file" << std::endl;
+                std::cout << "Usage: Breakout [--record file] [--stress] [--gpu-particles]" << std::endl;
+                return 1;
+            }
+            recordFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--stress") == 0)
+            stress = GL_TRUE;
+        else if (std::strcmp(argv[i], "--gpu-particles") == 0)
+            gpuParticles = GL_TRUE;
+        else
+        {
+            std::cout << "ERROR::MAIN: Unknown argument " << argv[i] << std::endl;
+            std::cout << "Usage: Breakout [--record file] [--stress] [--gpu-particles]" << std::endl;
+            return 1;
+        }
+    }
+    // Replays do not store the stress settings, so they could not be played back
+    if (recordFile && stress)
+    {
+        std::cout << "ERROR::MAIN: --stress games cannot be recorded" << std::endl;
+        return 1;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -37,39 +101,66 @@ int main(int argc, char *argv[])
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // One worker per spare core for the data-parallel frame tasks
+    JobSystem::NameCurrentThread("main");
+    Jobs = new JobSystem();
+
     // Initialize game
     Breakout.Init();
-
-    // DeltaTime variables
-    GLfloat deltaTime = 0.0f;
-    GLfloat lastFrame = 0.0f;
+    Breakout.Jobs = Jobs;
+    Breakout.SetSeed(static_cast<std::uint64_t>(std::time(nullptr)));
+    if (recordFile)
+        Recorder = new ReplayRecorder(Breakout.RandomSeed, static_cast<GLfloat>(1.0 / TICK_RATE));
+    if (stress)
+    {
+        Breakout.Balls.Radius = STRESS_BALL_RADIUS;
+        Breakout.StressBalls = STRESS_BALLS;
+    }
+    GameRenderer* View = new GameRenderer(SCREEN_WIDTH, SCREEN_HEIGHT, Jobs, gpuParticles, MAX_CATCHUP_TICKS);
+    View->Init();
 
     // Start Game within Menu State
     Breakout.State = GAME_START;
+    // From here on only the simulation thread touches Breakout
+    // (frames of ten thousand balls are too large to keep seconds of)
+    if (!Recorder && !Breakout.StressBalls)
+        Rewind = new RewindBuffer(static_cast<GLuint>(REWIND_SECONDS * TICK_RATE));
+    Simulation = new SimThread(Breakout, TICK_RATE, MAX_CATCHUP_TICKS, Recorder, Rewind);
+    Simulation->Start();
 
     while (!glfwWindowShouldClose(window))
     {
-        // Calculate delta time
-        GLfloat currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
         glfwPollEvents();
+        SendPendingKeys();
 
-        //deltaTime = 0.001f;
-        // Manage user input
-        Breakout.ProcessInput(deltaTime);
-
-        // Update Game state
-        Breakout.Update(deltaTime);
+        // Sounds and effects of the ticks simulated since the last frame
+        GameEvent event;
+        while (Simulation->PollEvent(event))
+            View->HandleEvent(event);
+        const RenderSnapshot& snapshot = Simulation->Snapshot();
+        View->Update(snapshot, Simulation->Dt());
 
-        // Render
+        // Render the newest complete tick
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        View->Render(snapshot, static_cast<GLfloat>(glfwGetTime()), Simulation->Alpha(snapshot));
 
         glfwSwapBuffers(window);
     }
 
+    Simulation->Stop();
+    delete Simulation;
+    Simulation = nullptr;
+    delete Rewind;
+    if (Recorder)
+    {
+        Recorder->Save(recordFile);
+        delete Recorder;
+    }
+
+    // Delete the renderer while the context is still alive
+    delete View;
+    delete Jobs;
     // Delete all resources as loaded using the resource manager
     ResourceManager::Clear();
 
@@ -84,12 +175,23 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         glfwSetWindowShouldClose(window, GL_TRUE);
     if (key >= 0 && key < 1024)
     {
-        if (action == GLFW_PRESS)
-            Breakout.Keys[key] = GL_TRUE;
-        else if (action == GLFW_RELEASE)
+        if (action == GLFW_PRESS || action == GLFW_RELEASE)
         {
-            Breakout.Keys[key] = GL_FALSE;
-            Breakout.KeyProcessed[key] = GL_FALSE;
+            if (Simulation)
+            {
+                KeyInput input = { static_cast<GLuint>(key), action == GLFW_PRESS };
+                PendingKeys.push_back(input);
+                SendPendingKeys();
+            }
         }
     }
-}
\ No newline at end of file
+}
+
+// Sends the waiting key changes until the input queue is full again
+void SendPendingKeys()
+{
+    size_t sent = 0;
+    while (sent < PendingKeys.size() && Simulation->SendKey(PendingKeys[sent].Key, PendingKeys[sent].Pressed))
+        ++sent;
+    PendingKeys.erase(PendingKeys.begin(), PendingKeys.begin() + sent);
+}
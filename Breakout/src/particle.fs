@@ -9,5 +9,5 @@ uniform sampler2D sprite;
 
 void main()
 {
-    color = (texture2D(sprite, TexCoords) * ParticleColor);
+    color = (texture(sprite, TexCoords) * ParticleColor);
 }
\ No newline at end of file
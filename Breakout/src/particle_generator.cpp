@@ -1,50 +1,75 @@
 #include "particle_generator.h"
 
+// Particles updated by each job
+const GLuint PARTICLE_GRAIN = 256;
+
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, GLuint amount)
-	:shader(shader), texture(texture), amount(amount)
+	:shader(shader), texture(texture), amount(amount), lastUsedParticle(0)
 {
 	this->init();
 }
 
-void ParticleGenerator::Update(GLfloat dt, GameObject& object, GLuint newParticles, glm::vec2 offset)
+void ParticleGenerator::Update(GLfloat dt, const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset, JobSystem* jobs)
+{
+	// Add new particles (serially, they share rng)
+	this->Spawn(object, newParticles, rng, offset);
+	// Update all particles, each one independently
+	Particle* particles = this->particles.data();
+	auto update = [particles, dt](GLuint begin, GLuint end) {
+		for (GLuint i = begin; i < end; ++i)
+		{
+			Particle& p = particles[i];
+			p.Life -= dt; // reduce life
+			if (p.Life > 0.0f)
+			{		// particle is alive, thus update
+				p.Position -= p.Velocity * dt;
+				p.Color.a -= dt * 2.5f;
+			}
+		}
+	};
+	if (jobs)
+		jobs->ParallelFor(this->amount, PARTICLE_GRAIN, update);
+	else
+		update(0, this->amount);
+}
+
+void ParticleGenerator::Spawn(const GameObject& object, GLuint newParticles, Random& rng, glm::vec2 offset)
 {
-	// Add new particles 
 	for (GLuint i = 0; i < newParticles; ++i)
 	{
 		GLuint unusedParticle = this->firstUnusedParticle();
-		this->respawnParticle(this->particles[unusedParticle], object, offset);
-	}
-	// Update all particles
-	for (GLuint i = 0; i < this->amount; ++i)
-	{
-		Particle& p = this->particles[i];
-		p.Life -= dt; // reduce life
-		if (p.Life > 0.0f)
-		{		// particle is alive, thus update
-			p.Position -= p.Velocity * dt;
-			p.Color.a -= dt * 2.5f;
-		}
+		this->respawnParticle(this->particles[unusedParticle], object, rng, offset);
 	}
 }
 
-// Render all particles
+// Render all live particles
 void ParticleGenerator::Draw()
 {
+	// Gather the live particles without branching: every particle is
+	// written, but only a live one advances the count
+	ParticleInstance* instances = this->instances.data();
+	GLuint live = 0;
+	for (const Particle& particle : this->particles)
+	{
+		instances[live].Offset = particle.Position;
+		instances[live].Color = particle.Color;
+		live += particle.Life > 0.0f;
+	}
+	if (live == 0)
+		return;
 	// Use additive blending to give it a 'glow' effect
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 	this->shader.Use();
-	for (Particle& particle : this->particles)
-	{
-		if (particle.Life > 0.0f)
-		{
-			this->shader.SetVector2f("offset", particle.Position);
-			this->shader.SetVector4f("color", particle.Color);
-			this->texture.Bind();
-			glBindVertexArray(this->VAO);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			glBindVertexArray(0);
-		}
-	}
+	glActiveTexture(GL_TEXTURE0);
+	this->texture.Bind();
+	// Orphan the buffer so the upload never waits for the previous frame's draw
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, live * sizeof(ParticleInstance), instances);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(this->VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, live);
+	glBindVertexArray(0);
 	// Don't forget to reset to default blending mode
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
@@ -70,43 +95,53 @@ void ParticleGenerator::init()
 	// Set mesh attributes
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+	// Set instance attributes, one ParticleInstance per instance
+	glGenBuffers(1, &this->instanceVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (GLvoid*)0);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (GLvoid*)(2 * sizeof(GLfloat)));
+	glVertexAttribDivisor(2, 1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 	// Create this->amount default particle instances
 	for (GLuint i = 0; i < this->amount; ++i)
 		this->particles.push_back(Particle());
+	this->instances.resize(this->amount);
 }
 
-// Stores the index of the last particle used (for quick access to next dead particle)
-GLuint lastUsedParticle = 0;
 GLuint ParticleGenerator::firstUnusedParticle()
 {
 	// First search from last used particle, this will usually return almost instantly
-	for (GLuint i = lastUsedParticle; i < this->amount; ++i)
+	for (GLuint i = this->lastUsedParticle; i < this->amount; ++i)
 	{
 		if (this->particles[i].Life <= 0.0f)
 		{
-			lastUsedParticle = i;
+			this->lastUsedParticle = i;
 			return i;
 		}
 	}
 	// Otherwise, do a linear search
-	for (GLuint i = 0; i < lastUsedParticle; ++i)
+	for (GLuint i = 0; i < this->lastUsedParticle; ++i)
 	{
 		if (this->particles[i].Life <= 0.0f)
 		{
-			lastUsedParticle = i;
+			this->lastUsedParticle = i;
 			return i;
 		}
 	}
 	// All particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-	lastUsedParticle = 0;
+	this->lastUsedParticle = 0;
 	return 0;
 }
 
-void ParticleGenerator::respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset)
+void ParticleGenerator::respawnParticle(Particle& particle, const GameObject& object, Random& rng, glm::vec2 offset)
 {
-	GLfloat random = ((rand() % 100) - 50) / 10.0f; // -5  5
-	GLfloat rColor = 0.5f + ((rand() % 100) / 100.0f);
+	GLfloat random = (static_cast<GLint>(rng.Below(100)) - 50) / 10.0f; // -5  5
+	GLfloat rColor = 0.5f + (rng.Below(100) / 100.0f);
 	particle.Position = object.Position + random + offset;
 	particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
 	particle.Life = 1.0f;
@@ -0,0 +1,64 @@
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 velocity;
+layout (location = 2) in vec4 color;
+layout (location = 3) in float life;
+
+// Captured by transform feedback as the particle's next state
+out vec2 Position;
+out vec2 Velocity;
+out vec4 Color;
+out float Life;
+
+const int MAX_EMITTERS = 16;
+
+uniform float dt;
+uniform int amount;
+uniform int seed;
+// Slot of the first respawned particle; emitter i respawns the slots
+// up to emitterEnd[i] after it (counted from spawnBegin, in a ring)
+uniform int spawnBegin;
+uniform int emitters;
+uniform vec4 emitter[MAX_EMITTERS]; // <vec2 position, vec2 velocity>
+uniform int emitterEnd[MAX_EMITTERS];
+
+uint hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+void main()
+{
+	Position = position;
+	Velocity = velocity;
+	Color = color;
+	Life = life;
+	// Respawn
+	int slot = (gl_VertexID - spawnBegin + amount) % amount;
+	for (int i = 0; i < emitters; ++i)
+	{
+		if (slot < emitterEnd[i])
+		{
+			uint random = hash(uint(gl_VertexID) ^ uint(seed));
+			float jitter = float(int(random % 100u) - 50) / 10.0; // -5 ~ 5
+			float rColor = 0.5 + float((random >> 16) % 100u) / 100.0;
+			Position = emitter[i].xy + jitter;
+			Velocity = emitter[i].zw;
+			Color = vec4(rColor, rColor, rColor, 1.0);
+			Life = 1.0;
+			break;
+		}
+	}
+	// Move and fade
+	Life -= dt;
+	if (Life > 0.0)
+	{
+		Position -= Velocity * dt;
+		Color.a -= dt * 2.5;
+	}
+}
@@ -0,0 +1,225 @@
+#include "physics_world.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+// Slack added to the broadphase bounds, so rounding there never drops
+// a pair the narrow test would accept
+const GLfloat BROADPHASE_MARGIN = 1.0f;
+// Up to this many kinematic and dynamic bodies, testing every pair is
+// cheaper than sorting them (the game itself has a paddle, a ball and a
+// few powerups)
+const GLuint SMALL_WORLD = 8;
+
+
+// function declaration
+GLuint PushBody(std::vector<PhysicsBody>& bodies, Vec2 position, Vec2 size, Scalar radius,
+    GLuint layer, GLuint mask, GLuint owner);
+
+
+void PhysicsWorld::Reset(const GameLevel* statics, GLfloat width, GLfloat height)
+{
+    this->Statics = statics;
+    this->Width = ToScalar(width);
+    this->Height = ToScalar(height);
+    this->Kinematics.clear();
+    this->Dynamics.clear();
+    this->Contacts.clear();
+}
+
+GLuint PhysicsWorld::AddKinematic(glm::vec2 position, glm::vec2 size, GLuint layer, GLuint mask, GLuint owner)
+{
+    return PushBody(this->Kinematics, ToVec2(position), ToVec2(size), 0.0f, layer, mask, owner);
+}
+
+GLuint PhysicsWorld::AddBox(glm::vec2 position, glm::vec2 size, GLuint layer, GLuint mask, GLuint owner)
+{
+    return PushBody(this->Dynamics, ToVec2(position), ToVec2(size), 0.0f, layer, mask, owner);
+}
+
+GLuint PhysicsWorld::AddCircle(glm::vec2 position, GLfloat radius, GLuint layer, GLuint mask, GLuint owner)
+{
+    return PushBody(this->Dynamics, ToVec2(position), ToVec2(glm::vec2(radius * 2.0f)), ToScalar(radius), layer, mask, owner);
+}
+
+GLboolean PhysicsWorld::Sweep(Vec2 center, Scalar radius, GLuint mask, Vec2 motion,
+    SweepHit& hit, Contact& contact) const
+{
+    SweepHit first = { 1.0f, Vec2(0.0f) };
+    contact.Kind = CONTACT_WALL;
+    contact.Other = 0;
+    GLboolean found = GL_FALSE;
+    // walls: left or right, then top
+    if (motion.x < 0.0f && (radius - center.x) / motion.x <= first.Time)
+    {
+        first.Time = Max((radius - center.x) / motion.x, 0.0f);
+        first.Normal = Vec2(1.0f, 0.0f);
+        found = GL_TRUE;
+    }
+    else if (motion.x > 0.0f && (this->Width - radius - center.x) / motion.x <= first.Time)
+    {
+        first.Time = Max((this->Width - radius - center.x) / motion.x, 0.0f);
+        first.Normal = Vec2(-1.0f, 0.0f);
+        found = GL_TRUE;
+    }
+    if (motion.y < 0.0f && (radius - center.y) / motion.y <= first.Time)
+    {
+        first.Time = Max((radius - center.y) / motion.y, 0.0f);
+        first.Normal = Vec2(0.0f, 1.0f);
+        found = GL_TRUE;
+    }
+    // bricks, only the grid cells the sweep covers
+    if ((mask & LAYER_BRICK) && this->Statics)
+    {
+        GLint brick = this->Statics->SweepBricks(center, radius, motion, first);
+        if (brick >= 0)
+        {
+            contact.Kind = CONTACT_STATIC;
+            contact.Other = brick;
+            found = GL_TRUE;
+        }
+    }
+    for (GLuint i = 0; i < this->Kinematics.size(); ++i)
+    {
+        const PhysicsBody& box = this->Kinematics[i];
+        SweepHit candidate;
+        if ((mask & box.Layer) && SweepCircleAABB(center, radius, motion, box.Position, box.Position + box.Size, candidate)
+            && candidate.Time < first.Time)
+        {
+            first = candidate;
+            contact.Kind = CONTACT_KINEMATIC;
+            contact.Other = i;
+            found = GL_TRUE;
+        }
+    }
+    hit = first;
+    return found;
+}
+
+void PhysicsWorld::FindContacts(GLuint firstDynamic)
+{
+    this->Contacts.clear();
+    GLuint count = static_cast<GLuint>(this->Kinematics.size() + this->Dynamics.size());
+    if (count <= SMALL_WORLD)
+    {
+        for (GLuint one = 0; one < count; ++one)
+            for (GLuint two = one + 1; two < count; ++two)
+                this->testPair(one, two, firstDynamic);
+        this->sortContacts();
+        return;
+    }
+    this->minX.resize(count);
+    this->maxX.resize(count);
+    for (GLuint id = 0; id < count; ++id)
+    {
+        const PhysicsBody& body = this->body(id);
+        this->minX[id] = body.Position.x - BROADPHASE_MARGIN;
+        this->maxX[id] = body.Position.x + body.Size.x + BROADPHASE_MARGIN;
+    }
+    // bodies move little between ticks, so last tick's order is almost
+    // sorted; if bodies were added or removed, start over
+    if (this->order.size() != count)
+    {
+        this->order.resize(count);
+        std::iota(this->order.begin(), this->order.end(), 0u);
+        std::sort(this->order.begin(), this->order.end(),
+            [this](GLuint one, GLuint two) { return this->minX[one] < this->minX[two]; });
+    }
+    else
+        for (GLuint i = 1; i < count; ++i)
+        {
+            GLuint id = this->order[i], j = i;
+            for (; j > 0 && this->minX[this->order[j - 1]] > this->minX[id]; --j)
+                this->order[j] = this->order[j - 1];
+            this->order[j] = id;
+        }
+    // sweep along x: every body is tested against the earlier ones still open
+    this->active.clear();
+    for (GLuint id : this->order)
+    {
+        Scalar start = this->minX[id];
+        GLuint kept = 0;
+        for (GLuint open : this->active)
+            if (this->maxX[open] >= start)
+            {
+                this->active[kept++] = open;
+                this->testPair(open, id, firstDynamic);
+            }
+        this->active.resize(kept);
+        this->active.push_back(id);
+    }
+    this->sortContacts();
+}
+
+void PhysicsWorld::sortContacts()
+{
+    if (this->Contacts.size() < 2)
+        return;
+    std::sort(this->Contacts.begin(), this->Contacts.end(), [](const Contact& one, const Contact& two) {
+        if (one.Body != two.Body)
+            return one.Body < two.Body;
+        if (one.Kind != two.Kind)
+            return one.Kind < two.Kind;
+        return one.Other < two.Other;
+    });
+}
+
+const PhysicsBody& PhysicsWorld::body(GLuint id) const
+{
+    GLuint kinematics = static_cast<GLuint>(this->Kinematics.size());
+    return id < kinematics ? this->Kinematics[id] : this->Dynamics[id - kinematics];
+}
+
+void PhysicsWorld::testPair(GLuint one, GLuint two, GLuint firstDynamic)
+{
+    GLuint kinematics = static_cast<GLuint>(this->Kinematics.size());
+    if (one < kinematics && two < kinematics)
+        return;
+    const PhysicsBody& a = this->body(one);
+    const PhysicsBody& b = this->body(two);
+    if (!(a.Mask & b.Layer) && !(b.Mask & a.Layer))
+        return;
+    if (a.Position.y + a.Size.y + BROADPHASE_MARGIN < b.Position.y || b.Position.y + b.Size.y + BROADPHASE_MARGIN < a.Position.y)
+        return;
+    GLboolean kinematic = one < kinematics || two < kinematics;
+    GLuint dynamic = (kinematic ? std::max(one, two) : std::min(one, two)) - kinematics;
+    if (dynamic < firstDynamic)
+        return;
+    // narrow test, the circle always first as in CheckCollision(BallObject&, GameObject&)
+    GLboolean touching;
+    if (a.Radius > 0.0f && b.Radius > 0.0f)
+    {
+        Vec2 offset = (a.Position + a.Radius) - (b.Position + b.Radius);
+        touching = Length(offset) <= a.Radius + b.Radius;
+    }
+    else if (a.Radius > 0.0f)
+        touching = OverlapCircleAABB(a.Position + a.Radius, a.Radius, b.Position, b.Size);
+    else if (b.Radius > 0.0f)
+        touching = OverlapCircleAABB(b.Position + b.Radius, b.Radius, a.Position, a.Size);
+    else
+        touching = OverlapAABB(a.Position, a.Size, b.Position, b.Size);
+    if (!touching)
+        return;
+    this->Contacts.emplace_back();
+    Contact& contact = this->Contacts.back();
+    contact.Body = dynamic;
+    contact.Other = kinematic ? std::min(one, two) : std::max(one, two) - kinematics;
+    contact.Kind = kinematic ? CONTACT_KINEMATIC : CONTACT_DYNAMIC;
+}
+
+// Appends a body; its fields are written in place, since copying a
+// freshly built struct stalls on reading back the partial stores
+GLuint PushBody(std::vector<PhysicsBody>& bodies, Vec2 position, Vec2 size, Scalar radius,
+    GLuint layer, GLuint mask, GLuint owner)
+{
+    bodies.emplace_back();
+    PhysicsBody& body = bodies.back();
+    body.Position = position;
+    body.Size = size;
+    body.Radius = radius;
+    body.Layer = layer;
+    body.Mask = mask;
+    body.Owner = owner;
+    return static_cast<GLuint>(bodies.size() - 1);
+}
\ No newline at end of file
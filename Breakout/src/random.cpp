@@ -0,0 +1,38 @@
+#include "random.h"
+
+
+Random::Random(std::uint64_t seed, std::uint64_t stream)
+{
+    this->Seed(seed, stream);
+}
+
+void Random::Seed(std::uint64_t seed, std::uint64_t stream)
+{
+    // pcg32_srandom_r
+    this->State = 0u;
+    this->Increment = (stream << 1u) | 1u;
+    this->Next();
+    this->State += seed;
+    this->Next();
+}
+
+std::uint32_t Random::Next()
+{
+    // pcg32_random_r
+    std::uint64_t old = this->State;
+    this->State = old * 6364136223846793005ULL + this->Increment;
+    std::uint32_t xorshifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+    std::uint32_t rot = static_cast<std::uint32_t>(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+}
+
+std::uint32_t Random::Below(std::uint32_t bound)
+{
+    // multiply-shift range reduction; the bias is below 2^-32 * bound
+    return static_cast<std::uint32_t>((static_cast<std::uint64_t>(this->Next()) * bound) >> 32u);
+}
+
+float Random::Float()
+{
+    return (this->Next() >> 8u) * (1.0f / 16777216.0f);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "render_snapshot.h"
+
+
+// function declaration
+void CaptureSprite(SpriteState& sprite, const GameObject& object, GLuint kind);
+
+
+RenderSnapshot::RenderSnapshot()
+    : State(GAME_START), Level(0), Lives(0), Confuse(GL_FALSE), Chaos(GL_FALSE), Player(), Ball(),
+    BallVelocity(0.0f), BallRadius(0.0f), BricksLevel(0), Seed(0), Tick(0), Time(0.0) { }
+
+void RenderSnapshot::Capture(const Game& game)
+{
+    this->State = game.State;
+    this->Level = game.Level;
+    this->Lives = game.Lives;
+    this->Confuse = game.Confuse;
+    this->Chaos = game.Chaos;
+    CaptureSprite(this->Player, game.Player, 0);
+    CaptureSprite(this->Ball, game.Ball, 0);
+    this->BallVelocity = game.Ball.Velocity;
+    this->BallRadius = game.Ball.Radius;
+    this->Seed = game.RandomSeed;
+    // clear() keeps the capacity, so steady-state captures do not allocate
+    if (game.Level < game.Levels.size())
+    {
+        const GameLevel& level = game.Levels[game.Level];
+        if (this->BricksLevel != game.Level || this->Bricks.size() != level.Bricks.size())
+        {
+            this->BricksLevel = game.Level;
+            this->Bricks.resize(level.Bricks.size());
+            for (GLuint i = 0; i < level.Bricks.size(); ++i)
+                CaptureSprite(this->Bricks[i], level.Bricks[i], level.Bricks[i].IsSolid);
+        }
+        this->BricksAlive.assign(level.Alive.begin(), level.Alive.end());
+    }
+    else
+    {
+        this->Bricks.clear();
+        this->BricksAlive.clear();
+    }
+    this->PowerUps.clear();
+    for (const PowerUp& powerup : game.PowerUps)
+    {
+        if (powerup.Destroyed)
+            continue;
+        this->PowerUps.push_back(SpriteState());
+        CaptureSprite(this->PowerUps.back(), powerup, PowerUpKind(powerup.Type));
+    }
+    const BallPool& balls = game.Balls;
+    glm::vec2 size(balls.Radius * 2.0f);
+    this->Balls.resize(balls.Size());
+    for (GLuint i = 0; i < balls.Size(); ++i)
+    {
+        SpriteState& sprite = this->Balls[i];
+        sprite.Position = glm::vec2(balls.X[i], balls.Y[i]);
+        sprite.PrevPosition = glm::vec2(balls.PrevX[i], balls.PrevY[i]);
+        sprite.Size = size;
+        sprite.Color = game.Ball.Color;
+        sprite.Rotation = 0.0f;
+        sprite.Kind = 0;
+    }
+}
+
+void CaptureSprite(SpriteState& sprite, const GameObject& object, GLuint kind)
+{
+    sprite.Position = object.Position;
+    sprite.PrevPosition = object.PrevPosition;
+    sprite.Size = object.Size;
+    sprite.Color = object.Color;
+    sprite.Rotation = object.Rotation;
+    sprite.Kind = kind;
+}
\ No newline at end of file
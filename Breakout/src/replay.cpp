@@ -0,0 +1,178 @@
+#include "replay.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+
+const GLchar REPLAY_MAGIC[4] = { 'B', 'K', 'R', 'P' };
+// 2: multi-ball powerups, earlier sessions no longer replay
+const std::uint8_t REPLAY_VERSION = 2;
+
+
+// function declaration
+void WriteVarint(std::vector<std::uint8_t>& out, std::uint64_t value);
+void WriteFixed32(std::vector<std::uint8_t>& out, std::uint32_t value);
+GLboolean ReadVarint(const std::vector<std::uint8_t>& in, size_t& pos, std::uint64_t& value);
+GLboolean ReadFixed32(const std::vector<std::uint8_t>& in, size_t& pos, std::uint32_t& value);
+
+
+ReplayRecorder::ReplayRecorder(std::uint64_t seed, GLfloat dt)
+    : seed(seed), dt(dt), ticks(0), events(0), lastEventTick(0) { }
+
+void ReplayRecorder::Key(GLuint key, GLboolean pressed)
+{
+    WriteVarint(this->eventBytes, this->ticks - this->lastEventTick);
+    WriteVarint(this->eventBytes, (static_cast<std::uint64_t>(key) << 1) | (pressed ? 1u : 0u));
+    this->lastEventTick = this->ticks;
+    ++this->events;
+}
+
+void ReplayRecorder::EndTick(const Game& game)
+{
+    this->checksums.push_back(game.Checksum());
+    ++this->ticks;
+}
+
+GLboolean ReplayRecorder::Save(const GLchar* file) const
+{
+    std::vector<std::uint8_t> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    out.push_back(REPLAY_VERSION);
+    WriteVarint(out, this->seed);
+    std::uint32_t dtBits;
+    std::memcpy(&dtBits, &this->dt, sizeof(dtBits));
+    WriteFixed32(out, dtBits);
+    WriteVarint(out, this->ticks);
+    WriteVarint(out, this->events);
+    out.insert(out.end(), this->eventBytes.begin(), this->eventBytes.end());
+    for (std::uint32_t checksum : this->checksums)
+        WriteFixed32(out, checksum);
+
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream.write(reinterpret_cast<const char*>(out.data()), out.size()))
+    {
+        std::cout << "ERROR::REPLAY: Failed to write " << file << std::endl;
+        return GL_FALSE;
+    }
+    return GL_TRUE;
+}
+
+ReplayPlayer::ReplayPlayer()
+    : Seed(0), Dt(0.0f), Ticks(0), tick(0), nextEvent(0) { }
+
+GLboolean ReplayPlayer::Load(const GLchar* file)
+{
+    std::ifstream stream(file, std::ios::binary);
+    std::vector<std::uint8_t> in((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    size_t pos = 5;
+    std::uint64_t seed, ticks, count;
+    std::uint32_t dtBits;
+    if (in.size() < pos || std::memcmp(in.data(), REPLAY_MAGIC, 4) != 0 || in[4] != REPLAY_VERSION
+        || !ReadVarint(in, pos, seed) || !ReadFixed32(in, pos, dtBits)
+        || !ReadVarint(in, pos, ticks) || !ReadVarint(in, pos, count))
+    {
+        std::cout << "ERROR::REPLAY: " << file << " is not a replay file" << std::endl;
+        return GL_FALSE;
+    }
+    // every event takes at least 2 bytes and every checksum 4, so a
+    // corrupt header cannot make us allocate more than the file holds
+    std::uint64_t left = in.size() - pos;
+    if (count > left / 2 || ticks > left / 4 || count * 2 + ticks * 4 > left)
+    {
+        std::cout << "ERROR::REPLAY: " << file << " is truncated" << std::endl;
+        return GL_FALSE;
+    }
+    this->events.clear();
+    this->events.reserve(static_cast<size_t>(count));
+    GLuint eventTick = 0;
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        std::uint64_t delta, code;
+        if (!ReadVarint(in, pos, delta) || !ReadVarint(in, pos, code))
+        {
+            std::cout << "ERROR::REPLAY: " << file << " is truncated" << std::endl;
+            return GL_FALSE;
+        }
+        eventTick += static_cast<GLuint>(delta);
+        ReplayEvent event = { eventTick, static_cast<GLuint>(code >> 1), static_cast<GLboolean>(code & 1u) };
+        this->events.push_back(event);
+    }
+    this->checksums.resize(static_cast<size_t>(ticks));
+    for (std::uint32_t& checksum : this->checksums)
+    {
+        if (!ReadFixed32(in, pos, checksum))
+        {
+            std::cout << "ERROR::REPLAY: " << file << " is truncated" << std::endl;
+            return GL_FALSE;
+        }
+    }
+    this->Seed = seed;
+    std::memcpy(&this->Dt, &dtBits, sizeof(dtBits));
+    this->Ticks = static_cast<GLuint>(ticks);
+    this->tick = this->nextEvent = 0;
+    return GL_TRUE;
+}
+
+void ReplayPlayer::BeginTick(Game& game)
+{
+    while (this->nextEvent < this->events.size() && this->events[this->nextEvent].Tick == this->tick)
+    {
+        const ReplayEvent& event = this->events[this->nextEvent++];
+        game.SetKey(event.Key, event.Pressed);
+    }
+}
+
+GLboolean ReplayPlayer::EndTick(const Game& game)
+{
+    return game.Checksum() == this->checksums[this->tick++];
+}
+
+GLuint ReplayPlayer::Tick() const
+{
+    return this->tick;
+}
+
+GLboolean ReplayPlayer::Done() const
+{
+    return this->tick >= this->Ticks;
+}
+
+void WriteVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void WriteFixed32(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+}
+
+GLboolean ReadVarint(const std::vector<std::uint8_t>& in, size_t& pos, std::uint64_t& value)
+{
+    value = 0;
+    for (GLuint shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+        std::uint8_t byte = in[pos++];
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return GL_TRUE;
+    }
+    return GL_FALSE;
+}
+
+GLboolean ReadFixed32(const std::vector<std::uint8_t>& in, size_t& pos, std::uint32_t& value)
+{
+    if (pos + 4 > in.size())
+        return GL_FALSE;
+    value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<std::uint32_t>(in[pos++]) << (8 * i);
+    return GL_TRUE;
+}
\ No newline at end of file
@@ -10,6 +10,9 @@
 // Instantiate static variables
 std::map<std::string, Texture2D> ResourceManager::Textures;
 std::map<std::string, Shader> ResourceManager::Shaders;
+TextureArray ResourceManager::SpriteArray;
+std::map<std::string, SpriteRegion> ResourceManager::Sprites;
+std::map<std::string, GLuint> ResourceManager::spriteIndices;
 
 Shader ResourceManager::LoadShader(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile, std::string name)
 {
@@ -17,6 +20,20 @@ Shader ResourceManager::LoadShader(const GLchar* vShaderFile, const GLchar* fSha
     return Shaders[name];
 }
 
+Shader ResourceManager::LoadFeedbackShader(const GLchar* vShaderFile, const GLchar* const* varyings, GLsizei count, std::string name)
+{
+    std::ifstream vertexShaderFile(vShaderFile);
+    std::stringstream vShaderStream;
+    vShaderStream << vertexShaderFile.rdbuf();
+    if (!vertexShaderFile)
+        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+    std::string vertexCode = vShaderStream.str();
+    Shader shader;
+    shader.CompileFeedback(vertexCode.c_str(), varyings, count);
+    Shaders[name] = shader;
+    return shader;
+}
+
 Shader& ResourceManager::GetShader(std::string name)
 {
     return Shaders[name];
@@ -33,6 +50,37 @@ Texture2D& ResourceManager::GetTexture(std::string name)
     return Textures[name];
 }
 
+void ResourceManager::LoadSprite(const GLchar* file, GLboolean alpha, std::string name)
+{
+    int width, height, channels;
+    unsigned char* image = stbi_load(file, &width, &height, &channels, STBI_rgb_alpha);
+    if (!image)
+    {
+        std::cout << "ERROR::SPRITE: Failed to load " << file << std::endl;
+        return;
+    }
+    // Like a GL_RGB texture, an image loaded without alpha is opaque
+    if (!alpha)
+        for (int i = 0; i < width * height; ++i)
+            image[i * 4 + 3] = 255;
+    spriteIndices[name] = SpriteArray.Add(width, height, image);
+    stbi_image_free(image);
+}
+
+GLboolean ResourceManager::GenerateSprites()
+{
+    if (!SpriteArray.Generate())
+        return GL_FALSE;
+    for (auto it : spriteIndices)
+        Sprites[it.first] = SpriteArray.Region(it.second);
+    return GL_TRUE;
+}
+
+SpriteRegion& ResourceManager::GetSprite(std::string name)
+{
+    return Sprites[name];
+}
+
 void ResourceManager::Clear()
 {
     // (Properly) delete all shaders	
@@ -41,6 +89,9 @@ void ResourceManager::Clear()
     // (Properly) delete all textures
     for (auto it : Textures)
         glDeleteTextures(1, &it.second.ID);
+    SpriteArray.Clear();
+    Sprites.clear();
+    spriteIndices.clear();
 }
 
 Shader ResourceManager::loadShaderFromFile(const GLchar* vShaderFile, const GLchar* fShaderFile, const GLchar* gShaderFile)
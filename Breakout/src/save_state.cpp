@@ -0,0 +1,376 @@
+#include "save_state.h"
+
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+#include "render_snapshot.h"
+
+static_assert(std::is_trivially_copyable<GameObject>::value && std::is_trivially_copyable<BallObject>::value,
+    "save states copy game objects as raw bytes");
+
+namespace
+{
+    // "BKSS"
+    const std::uint32_t SAVE_MAGIC = 0x53534b42;
+    // Flags stored with each key code
+    const std::uint16_t KEY_HELD = 0x400, KEY_PROCESSED = 0x800;
+    // Arena bytes per frame when no size is given
+    const std::size_t DEFAULT_FRAME_BYTES = 512;
+
+    std::size_t Align8(std::size_t size)
+    {
+        return (size + 7) & ~std::size_t(7);
+    }
+
+    // Calls f(key) for every key that is held or processed, skipping idle keys eight at a time
+    template <typename F>
+    void ForEachKey(const Game& game, F f)
+    {
+        static_assert(sizeof(game.Keys[0]) == 1 && sizeof(game.KeyProcessed[0]) == 1, "keys are scanned as bytes");
+        for (GLuint base = 0; base < 1024; base += 8)
+        {
+            std::uint64_t held, processed;
+            std::memcpy(&held, &game.Keys[base], sizeof(held));
+            std::memcpy(&processed, &game.KeyProcessed[base], sizeof(processed));
+            if (held | processed)
+                for (GLuint key = base; key < base + 8; ++key)
+                    if (game.Keys[key] || game.KeyProcessed[key])
+                        f(key);
+        }
+    }
+
+    // Keys that are held or processed
+    GLuint CountKeys(const Game& game)
+    {
+        GLuint keys = 0;
+        ForEachKey(game, [&keys](GLuint) { ++keys; });
+        return keys;
+    }
+
+    // Size of a frame of game holding brickBytes of brick data
+    std::size_t FrameSize(const Game& game, GLuint keys, std::size_t brickBytes)
+    {
+        return Align8(sizeof(SaveStateHeader)) + Align8(keys * sizeof(std::uint16_t))
+            + Align8(game.PowerUps.size() * sizeof(SavedPowerUp)) + Align8(game.Balls.Size() * sizeof(SavedBall))
+            + Align8(brickBytes);
+    }
+
+    // Writes everything but the bricks into out, returns where the bricks go
+    std::uint8_t* WriteFrame(const Game& game, GLuint keys, GLboolean delta, GLuint bricks, std::size_t size, std::uint8_t* out)
+    {
+        SaveStateHeader header;
+        std::memset(static_cast<void*>(&header), 0, sizeof(header));
+        header.Magic = SAVE_MAGIC;
+        header.Size = static_cast<std::uint32_t>(size);
+        header.State = game.State;
+        header.Level = game.Level;
+        header.Lives = game.Lives;
+        header.Confuse = game.Confuse;
+        header.Chaos = game.Chaos;
+        header.Delta = delta;
+        header.Player = game.Player;
+        header.Ball = game.Ball;
+        header.RngState = game.Rng.State;
+        header.RngIncrement = game.Rng.Increment;
+        header.RandomSeed = game.RandomSeed;
+        header.Keys = keys;
+        header.PowerUps = static_cast<std::uint32_t>(game.PowerUps.size());
+        header.Balls = game.Balls.Size();
+        header.Bricks = bricks;
+        std::memcpy(out, &header, sizeof(header));
+        out += Align8(sizeof(header));
+
+        std::uint16_t* codes = reinterpret_cast<std::uint16_t*>(out);
+        ForEachKey(game, [&game, &codes](GLuint key) {
+            *codes++ = static_cast<std::uint16_t>(key | (game.Keys[key] ? KEY_HELD : 0) | (game.KeyProcessed[key] ? KEY_PROCESSED : 0));
+        });
+        out += Align8(keys * sizeof(std::uint16_t));
+
+        for (const PowerUp& powerup : game.PowerUps)
+        {
+            SavedPowerUp saved;
+            std::memset(static_cast<void*>(&saved), 0, sizeof(saved));
+            saved.Object = powerup;
+            saved.Duration = powerup.Duration;
+            saved.Kind = PowerUpKind(powerup.Type);
+            saved.Activated = powerup.Activated;
+            std::memcpy(out, &saved, sizeof(saved));
+            out += sizeof(saved);
+        }
+        out += Align8(game.PowerUps.size() * sizeof(SavedPowerUp)) - game.PowerUps.size() * sizeof(SavedPowerUp);
+
+        const BallPool& balls = game.Balls;
+        for (GLuint i = 0; i < balls.Size(); ++i)
+        {
+            SavedBall saved = { balls.X[i], balls.Y[i], balls.VX[i], balls.VY[i], balls.PrevX[i], balls.PrevY[i] };
+            std::memcpy(out, &saved, sizeof(saved));
+            out += sizeof(saved);
+        }
+        out += Align8(balls.Size() * sizeof(SavedBall)) - balls.Size() * sizeof(SavedBall);
+        return out;
+    }
+
+    // Checks a frame's header and whether it fits game
+    GLboolean ReadHeader(const Game& game, const std::uint8_t* frame, std::size_t size, SaveStateHeader& header)
+    {
+        if (size < sizeof(header))
+            return GL_FALSE;
+        std::memcpy(&header, frame, sizeof(header));
+        if (header.Magic != SAVE_MAGIC || header.Size > size || header.Level >= game.Levels.size())
+            return GL_FALSE;
+        return header.Delta || header.Bricks == game.Levels[header.Level].Alive.size();
+    }
+
+    // The brick data of a frame
+    const std::uint8_t* FrameBricks(const std::uint8_t* frame, const SaveStateHeader& header)
+    {
+        return frame + Align8(sizeof(SaveStateHeader)) + Align8(header.Keys * sizeof(std::uint16_t))
+            + Align8(header.PowerUps * sizeof(SavedPowerUp)) + Align8(header.Balls * sizeof(SavedBall));
+    }
+
+    // Restores everything of a checked frame but the bricks
+    void ReadFrame(Game& game, const std::uint8_t* frame, const SaveStateHeader& header)
+    {
+        // the level being left goes back to its initial state, like ResetLevel does
+        if (game.Level != header.Level && game.Level < game.Levels.size())
+            game.Levels[game.Level].Reset();
+        game.State = header.State;
+        game.Level = header.Level;
+        game.Lives = header.Lives;
+        game.Confuse = header.Confuse;
+        game.Chaos = header.Chaos;
+        game.Player = header.Player;
+        game.Ball = header.Ball;
+        game.Rng.State = header.RngState;
+        game.Rng.Increment = header.RngIncrement;
+        game.RandomSeed = header.RandomSeed;
+        frame += Align8(sizeof(SaveStateHeader));
+
+        std::memset(game.Keys, 0, sizeof(game.Keys));
+        std::memset(game.KeyProcessed, 0, sizeof(game.KeyProcessed));
+        const std::uint16_t* codes = reinterpret_cast<const std::uint16_t*>(frame);
+        for (GLuint i = 0; i < header.Keys; ++i)
+        {
+            GLuint key = codes[i] & (KEY_HELD - 1);
+            game.Keys[key] = (codes[i] & KEY_HELD) != 0;
+            game.KeyProcessed[key] = (codes[i] & KEY_PROCESSED) != 0;
+        }
+        frame += Align8(header.Keys * sizeof(std::uint16_t));
+
+        // reuse the existing powerups, so their type strings keep their storage
+        if (game.PowerUps.size() > header.PowerUps)
+            game.PowerUps.erase(game.PowerUps.begin() + header.PowerUps, game.PowerUps.end());
+        for (GLuint i = 0; i < header.PowerUps; ++i)
+        {
+            SavedPowerUp saved;
+            std::memcpy(&saved, frame + i * sizeof(SavedPowerUp), sizeof(saved));
+            const GLchar* type = POWERUP_TYPES[saved.Kind < POWERUP_KINDS ? saved.Kind : 0];
+            if (i == game.PowerUps.size())
+                game.PowerUps.push_back(PowerUp(type, saved.Object.Color, saved.Duration, saved.Object.Position));
+            PowerUp& powerup = game.PowerUps[i];
+            static_cast<GameObject&>(powerup) = saved.Object;
+            if (powerup.Type != type)
+                powerup.Type = type;
+            powerup.Duration = saved.Duration;
+            powerup.Activated = saved.Activated;
+        }
+        frame += Align8(header.PowerUps * sizeof(SavedPowerUp));
+
+        BallPool& balls = game.Balls;
+        balls.Clear();
+        for (GLuint i = 0; i < header.Balls; ++i)
+        {
+            SavedBall saved;
+            std::memcpy(&saved, frame + i * sizeof(SavedBall), sizeof(saved));
+            balls.Add(glm::vec2(saved.X, saved.Y), glm::vec2(saved.VX, saved.VY));
+            balls.PrevX.back() = saved.PrevX;
+            balls.PrevY.back() = saved.PrevY;
+        }
+        game.Events.Clear();
+    }
+}
+
+void SaveState::Capture(const Game& game)
+{
+    const std::vector<std::uint64_t>& alive = game.Levels[game.Level].Alive;
+    GLuint keys = CountKeys(game);
+    std::size_t size = FrameSize(game, keys, alive.size() * sizeof(std::uint64_t));
+    this->Bytes.resize(size);
+    std::uint8_t* bricks = WriteFrame(game, keys, GL_FALSE, static_cast<GLuint>(alive.size()), size, this->Bytes.data());
+    std::memcpy(bricks, alive.data(), alive.size() * sizeof(std::uint64_t));
+}
+
+GLboolean SaveState::Restore(Game& game) const
+{
+    SaveStateHeader header;
+    if (!ReadHeader(game, this->Bytes.data(), this->Bytes.size(), header) || header.Delta)
+    {
+        std::cout << "ERROR::SAVESTATE: State does not match the game's levels" << std::endl;
+        return GL_FALSE;
+    }
+    ReadFrame(game, this->Bytes.data(), header);
+    game.Levels[game.Level].SetAlive(reinterpret_cast<const std::uint64_t*>(FrameBricks(this->Bytes.data(), header)));
+    return GL_TRUE;
+}
+
+RewindBuffer::RewindBuffer(GLuint ticks, std::size_t bytes, GLuint keyframeInterval)
+    : arena(bytes ? bytes : ticks * DEFAULT_FRAME_BYTES), frames(ticks > 0 ? ticks : 1), first(0), count(0), writeOffset(0),
+    keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1), sinceKeyframe(0), level(0) { }
+
+void RewindBuffer::Record(const Game& game)
+{
+    const std::vector<std::uint64_t>& words = game.Levels[game.Level].Alive;
+    // deltas need the previous frame of the same level as their base
+    GLboolean keyframe = this->count == 0 || this->sinceKeyframe + 1 >= this->keyframeInterval
+        || game.Level != this->level || words.size() != this->alive.size();
+    this->flipped.clear();
+    if (!keyframe)
+    {
+        for (GLuint word = 0; word < words.size(); ++word)
+            for (std::uint64_t flips = words[word] ^ this->alive[word]; flips; flips &= flips - 1)
+                this->flipped.push_back(word * 64 + LowestBit(flips));
+        // a long list of changes (a level reset) is stored as a bitmap instead
+        if (this->flipped.size() * sizeof(std::uint32_t) >= words.size() * sizeof(std::uint64_t))
+            keyframe = GL_TRUE;
+    }
+    GLuint keys = CountKeys(game);
+    std::size_t size = FrameSize(game, keys, keyframe ? words.size() * sizeof(std::uint64_t) : this->flipped.size() * sizeof(std::uint32_t));
+    if (size > this->arena.size())
+    {
+        std::cout << "ERROR::REWIND: Frame of " << size << " bytes does not fit the buffer" << std::endl;
+        return;
+    }
+    std::size_t offset = this->allocate(size);
+    if (!keyframe && this->count == 0)
+    {   // making room dropped the delta's base, store a full frame instead
+        keyframe = GL_TRUE;
+        size = FrameSize(game, keys, words.size() * sizeof(std::uint64_t));
+        if (size > this->arena.size())
+            return;
+        offset = this->allocate(size);
+    }
+
+    std::uint8_t* bricks = WriteFrame(game, keys, !keyframe,
+        static_cast<GLuint>(keyframe ? words.size() : this->flipped.size()), size, &this->arena[offset]);
+    if (keyframe)
+        std::memcpy(bricks, words.data(), words.size() * sizeof(std::uint64_t));
+    else if (!this->flipped.empty())
+        std::memcpy(bricks, this->flipped.data(), this->flipped.size() * sizeof(std::uint32_t));
+    Frame added = { offset, size, keyframe };
+    this->frames[(this->first + this->count) % this->frames.size()] = added;
+    ++this->count;
+    this->writeOffset = offset + size;
+    this->sinceKeyframe = keyframe ? 0 : this->sinceKeyframe + 1;
+    this->level = game.Level;
+    this->alive.assign(words.begin(), words.end());
+}
+
+GLuint RewindBuffer::Frames() const
+{
+    return this->count;
+}
+
+std::size_t RewindBuffer::Bytes() const
+{
+    std::size_t bytes = 0;
+    for (GLuint i = 0; i < this->count; ++i)
+        bytes += this->frames[(this->first + i) % this->frames.size()].Size;
+    return bytes;
+}
+
+GLboolean RewindBuffer::Restore(Game& game, GLuint ago)
+{
+    if (ago >= this->count)
+        return GL_FALSE;
+    GLuint target = this->count - 1 - ago;
+    // the oldest frame is always a keyframe
+    GLuint key = target;
+    while (!this->frame(key).Keyframe)
+        --key;
+    SaveStateHeader header;
+    const std::uint8_t* data = &this->arena[this->frame(key).Offset];
+    if (!ReadHeader(game, data, this->frame(key).Size, header))
+    {
+        std::cout << "ERROR::REWIND: Frame does not match the game's levels" << std::endl;
+        return GL_FALSE;
+    }
+    this->bricks.resize(header.Bricks);
+    std::memcpy(this->bricks.data(), FrameBricks(data, header), header.Bricks * sizeof(std::uint64_t));
+    // replay the brick changes up to the target frame
+    for (GLuint i = key + 1; i <= target; ++i)
+    {
+        data = &this->arena[this->frame(i).Offset];
+        std::memcpy(&header, data, sizeof(header));
+        const std::uint32_t* flips = reinterpret_cast<const std::uint32_t*>(FrameBricks(data, header));
+        for (GLuint j = 0; j < header.Bricks; ++j)
+            this->bricks[flips[j] >> 6] ^= std::uint64_t(1) << (flips[j] & 63);
+    }
+    data = &this->arena[this->frame(target).Offset];
+    ReadHeader(game, data, this->frame(target).Size, header);
+    ReadFrame(game, data, header);
+    game.Levels[game.Level].SetAlive(this->bricks.data());
+    return GL_TRUE;
+}
+
+GLboolean RewindBuffer::Rewind(Game& game, GLuint ago)
+{
+    if (!this->Restore(game, ago))
+        return GL_FALSE;
+    this->count -= ago;
+    const Frame& newest = this->frame(this->count - 1);
+    this->writeOffset = newest.Offset + newest.Size;
+    this->sinceKeyframe = 0;
+    for (GLuint i = this->count - 1; !this->frame(i).Keyframe; --i)
+        ++this->sinceKeyframe;
+    this->level = game.Level;
+    this->alive.assign(this->bricks.begin(), this->bricks.end());
+    return GL_TRUE;
+}
+
+void RewindBuffer::Clear()
+{
+    this->first = 0;
+    this->count = 0;
+    this->writeOffset = 0;
+    this->sinceKeyframe = 0;
+}
+
+RewindBuffer::Frame& RewindBuffer::frame(GLuint i)
+{
+    return this->frames[(this->first + i) % this->frames.size()];
+}
+
+std::size_t RewindBuffer::allocate(std::size_t size)
+{
+    if (this->count == this->frames.size())
+        this->dropOldest();
+    while (this->count > 0)
+    {
+        std::size_t oldest = this->frame(0).Offset;
+        if (oldest >= this->writeOffset)
+        {   // the free space lies between the newest and the oldest frame
+            if (this->writeOffset + size <= oldest)
+                return this->writeOffset;
+        }
+        else
+        {   // the free space runs from the newest frame to the end, and from the start to the oldest
+            if (this->writeOffset + size <= this->arena.size())
+                return this->writeOffset;
+            if (size <= oldest)
+                return 0;
+        }
+        this->dropOldest();
+    }
+    this->writeOffset = 0;
+    return 0;
+}
+
+void RewindBuffer::dropOldest()
+{
+    do
+    {
+        this->first = (this->first + 1) % this->frames.size();
+        --this->count;
+    } while (this->count > 0 && !this->frame(0).Keyframe);
+}
\ No newline at end of file
@@ -44,6 +44,21 @@ void Shader::Compile(const GLchar* vertexSource, const GLchar* fragmentSource, c
         glDeleteShader(gShader);
 }
 
+void Shader::CompileFeedback(const GLchar* vertexSource, const GLchar* const* varyings, GLsizei count)
+{
+    GLuint sVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(sVertex, 1, &vertexSource, NULL);
+    glCompileShader(sVertex);
+    checkCompileErrors(sVertex, "VERTEX");
+    // The varyings have to be known before linking
+    this->ID = glCreateProgram();
+    glAttachShader(this->ID, sVertex);
+    glTransformFeedbackVaryings(this->ID, count, const_cast<const GLchar**>(varyings), GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(this->ID);
+    checkCompileErrors(this->ID, "PROGRAM");
+    glDeleteShader(sVertex);
+}
+
 void Shader::SetFloat(const GLchar* name, GLfloat value, GLboolean useShader)
 {
     if (useShader)
@@ -0,0 +1,1248 @@
+#include "sim_bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "autoplayer.h"
+#include "ball_object.h"
+#include "ball_pool.h"
+#include "batched_breakout.h"
+#include "collision.h"
+#include "collision_batch.h"
+#include "game.h"
+#include "game_level.h"
+#include "job_system.h"
+#include "physics_world.h"
+#include "random.h"
+#include "render_snapshot.h"
+#include "replay.h"
+#include "save_state.h"
+#include "software_rasterizer.h"
+#include "spatial_hash.h"
+
+
+// function declaration
+int BenchBroadphase();
+int BenchOverlap();
+int BenchJobs();
+int BenchSaveState();
+int BenchThroughput();
+int BenchBatched();
+int BenchRaster();
+int BenchPhysics();
+int BenchFixed();
+int BenchMultiBall();
+int BenchReplay();
+GLint SweepAllBricks(const GameLevel& level, glm::vec2 center, GLfloat radius, glm::vec2 motion, BasicSweepHit<glm::vec2>& hit);
+void FindAllContacts(const PhysicsWorld& world, std::vector<Contact>& contacts);
+template <typename V>
+GLuint TimeKernels(const std::vector<glm::vec2>& samples, GLfloat radius, GLdouble ns[3]);
+
+
+int RunBenchmark(const GLchar* name)
+{
+    if (std::strcmp(name, "broadphase") == 0)
+        return BenchBroadphase();
+    if (std::strcmp(name, "overlap") == 0)
+        return BenchOverlap();
+    if (std::strcmp(name, "jobs") == 0)
+        return BenchJobs();
+    if (std::strcmp(name, "savestate") == 0)
+        return BenchSaveState();
+    if (std::strcmp(name, "throughput") == 0)
+        return BenchThroughput();
+    if (std::strcmp(name, "batched") == 0)
+        return BenchBatched();
+    if (std::strcmp(name, "raster") == 0)
+        return BenchRaster();
+    if (std::strcmp(name, "physics") == 0)
+        return BenchPhysics();
+    if (std::strcmp(name, "fixed") == 0)
+        return BenchFixed();
+    if (std::strcmp(name, "multiball") == 0)
+        return BenchMultiBall();
+    if (std::strcmp(name, "replay") == 0)
+        return BenchReplay();
+    std::cout << "ERROR::BENCH: Unknown benchmark " << name << std::endl;
+    return 1;
+}
+
+// The linear scan the grid replaced: every brick, in Bricks order
+GLint SweepAllBricks(const GameLevel& level, glm::vec2 center, GLfloat radius, glm::vec2 motion, BasicSweepHit<glm::vec2>& hit)
+{
+    GLint result = -1;
+    BasicSweepHit<glm::vec2> test;
+    for (GLuint i = 0; i < level.Bricks.size(); ++i)
+    {
+        const GameObject& box = level.Bricks[i];
+        if (!box.Destroyed && SweepCircleAABB(center, radius, motion, box.Position, box.Position + box.Size, test)
+            && test.Time < hit.Time)
+        {
+            hit = test;
+            result = i;
+        }
+    }
+    return result;
+}
+
+// Random levels of 60x20 bricks with about half of them destroyed, swept
+// by a ball of the game's radius moving one 60 Hz step at 500 px/s in a
+// random direction from a random point in the level.
+int BenchBroadphase()
+{
+    const GLuint brickCounts[] = { 100, 1000, 10000, 100000 };
+    const GLuint gridSweeps = 1000000;
+    const GLfloat radius = 12.5f, step = 500.0f / 60.0f;
+    std::cout << std::setw(8) << "bricks" << std::setw(16) << "linear ns/sweep"
+        << std::setw(14) << "grid ns/sweep" << std::setw(10) << "speedup" << std::endl;
+    GLboolean mismatch = GL_FALSE;
+    for (GLuint count : brickCounts)
+    {
+        Random rng(count);
+        GLuint columns = static_cast<GLuint>(std::sqrt(count * 3.0f));
+        GLuint rows = count / columns;
+        std::vector<std::vector<GLuint>> tiles(rows, std::vector<GLuint>(columns));
+        for (std::vector<GLuint>& row : tiles)
+            for (GLuint& tile : row)
+                tile = 1 + rng.Below(5);
+        GameLevel level;
+        level.Load(tiles, columns * 60, rows * 20);
+        for (GLuint i = 0; i < level.Bricks.size(); ++i)
+            if (rng.Below(2) == 0)
+                level.Destroy(i);
+
+        std::vector<glm::vec2> centers(gridSweeps), motions(gridSweeps);
+        for (GLuint i = 0; i < gridSweeps; ++i)
+        {
+            centers[i] = glm::vec2(rng.Float() * columns * 60, rng.Float() * rows * 20);
+            GLfloat angle = rng.Float() * 6.2831853f;
+            motions[i] = glm::vec2(std::cos(angle), std::sin(angle)) * step;
+        }
+        // the linear scan gets a fixed budget of brick tests instead of sweeps
+        GLuint linearSweeps = std::min(gridSweeps, 50000000 / count);
+
+        std::vector<GLint> linearHits(linearSweeps);
+        auto start = std::chrono::steady_clock::now();
+        for (GLuint i = 0; i < linearSweeps; ++i)
+        {
+            BasicSweepHit<glm::vec2> hit = { 1.0f, glm::vec2(0.0f) };
+            linearHits[i] = SweepAllBricks(level, centers[i], radius, motions[i], hit);
+        }
+        std::chrono::duration<double, std::nano> linear = std::chrono::steady_clock::now() - start;
+
+        std::vector<GLint> gridHits(gridSweeps);
+        start = std::chrono::steady_clock::now();
+        for (GLuint i = 0; i < gridSweeps; ++i)
+        {
+            BasicSweepHit<glm::vec2> hit = { 1.0f, glm::vec2(0.0f) };
+            gridHits[i] = level.SweepBricks(centers[i], radius, motions[i], hit);
+        }
+        std::chrono::duration<double, std::nano> grid = std::chrono::steady_clock::now() - start;
+
+        for (GLuint i = 0; i < linearSweeps; ++i)
+            if (linearHits[i] != gridHits[i])
+                mismatch = GL_TRUE;
+        GLdouble linearNs = linear.count() / linearSweeps, gridNs = grid.count() / gridSweeps;
+        std::cout << std::setw(8) << level.Bricks.size() << std::setw(16) << std::fixed << std::setprecision(1) << linearNs
+            << std::setw(14) << gridNs << std::setw(9) << linearNs / gridNs << "x" << std::endl;
+    }
+    if (mismatch)
+        std::cout << "ERROR::BENCH: grid and linear scan hit different bricks" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+// One ball against 4096 bricks of the game's size scattered around it,
+// a quarter of them close enough to touch, repeated for 512 ball
+// positions. Every kernel must agree with CheckCollision on the hit mask
+// and, for hits, on the penetration vector bit for bit.
+int BenchOverlap()
+{
+    const GLuint bricks = 4096, balls = 512;
+    Random rng(7);
+    std::vector<GameObject> boxes;
+    BoxBatch batch;
+    batch.Resize(bricks);
+    for (GLuint i = 0; i < bricks; ++i)
+    {
+        glm::vec2 size(53.0f + rng.Float() * 10.0f, 20.0f + rng.Float() * 20.0f);
+        glm::vec2 position(rng.Float() * 400.0f - size.x, rng.Float() * 400.0f - size.y);
+        boxes.push_back(GameObject(position, size));
+        batch.Set(i, position, size);
+    }
+    std::vector<BallObject> ballObjects;
+    for (GLuint i = 0; i < balls; ++i)
+        ballObjects.push_back(BallObject(glm::vec2(rng.Float() * 400.0f, rng.Float() * 400.0f) - 12.5f, 12.5f, glm::vec2(0.0f)));
+
+    // reference: the per-object function, with its tuple and VectorDirection
+    std::vector<GLuint> referenceMasks(balls * bricks / BOX_BATCH);
+    std::vector<glm::vec2> referenceDiffs(balls * bricks);
+    auto start = std::chrono::steady_clock::now();
+    for (GLuint b = 0; b < balls; ++b)
+    {
+        for (GLuint i = 0; i < bricks; ++i)
+        {
+            Collision result = CheckCollision(ballObjects[b], boxes[i]);
+            if (std::get<0>(result))
+                referenceMasks[(b * bricks + i) / BOX_BATCH] |= 1u << (i % BOX_BATCH);
+            referenceDiffs[b * bricks + i] = std::get<2>(result);
+        }
+    }
+    std::chrono::duration<double, std::nano> reference = std::chrono::steady_clock::now() - start;
+    std::cout << std::setw(16) << "kernel" << std::setw(12) << "ns/brick" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::setw(16) << "CheckCollision" << std::setw(12) << std::fixed << std::setprecision(2)
+        << reference.count() / (balls * bricks) << std::setw(10) << "1.0x" << std::endl;
+
+    const GLchar* names[3] = { "scalar", "SSE2", "AVX2" };
+    const OverlapKernel kernels[3] = { OverlapCircleBoxesScalar, OverlapCircleBoxesSSE2, OverlapCircleBoxesAVX2 };
+    std::vector<GLuint> masks(referenceMasks.size());
+    std::vector<GLfloat> diffX(balls * bricks), diffY(balls * bricks);
+    GLboolean mismatch = GL_FALSE;
+    for (GLuint k = 0; k <= OverlapKernelLevel(); ++k)
+    {
+        start = std::chrono::steady_clock::now();
+        for (GLuint b = 0; b < balls; ++b)
+        {
+            glm::vec2 center = ballObjects[b].Position + ballObjects[b].Radius;
+            for (GLuint i = 0; i < bricks; i += BOX_BATCH)
+                masks[(b * bricks + i) / BOX_BATCH] = kernels[k](center, ballObjects[b].Radius, batch, i,
+                    &diffX[b * bricks + i], &diffY[b * bricks + i]);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        for (GLuint i = 0; i < masks.size(); ++i)
+        {
+            if (masks[i] != referenceMasks[i])
+                mismatch = GL_TRUE;
+            for (GLuint lane = 0; lane < BOX_BATCH; ++lane)
+            {
+                GLuint j = i * BOX_BATCH + lane;
+                glm::vec2 diff(diffX[j], diffY[j]);
+                if ((masks[i] >> lane & 1) && std::memcmp(&referenceDiffs[j], &diff, sizeof(diff)) != 0)
+                    mismatch = GL_TRUE;
+            }
+        }
+        std::cout << std::setw(16) << names[k] << std::setw(12) << elapsed.count() / (balls * bricks)
+            << std::setw(9) << reference.count() / elapsed.count() << "x" << std::endl;
+    }
+    if (mismatch)
+        std::cout << "ERROR::BENCH: batch kernels disagree with CheckCollision" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+// Scheduler overhead and scaling for 1 thread up to every core:
+//   - fork/join of empty jobs, the cost the scheduler adds to each job
+//   - ParallelFor over 1M particles with ParticleGenerator's update,
+//     which must give exactly the serial result
+int BenchJobs()
+{
+    struct BenchParticle
+    {
+        glm::vec2 Position, Velocity;
+        GLfloat   Alpha, Life;
+    };
+    const GLuint emptyJobs = 1000, joins = 200;
+    const GLuint particleCount = 1000000, passes = 50, grain = 4096;
+    const GLfloat dt = 1.0f / 120.0f;
+
+    Random rng(11);
+    std::vector<BenchParticle> initial(particleCount);
+    for (BenchParticle& p : initial)
+    {
+        p.Position = glm::vec2(rng.Float() * 800.0f, rng.Float() * 600.0f);
+        p.Velocity = glm::vec2(rng.Float() - 0.5f, rng.Float() - 0.5f) * 50.0f;
+        p.Alpha = 1.0f;
+        p.Life = rng.Float() * 0.5f;
+    }
+    std::vector<BenchParticle> reference, particles;
+    auto update = [&particles, dt](GLuint begin, GLuint end) {
+        for (GLuint i = begin; i < end; ++i)
+        {
+            BenchParticle& p = particles[i];
+            p.Life -= dt;
+            if (p.Life > 0.0f)
+            {
+                p.Position -= p.Velocity * dt;
+                p.Alpha -= dt * 2.5f;
+            }
+        }
+    };
+
+    GLuint cores = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<GLuint> threadCounts;
+    for (GLuint threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "ns/job" << std::setw(16) << "particles ms"
+        << std::setw(10) << "speedup" << std::endl;
+    GLboolean mismatch = GL_FALSE;
+    GLdouble serialMs = 0.0;
+    for (GLuint threads : threadCounts)
+    {
+        JobSystem jobs(threads - 1);
+        // empty jobs: all forked from this thread, so workers have to steal every one
+        auto start = std::chrono::steady_clock::now();
+        for (GLuint j = 0; j < joins; ++j)
+        {
+            JobCounter counter;
+            for (GLuint i = 0; i < emptyJobs; ++i)
+                jobs.Run(counter, [](void*, GLuint, GLuint) { }, nullptr);
+            jobs.Wait(counter);
+        }
+        std::chrono::duration<double, std::nano> empty = std::chrono::steady_clock::now() - start;
+
+        particles = initial;
+        start = std::chrono::steady_clock::now();
+        for (GLuint pass = 0; pass < passes; ++pass)
+            jobs.ParallelFor(particleCount, grain, update);
+        std::chrono::duration<double, std::milli> parallel = std::chrono::steady_clock::now() - start;
+        if (threads == 1)
+        {
+            reference = particles;
+            serialMs = parallel.count() / passes;
+        }
+        else if (std::memcmp(reference.data(), particles.data(), particleCount * sizeof(BenchParticle)) != 0)
+            mismatch = GL_TRUE;
+
+        GLdouble passMs = parallel.count() / passes;
+        std::cout << std::setw(8) << threads << std::setw(12) << std::fixed << std::setprecision(1)
+            << empty.count() / (joins * emptyJobs) << std::setw(16) << std::setprecision(3) << passMs
+            << std::setw(9) << std::setprecision(2) << serialMs / passMs << "x" << std::endl;
+    }
+    if (mismatch)
+        std::cout << "ERROR::BENCH: parallel particle update differs from the serial one" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+// Plays 20000 ticks at 120 Hz, steering the paddle towards the ball,
+// while recording every tick into a 10 second RewindBuffer. Restored
+// states must match the recorded checksums and play on exactly like the
+// original game did.
+int BenchSaveState()
+{
+    const GLuint ticks = 20000, rewindTicks = 1200, repeats = 10000;
+    const GLfloat dt = 1.0f / 120.0f;
+    Game game(800, 600);
+    game.Init();
+    if (game.Levels.empty() || game.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    game.SetSeed(3);
+    game.State = GAME_ACTIVE;
+    Game initial = game;
+    // input depends only on the game state, so restored games get the same input
+    auto step = [dt](Game& game) {
+        GLfloat paddle = game.Player.Position.x + game.Player.Size.x / 2;
+        GLfloat ball = game.Ball.Position.x + game.Ball.Radius;
+        game.SetKey(GLFW_KEY_A, ball < paddle - game.Player.Size.x / 4);
+        game.SetKey(GLFW_KEY_D, ball > paddle + game.Player.Size.x / 4);
+        game.SetKey(GLFW_KEY_SPACE, game.Ball.Stuck);
+        game.SetKey(GLFW_KEY_ENTER, game.State != GAME_ACTIVE);
+        game.Tick(dt);
+    };
+
+    RewindBuffer rewind(rewindTicks);
+    std::vector<std::uint32_t> checksums(ticks);
+    std::chrono::duration<double, std::nano> record(0);
+    for (GLuint t = 0; t < ticks; ++t)
+    {
+        step(game);
+        checksums[t] = game.Checksum();
+        auto start = std::chrono::steady_clock::now();
+        rewind.Record(game);
+        record += std::chrono::steady_clock::now() - start;
+    }
+    GLboolean mismatch = GL_FALSE;
+
+    // full save state round trip into a game that is somewhere else entirely
+    SaveState state;
+    auto start = std::chrono::steady_clock::now();
+    for (GLuint i = 0; i < repeats; ++i)
+        state.Capture(game);
+    std::chrono::duration<double, std::nano> capture = std::chrono::steady_clock::now() - start;
+    Game other = initial;
+    start = std::chrono::steady_clock::now();
+    for (GLuint i = 0; i < repeats; ++i)
+        state.Restore(other);
+    std::chrono::duration<double, std::nano> restore = std::chrono::steady_clock::now() - start;
+    if (other.Checksum() != checksums[ticks - 1])
+        mismatch = GL_TRUE;
+
+    // the oldest frame, rebuilt from its keyframe, must play on like the original
+    GLuint oldest = rewind.Frames() - 1;
+    Game rewound = initial;
+    start = std::chrono::steady_clock::now();
+    rewind.Restore(rewound, oldest);
+    std::chrono::duration<double, std::nano> restoreOldest = std::chrono::steady_clock::now() - start;
+    if (rewound.Checksum() != checksums[ticks - 1 - oldest])
+        mismatch = GL_TRUE;
+    for (GLuint t = ticks - oldest; t < ticks; ++t)
+    {
+        step(rewound);
+        if (rewound.Checksum() != checksums[t])
+            mismatch = GL_TRUE;
+    }
+    // rewinding drops the newer frames and recording carries on from there
+    std::size_t bytes = rewind.Bytes();
+    GLuint frames = rewind.Frames();
+    rewind.Rewind(game, 600);
+    if (game.Checksum() != checksums[ticks - 601] || rewind.Frames() != frames - 600)
+        mismatch = GL_TRUE;
+    for (GLuint t = ticks - 600; t < ticks; ++t)
+    {
+        step(game);
+        rewind.Record(game);
+        if (game.Checksum() != checksums[t])
+            mismatch = GL_TRUE;
+    }
+    if (rewind.Restore(other, 300) && other.Checksum() != checksums[ticks - 301])
+        mismatch = GL_TRUE;
+
+    std::cout << std::setw(24) << "operation" << std::setw(12) << "ns" << std::setw(10) << "bytes" << std::endl;
+    std::cout << std::setw(24) << "SaveState::Capture" << std::setw(12) << std::fixed << std::setprecision(1)
+        << capture.count() / repeats << std::setw(10) << state.Bytes.size() << std::endl;
+    std::cout << std::setw(24) << "SaveState::Restore" << std::setw(12) << restore.count() / repeats << std::endl;
+    std::cout << std::setw(24) << "RewindBuffer::Record" << std::setw(12) << record.count() / ticks
+        << std::setw(10) << bytes / frames << std::endl;
+    std::cout << std::setw(24) << "restore oldest frame" << std::setw(12) << restoreOldest.count() << std::endl;
+    std::cout << frames << " frames (" << frames / 120.0f << " s) in " << bytes << " bytes" << std::endl;
+    if (mismatch)
+        std::cout << "ERROR::BENCH: restored state does not replay like the original" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+// Clears each level with the AutoPlayer for 10 seeds at 120 ticks per
+// second. A lost game goes back through the menu and tries the level
+// again, for at most 10 minutes of game time per seed.
+int BenchThroughput()
+{
+    const GLuint seeds = 10;
+    const unsigned long long maxTicks = 120 * 60 * 10;
+    const GLfloat dt = 1.0f / 120.0f;
+    Game prototype(800, 600);
+    prototype.Init();
+    if (prototype.Levels.empty() || prototype.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    std::cout << std::setw(6) << "level" << std::setw(8) << "clears" << std::setw(12) << "ticks/clear"
+        << std::setw(12) << "lives lost" << std::setw(14) << "ticks/second" << std::setw(12) << "allocs/tick" << std::endl;
+    unsigned long long allTicks = 0, allAllocations = 0;
+    GLdouble allSeconds = 0.0;
+    for (GLuint level = 0; level < prototype.Levels.size(); ++level)
+    {
+        unsigned long long ticks = 0, allocations = 0, livesLost = 0;
+        GLuint clears = 0;
+        std::chrono::duration<double> elapsed(0);
+        for (GLuint seed = 1; seed <= seeds; ++seed)
+        {
+            Game game = prototype;
+            game.SetSeed(seed);
+            AutoPlayer player(level);
+            unsigned long long before = AllocationCount();
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned long long tick = 0; tick < maxTicks && game.State != GAME_WIN; ++tick)
+            {
+                player.Update(game, dt);
+                game.Tick(dt);
+                ++ticks;
+                for (const GameEvent& event : game.Events)
+                    livesLost += event.Type == EVENT_LIFE_LOST;
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            allocations += AllocationCount() - before;
+            clears += game.State == GAME_WIN;
+        }
+        std::cout << std::setw(6) << level + 1 << std::setw(5) << clears << "/" << std::setw(2) << seeds
+            << std::setw(12) << (clears ? ticks / clears : 0) << std::setw(12) << livesLost
+            << std::setw(14) << std::fixed << std::setprecision(0) << ticks / elapsed.count()
+            << std::setw(12) << std::setprecision(4) << static_cast<GLdouble>(allocations) / ticks << std::endl;
+        allTicks += ticks;
+        allAllocations += allocations;
+        allSeconds += elapsed.count();
+    }
+    std::cout << "total: " << allTicks << " ticks in " << std::setprecision(3) << allSeconds << " s, "
+        << std::setprecision(0) << allTicks / allSeconds << " ticks/second, "
+        << std::setprecision(4) << static_cast<GLdouble>(allAllocations) / allTicks << " allocations/tick" << std::endl;
+    return 0;
+}
+
+// Part one steps 64 worlds of every level for 30000 ticks at 120 Hz next
+// to a Game per world given the same keys: half of them played by the
+// AutoPlayer, half by random key presses, so both cleared and lost
+// episodes occur. Every tick each world's checksum, reward and episode
+// end must match its game; when an episode ends the game is restarted
+// from the seed the world was reset with. Part two times random play
+// of 4096 worlds: a loop of Game::Tick against BatchedBreakout::Step,
+// then Step sharded over 1 thread to every core.
+int BenchBatched()
+{
+    const GLuint worlds = 64, ticks = 30000, benchWorlds = 4096, benchTicks = 600;
+    const GLfloat dt = 1.0f / 120.0f;
+    Game prototype(800, 600);
+    prototype.Init();
+    // BatchedBreakout plays without multi-ball
+    prototype.MultiBall = GL_FALSE;
+    if (prototype.Levels.empty() || prototype.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    std::vector<GameLevel> levels = prototype.Levels;
+    // the key presses a world's action stands for
+    auto actionOf = [](const Game& game) {
+        return static_cast<GLubyte>((game.Keys[GLFW_KEY_A] ? ACTION_LEFT : 0) | (game.Keys[GLFW_KEY_D] ? ACTION_RIGHT : 0)
+            | (game.Keys[GLFW_KEY_SPACE] ? ACTION_FIRE : 0));
+    };
+    auto randomKeys = [](Game& game, Random& rng) {
+        GLuint action = rng.Below(8);
+        game.SetKey(GLFW_KEY_A, (action & ACTION_LEFT) != 0);
+        game.SetKey(GLFW_KEY_D, (action & ACTION_RIGHT) != 0);
+        game.SetKey(GLFW_KEY_SPACE, (action & ACTION_FIRE) != 0);
+    };
+
+    std::cout << std::setw(6) << "level" << std::setw(10) << "cleared" << std::setw(8) << "lost"
+        << std::setw(12) << "mismatches" << std::setw(10) << "dropped" << std::endl;
+    GLboolean mismatch = GL_FALSE;
+    for (GLuint l = 0; l < levels.size(); ++l)
+    {
+        Game levelPrototype = prototype;
+        levelPrototype.Levels.assign(1, levels[l]);
+        BatchedBreakout batch(levels[l], worlds, 800, 600, 1000 * (l + 1));
+        std::vector<Game> games(worlds, levelPrototype);
+        std::vector<AutoPlayer> players(worlds);
+        std::vector<Random> inputs(worlds);
+        auto restart = [&](GLuint w) {
+            games[w] = levelPrototype;
+            games[w].State = GAME_ACTIVE;
+            games[w].ResetPlayer();
+            games[w].SetSeed(batch.Seeds[w]);
+            players[w] = AutoPlayer(0);
+        };
+        for (GLuint w = 0; w < worlds; ++w)
+        {
+            restart(w);
+            inputs[w].Seed(w);
+        }
+        std::vector<GLubyte> actions(worlds);
+        GLuint cleared = 0, lost = 0, mismatches = 0;
+        unsigned long long dropped = 0;
+        for (GLuint t = 0; t < ticks; ++t)
+        {
+            for (GLuint w = 0; w < worlds; ++w)
+            {
+                if (w % 2 == 0)
+                    players[w].Update(games[w], dt);
+                else if (t % 8 == 0)
+                    randomKeys(games[w], inputs[w]);
+                actions[w] = actionOf(games[w]);
+                games[w].Tick(dt);
+            }
+            batch.Step(actions.data(), dt);
+            for (GLuint w = 0; w < worlds; ++w)
+            {
+                GLubyte expected = EPISODE_RUNNING;
+                GLfloat reward = 0.0f;
+                for (const GameEvent& event : games[w].Events)
+                {
+                    reward += event.Type == EVENT_BRICK_DESTROYED;
+                    if (event.Type == EVENT_LIFE_LOST && event.Index == 0)
+                        expected = EPISODE_LOST;
+                    else if (event.Type == EVENT_LEVEL_COMPLETED)
+                        expected = EPISODE_CLEARED;
+                }
+                GLboolean same = batch.Dones[w] == expected && batch.Rewards[w] == reward
+                    && (expected != EPISODE_RUNNING || batch.Checksum(w) == games[w].Checksum());
+                if (!same)
+                {
+                    if (mismatches == 0)
+                        std::cout << "level " << l + 1 << " world " << w << " differs at tick " << t << std::endl;
+                    ++mismatches;
+                }
+                cleared += expected == EPISODE_CLEARED;
+                lost += expected == EPISODE_LOST;
+                // a world that differs is restarted too, so one mismatch is reported once
+                if (expected != EPISODE_RUNNING || !same)
+                {
+                    if (!same)
+                        batch.Reset(w, batch.Seeds[w] + worlds);
+                    restart(w);
+                }
+            }
+        }
+        for (GLuint count : batch.PowerUpsDropped)
+            dropped += count;
+        std::cout << std::setw(6) << l + 1 << std::setw(10) << cleared << std::setw(8) << lost
+            << std::setw(12) << mismatches << std::setw(10) << dropped << std::endl;
+        if (mismatches)
+            mismatch = GL_TRUE;
+    }
+
+    // random play, the same actions for both; actions are drawn up front
+    const GLuint patterns = 64;
+    Random rng(7);
+    std::vector<GLubyte> actions(patterns * benchWorlds);
+    for (GLubyte& action : actions)
+        action = static_cast<GLubyte>(rng.Below(8));
+    Game levelPrototype = prototype;
+    levelPrototype.Levels.assign(1, levels[0]);
+    levelPrototype.State = GAME_ACTIVE;
+    levelPrototype.ResetPlayer();
+    std::vector<Game> games(benchWorlds, levelPrototype);
+    auto start = std::chrono::steady_clock::now();
+    for (GLuint t = 0; t < benchTicks; ++t)
+    {
+        const GLubyte* step = &actions[(t / 8 % patterns) * benchWorlds];
+        for (GLuint w = 0; w < benchWorlds; ++w)
+        {
+            Game& game = games[w];
+            game.SetKey(GLFW_KEY_A, (step[w] & ACTION_LEFT) != 0);
+            game.SetKey(GLFW_KEY_D, (step[w] & ACTION_RIGHT) != 0);
+            game.SetKey(GLFW_KEY_SPACE, (step[w] & ACTION_FIRE) != 0);
+            game.Tick(dt);
+            if (game.State != GAME_ACTIVE)
+            {
+                game = levelPrototype;
+                game.SetSeed(w + t);
+            }
+        }
+    }
+    std::chrono::duration<double> gameSeconds = std::chrono::steady_clock::now() - start;
+    GLdouble gameRate = static_cast<GLdouble>(benchWorlds) * benchTicks / gameSeconds.count();
+
+    GLuint cores = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<GLuint> threadCounts;
+    for (GLuint threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+    std::cout << std::endl << std::setw(20) << "engine" << std::setw(16) << "steps/second" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::setw(20) << "Game::Tick" << std::setw(16) << std::fixed << std::setprecision(0) << gameRate
+        << std::setw(9) << std::setprecision(2) << 1.0 << "x" << std::endl;
+    for (GLuint threads : threadCounts)
+    {
+        JobSystem jobs(threads - 1);
+        BatchedBreakout batch(levels[0], benchWorlds, 800, 600, 1);
+        batch.Jobs = threads > 1 ? &jobs : nullptr;
+        start = std::chrono::steady_clock::now();
+        for (GLuint t = 0; t < benchTicks; ++t)
+            batch.Step(&actions[(t / 8 % patterns) * benchWorlds], dt);
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        GLdouble rate = static_cast<GLdouble>(benchWorlds) * benchTicks / seconds.count();
+        std::cout << std::setw(12) << "batched, " << std::setw(2) << threads << (threads > 1 ? " threads" : " thread ")
+            << std::setw(16) << std::setprecision(0) << rate << std::setw(9) << std::setprecision(2) << rate / gameRate << "x" << std::endl;
+    }
+    if (mismatch)
+        std::cout << "ERROR::BENCH: a batched world does not step like its Game" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+int BenchRaster()
+{
+    const GLuint ticks = 20000, states = 64, frames = 20000;
+    const GLfloat dt = 1.0f / 120.0f;
+    Game prototype(800, 600);
+    prototype.Init();
+    // BatchedBreakout plays without multi-ball
+    prototype.MultiBall = GL_FALSE;
+    if (prototype.Levels.empty() || prototype.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    SoftwareRasterizer rgb(84, 84, 800, 600, PIXELS_RGB), gray(84, 84, 800, 600, PIXELS_GRAY);
+    if (!rgb.Load() || !gray.Load())
+    {
+        std::cout << "ERROR::BENCH: Failed to load textures (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    SoftwareRasterizer* rasterizers[] = { &rgb, &gray };
+    std::vector<GLubyte> expected(84 * 84 * 3), frame(84 * 84 * 3);
+    // every kernel combination must draw the frame the scalar code draws
+    auto sameFrames = [&](const Game& game, const BatchedBreakout& batch) {
+        for (SoftwareRasterizer* rasterizer : rasterizers)
+        {
+            rasterizer->UseSimd = GL_FALSE;
+            rasterizer->Render(game, expected.data());
+            rasterizer->UseSimd = SoftwareRasterizer::SimdAvailable();
+            rasterizer->Render(game, frame.data());
+            if (frame != expected)
+                return GL_FALSE;
+            rasterizer->Render(batch, 0, frame.data());
+            if (frame != expected)
+                return GL_FALSE;
+        }
+        return GL_TRUE;
+    };
+
+    // one AutoPlayer game and the batched world given its keys; a copy of
+    // every 16th tick is drawn confused as well
+    Game levelPrototype = prototype;
+    levelPrototype.Levels.assign(1, prototype.Levels[0]);
+    levelPrototype.State = GAME_ACTIVE;
+    levelPrototype.ResetPlayer();
+    BatchedBreakout batch(prototype.Levels[0], 1, 800, 600, 1);
+    Game game = levelPrototype;
+    game.SetSeed(batch.Seeds[0]);
+    AutoPlayer player(0);
+    std::vector<Game> samples;
+    GLuint compared = 0, mismatches = 0;
+    for (GLuint t = 0; t < ticks; ++t)
+    {
+        player.Update(game, dt);
+        GLubyte action = static_cast<GLubyte>((game.Keys[GLFW_KEY_A] ? ACTION_LEFT : 0)
+            | (game.Keys[GLFW_KEY_D] ? ACTION_RIGHT : 0) | (game.Keys[GLFW_KEY_SPACE] ? ACTION_FIRE : 0));
+        game.Tick(dt);
+        batch.Step(&action, dt);
+        if (batch.Dones[0] != EPISODE_RUNNING)
+        {
+            game = levelPrototype;
+            game.SetSeed(batch.Seeds[0]);
+            player = AutoPlayer(0);
+            continue;
+        }
+        ++compared;
+        mismatches += !sameFrames(game, batch);
+        if (t % 16 == 0)
+        {
+            Game confused = game;
+            BatchedBreakout confusedBatch = batch;
+            confused.Confuse = confusedBatch.Confuse[0] = GL_TRUE;
+            ++compared;
+            mismatches += !sameFrames(confused, confusedBatch);
+        }
+        if (t % (ticks / states) == 0)
+            samples.push_back(game);
+    }
+    std::cout << std::setw(10) << "frames" << std::setw(12) << "mismatches" << std::endl;
+    std::cout << std::setw(10) << compared << std::setw(12) << mismatches << std::endl;
+
+    // drawing speed over the sampled states, half of them confused
+    for (GLuint i = 0; i < samples.size(); i += 2)
+        samples[i].Confuse = GL_TRUE;
+    std::cout << std::endl << std::setw(10) << "size" << std::setw(8) << "pixels" << std::setw(10) << "kernels"
+        << std::setw(16) << "frames/second" << std::endl;
+    const GLuint sizes[][2] = { { 84, 84 }, { 160, 120 } };
+    for (const GLuint* size : sizes)
+        for (PixelFormat format : { PIXELS_RGB, PIXELS_GRAY })
+            for (GLboolean simd : { GL_FALSE, GL_TRUE })
+            {
+                if (simd && !SoftwareRasterizer::SimdAvailable())
+                    continue;
+                SoftwareRasterizer rasterizer(size[0], size[1], 800, 600, format);
+                rasterizer.Load();
+                rasterizer.UseSimd = simd;
+                std::vector<GLubyte> out(size[0] * size[1] * format);
+                auto start = std::chrono::steady_clock::now();
+                for (GLuint f = 0; f < frames; ++f)
+                    rasterizer.Render(samples[f % samples.size()], out.data());
+                std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+                std::cout << std::setw(6) << size[0] << "x" << std::setw(3) << size[1]
+                    << std::setw(8) << (format == PIXELS_RGB ? "rgb" : "gray") << std::setw(10) << (simd ? "sse2" : "scalar")
+                    << std::setw(16) << std::fixed << std::setprecision(0) << frames / seconds.count() << std::endl;
+            }
+    if (mismatches)
+        std::cout << "ERROR::BENCH: the rasterizer draws a frame differently" << std::endl;
+    return mismatches ? 2 : 0;
+}
+
+// The pair loops sweep-and-prune replaced: every dynamic body against
+// every kinematic body, then against every later dynamic body
+void FindAllContacts(const PhysicsWorld& world, std::vector<Contact>& contacts)
+{
+    contacts.clear();
+    auto touching = [](const PhysicsBody& a, const PhysicsBody& b) -> GLboolean {
+        if (!(a.Mask & b.Layer) && !(b.Mask & a.Layer))
+            return GL_FALSE;
+        if (a.Radius > 0.0f && b.Radius > 0.0f)
+            return Length((a.Position + a.Radius) - (b.Position + b.Radius)) <= a.Radius + b.Radius;
+        if (a.Radius > 0.0f)
+            return OverlapCircleAABB(a.Position + a.Radius, a.Radius, b.Position, b.Size);
+        if (b.Radius > 0.0f)
+            return OverlapCircleAABB(b.Position + b.Radius, b.Radius, a.Position, a.Size);
+        return OverlapAABB(a.Position, a.Size, b.Position, b.Size);
+    };
+    for (GLuint i = 0; i < world.Dynamics.size(); ++i)
+    {
+        for (GLuint k = 0; k < world.Kinematics.size(); ++k)
+            if (touching(world.Dynamics[i], world.Kinematics[k]))
+                contacts.push_back({ i, k, CONTACT_KINEMATIC });
+        for (GLuint j = i + 1; j < world.Dynamics.size(); ++j)
+            if (touching(world.Dynamics[i], world.Dynamics[j]))
+                contacts.push_back({ i, j, CONTACT_DYNAMIC });
+    }
+}
+
+// Balls and falling powerups in a field that grows with their number
+// (about 100 bodies per 800x600 screen) and a paddle, moving a 120 Hz
+// step per frame. Balls collide with balls and the paddle, powerups
+// only with the paddle, as in the game.
+int BenchPhysics()
+{
+    const GLuint bodyCounts[] = { 100, 1000, 10000 };
+    const GLuint frames = 200;
+    const GLfloat dt = 1.0f / 120.0f;
+    std::cout << std::setw(8) << "bodies" << std::setw(10) << "contacts" << std::setw(20) << "all pairs us/frame"
+        << std::setw(14) << "SAP us/frame" << std::setw(10) << "speedup" << std::endl;
+    GLboolean mismatch = GL_FALSE;
+    for (GLuint count : bodyCounts)
+    {
+        Random rng(count);
+        glm::vec2 field = glm::vec2(800.0f, 600.0f) * std::sqrt(count / 100.0f);
+        std::vector<glm::vec2> positions(count), velocities(count);
+        for (GLuint i = 0; i < count; ++i)
+        {
+            positions[i] = glm::vec2(rng.Float(), rng.Float()) * field;
+            velocities[i] = i % 2 ? VELOCITY : glm::vec2(rng.Float() * 2.0f - 1.0f, rng.Float() * 2.0f - 1.0f) * 350.0f;
+        }
+        auto build = [&](PhysicsWorld& world, GLuint frame) {
+            world.Reset(nullptr, field.x, field.y);
+            world.AddKinematic(glm::vec2(field.x / 2 - PLAYER_SIZE.x / 2, field.y - PLAYER_SIZE.y), PLAYER_SIZE, LAYER_PADDLE, 0);
+            for (GLuint i = 0; i < count; ++i)
+            {
+                glm::vec2 position = positions[i] + velocities[i] * (dt * frame);
+                position = glm::mod(position, field);
+                if (i % 2)
+                    world.AddBox(position, SIZE, LAYER_POWERUP, LAYER_PADDLE, i);
+                else
+                    world.AddCircle(position, BALL_RADIUS, LAYER_BALL, LAYER_BALL | LAYER_PADDLE, i);
+            }
+        };
+        // the pair loops get a fixed budget of pair tests instead of frames
+        GLuint linearFrames = std::max(std::min(frames, 100000000u / (count * count)), 1u);
+        PhysicsWorld world;
+        std::vector<std::vector<Contact>> expected(linearFrames);
+        std::chrono::duration<double, std::micro> linear(0), sap(0);
+        for (GLuint f = 0; f < linearFrames; ++f)
+        {
+            build(world, f);
+            auto start = std::chrono::steady_clock::now();
+            FindAllContacts(world, expected[f]);
+            linear += std::chrono::steady_clock::now() - start;
+        }
+        size_t contacts = 0;
+        for (GLuint f = 0; f < frames; ++f)
+        {
+            build(world, f);
+            auto start = std::chrono::steady_clock::now();
+            world.FindContacts();
+            sap += std::chrono::steady_clock::now() - start;
+            contacts += world.Contacts.size();
+            if (f < linearFrames && world.Contacts.size() != expected[f].size())
+                mismatch = GL_TRUE;
+            for (GLuint c = 0; f < linearFrames && c < world.Contacts.size() && c < expected[f].size(); ++c)
+                if (world.Contacts[c].Body != expected[f][c].Body || world.Contacts[c].Other != expected[f][c].Other
+                    || world.Contacts[c].Kind != expected[f][c].Kind)
+                    mismatch = GL_TRUE;
+        }
+        GLdouble linearUs = linear.count() / linearFrames, sapUs = sap.count() / frames;
+        std::cout << std::setw(8) << count << std::setw(10) << contacts / frames << std::setw(20) << std::fixed
+            << std::setprecision(1) << linearUs << std::setw(14) << sapUs << std::setw(9) << linearUs / sapUs << "x" << std::endl;
+    }
+    if (mismatch)
+        std::cout << "ERROR::BENCH: sweep-and-prune and the pair loops found different contacts" << std::endl;
+    return mismatch ? 2 : 0;
+}
+
+// Runs one number type's collision kernels over the samples (center,
+// motion, box corner and box size in turn) and stores ns per call of
+// SweepCircleAABB, OverlapCircleAABB and a bounce. Returns a count of
+// the results, so none of the calls can be left out.
+template <typename V>
+GLuint TimeKernels(const std::vector<glm::vec2>& samples, GLfloat radius, GLdouble ns[3])
+{
+    typedef typename V::value_type S;
+    GLuint count = static_cast<GLuint>(samples.size() / 4), sum = 0;
+    std::vector<V> values(samples.size());
+    for (GLuint i = 0; i < samples.size(); ++i)
+        values[i] = V(samples[i]);
+    S r(radius);
+    const V* v = values.data();
+    auto start = std::chrono::steady_clock::now();
+    for (GLuint i = 0; i < count; ++i, v += 4)
+    {
+        BasicSweepHit<V> hit;
+        sum += SweepCircleAABB(v[0], r, v[1], v[2], v[2] + v[3], hit);
+    }
+    std::chrono::duration<double, std::nano> sweep = std::chrono::steady_clock::now() - start;
+    v = values.data();
+    start = std::chrono::steady_clock::now();
+    for (GLuint i = 0; i < count; ++i, v += 4)
+        sum += OverlapCircleAABB(v[0], r, v[2], v[3]);
+    std::chrono::duration<double, std::nano> overlap = std::chrono::steady_clock::now() - start;
+    // off a wall or a brick, then turned and brought back to speed as by the paddle
+    v = values.data();
+    start = std::chrono::steady_clock::now();
+    for (GLuint i = 0; i < count; ++i, v += 4)
+    {
+        V velocity = v[1];
+        Reflect(velocity, i % 2 ? V(S(1.0f), S(0.0f)) : V(S(0.0f), S(-1.0f)));
+        velocity = Normalize(velocity + v[3]) * Length(v[1]);
+        sum += velocity.x > S(0.0f);
+    }
+    std::chrono::duration<double, std::nano> bounce = std::chrono::steady_clock::now() - start;
+    ns[0] = sweep.count() / count;
+    ns[1] = overlap.count() / count;
+    ns[2] = bounce.count() / count;
+    return sum;
+}
+
+// Float against fixed-point physics. Part one times both instantiations
+// of the collision kernels on the same million random balls and boxes,
+// whichever number type this build uses. Part two plays every level
+// with scripted random keys and folds each tick's checksum into one
+// digest: a fixed-point build must reproduce FIXED_DIGEST bit for bit
+// with any compiler and flags (fast math, FMA), a float build only
+// prints its digest and speed for comparison.
+int BenchFixed()
+{
+    const GLuint samples = 1000000, ticks = 30000;
+    const GLfloat dt = 1.0f / 120.0f;
+    Random rng(19);
+    std::vector<glm::vec2> values(samples * 4);
+    for (GLuint i = 0; i < samples; ++i)
+    {
+        glm::vec2 center(rng.Float() * 800.0f, rng.Float() * 600.0f);
+        values[i * 4] = center;
+        values[i * 4 + 1] = glm::vec2(rng.Float() * 2.0f - 1.0f, rng.Float() * 2.0f - 1.0f) * 40.0f;
+        values[i * 4 + 2] = center + glm::vec2(rng.Float() * 120.0f - 100.0f, rng.Float() * 80.0f - 60.0f);
+        values[i * 4 + 3] = glm::vec2(20.0f + rng.Float() * 60.0f, 10.0f + rng.Float() * 30.0f);
+    }
+    GLdouble floatNs[3], fixedNs[3];
+    GLuint floatSum = TimeKernels<glm::vec2>(values, BALL_RADIUS, floatNs);
+    GLuint fixedSum = TimeKernels<FixedVec2>(values, BALL_RADIUS, fixedNs);
+    const GLchar* kernels[3] = { "SweepCircleAABB", "OverlapCircleAABB", "bounce" };
+    std::cout << std::setw(18) << "kernel" << std::setw(12) << "float ns" << std::setw(12) << "fixed ns"
+        << std::setw(8) << "cost" << std::endl;
+    for (GLuint k = 0; k < 3; ++k)
+        std::cout << std::setw(18) << kernels[k] << std::setw(12) << std::fixed << std::setprecision(1) << floatNs[k]
+            << std::setw(12) << fixedNs[k] << std::setw(7) << fixedNs[k] / floatNs[k] << "x" << std::endl;
+    // the two types round differently, so only roughly the same balls hit
+    std::cout << "results:  " << floatSum << " float, " << fixedSum << " fixed" << std::endl << std::endl;
+
+    Game prototype(800, 600);
+    prototype.Init();
+    if (prototype.Levels.empty() || prototype.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+#ifdef BREAKOUT_FIXED_POINT
+    const GLchar* build = "fixed";
+#else
+    const GLchar* build = "float";
+#endif
+    std::uint32_t digest = 2166136261u;
+    std::chrono::duration<double> seconds(0);
+    for (GLuint l = 0; l < prototype.Levels.size(); ++l)
+    {
+        Game game = prototype;
+        game.Level = l;
+        game.State = GAME_ACTIVE;
+        game.ResetPlayer();
+        game.SetSeed(l + 1);
+        Random keys(l);
+        auto start = std::chrono::steady_clock::now();
+        for (GLuint t = 0; t < ticks; ++t)
+        {
+            if (t % 8 == 0)
+            {
+                GLuint action = keys.Below(8);
+                game.SetKey(GLFW_KEY_A, (action & ACTION_LEFT) != 0);
+                game.SetKey(GLFW_KEY_D, (action & ACTION_RIGHT) != 0);
+                game.SetKey(GLFW_KEY_SPACE, (action & ACTION_FIRE) != 0);
+            }
+            // a won or lost game has reset its level; play on
+            if (game.State != GAME_ACTIVE)
+            {
+                game.State = GAME_ACTIVE;
+                game.Level = l;
+            }
+            game.Tick(dt);
+            HashValue(digest, game.Checksum());
+        }
+        seconds += std::chrono::steady_clock::now() - start;
+    }
+    GLuint total = ticks * static_cast<GLuint>(prototype.Levels.size());
+    std::cout << std::setw(8) << "physics" << std::setw(10) << "ticks" << std::setw(16) << "ticks/second"
+        << std::setw(12) << "digest" << std::endl;
+    std::cout << std::setw(8) << build << std::setw(10) << total << std::setw(16) << std::setprecision(0)
+        << total / seconds.count() << std::setw(12) << std::hex << digest << std::dec << std::endl;
+#ifdef BREAKOUT_FIXED_POINT
+    const std::uint32_t FIXED_DIGEST = 0x23ce8459u;
+    if (digest != FIXED_DIGEST)
+    {
+        std::cout << "ERROR::BENCH: fixed-point ticks differ from the reference digest " << std::hex << FIXED_DIGEST
+            << std::dec << std::endl;
+        return 2;
+    }
+#endif
+    return 0;
+}
+
+// Ball pools as dense as the stress scenario's, 1k to 10k balls of
+// STRESS_BALL_RADIUS in a field that grows with their number. Part one
+// finds the touching pairs with the SpatialHash BallPool::Collide uses
+// and by testing every pair; both must find the same pairs. Part two
+// plays the stress scenario (STRESS_BALLS balls kept in the air while
+// the AutoPlayer follows the main ball; the swarm clears a level within
+// a second, and play goes on with the level reset) and times a tick,
+// capturing its RenderSnapshot and drawing it with the SoftwareRasterizer.
+// The game has a JobSystem, as in the windowed game. Each tick's checksum is folded into a digest, which a fixed-point
+// build must reproduce as STRESS_DIGEST like BenchFixed's.
+int BenchMultiBall()
+{
+    const GLuint ballCounts[] = { 1000, 2000, 10000 };
+    const GLuint rounds = 20, ticks = 600;
+    const GLfloat dt = 1.0f / 120.0f;
+    const GLfloat diameter = STRESS_BALL_RADIUS * 2.0f;
+    std::cout << std::setw(8) << "balls" << std::setw(8) << "pairs" << std::setw(20) << "all pairs us/round"
+        << std::setw(14) << "hash us/round" << std::setw(10) << "speedup" << std::endl;
+    GLboolean mismatch = GL_FALSE;
+    SpatialHash grid;
+    std::vector<std::uint64_t> expected, found;
+    for (GLuint count : ballCounts)
+    {
+        Random rng(count);
+        // a quarter of the balls' area covered, as in the lower half of the stress scenario
+        GLfloat side = std::sqrt(count * diameter * diameter * 4.0f);
+        std::vector<GLfloat> x(count), y(count);
+        std::chrono::duration<double, std::micro> linear(0), hashed(0);
+        size_t pairs = 0;
+        for (GLuint r = 0; r < rounds; ++r)
+        {
+            for (GLuint i = 0; i < count; ++i)
+            {
+                x[i] = rng.Float() * side;
+                y[i] = rng.Float() * side;
+            }
+            auto touching = [&](GLuint i, GLuint j) {
+                GLfloat dx = x[j] - x[i], dy = y[j] - y[i];
+                return dx * dx + dy * dy <= diameter * diameter;
+            };
+            auto start = std::chrono::steady_clock::now();
+            expected.clear();
+            for (GLuint i = 0; i < count; ++i)
+                for (GLuint j = i + 1; j < count; ++j)
+                    if (touching(i, j))
+                        expected.push_back(static_cast<std::uint64_t>(i) << 32 | j);
+            linear += std::chrono::steady_clock::now() - start;
+            start = std::chrono::steady_clock::now();
+            found.clear();
+            grid.Build(x.data(), y.data(), count, diameter + 1.0f);
+            for (GLuint i = 0; i < count; ++i)
+                grid.ForEachNear(x[i], y[i], [&](GLuint j) {
+                    if (j > i && touching(i, j))
+                        found.push_back(static_cast<std::uint64_t>(i) << 32 | j);
+                });
+            std::sort(found.begin(), found.end());
+            hashed += std::chrono::steady_clock::now() - start;
+            pairs += expected.size();
+            if (found != expected)
+                mismatch = GL_TRUE;
+        }
+        GLdouble linearUs = linear.count() / rounds, hashUs = hashed.count() / rounds;
+        std::cout << std::setw(8) << count << std::setw(8) << pairs / rounds << std::setw(20) << std::fixed
+            << std::setprecision(1) << linearUs << std::setw(14) << hashUs << std::setw(9) << linearUs / hashUs << "x" << std::endl;
+    }
+    if (mismatch)
+    {
+        std::cout << "ERROR::BENCH: the spatial hash and the pair loop found different pairs" << std::endl;
+        return 2;
+    }
+    // the main ball is larger than the stress balls: a ball near its center
+    // touches it, one just beyond the sum of the radii does not
+    BallObject main(glm::vec2(400.0f, 300.0f), 12.5f, glm::vec2(0.0f, -100.0f));
+    glm::vec2 center = main.Position + main.Radius - STRESS_BALL_RADIUS;
+    GLfloat apart = main.Radius + STRESS_BALL_RADIUS + 0.5f;
+    BallPool inside(STRESS_BALL_RADIUS), beyond(STRESS_BALL_RADIUS);
+    inside.Add(center + glm::vec2(0.0f, 3.0f), glm::vec2(0.0f, -100.0f));
+    beyond.Add(center + glm::vec2(apart, 0.0f), glm::vec2(-100.0f, 0.0f));
+    BallObject other = main;
+    if (inside.Collide(&other) != 1 || beyond.Collide(&main) != 0 || beyond.X[0] != center.x + apart)
+    {
+        std::cout << "ERROR::BENCH: balls of different radii collide at the wrong distance" << std::endl;
+        return 2;
+    }
+
+    Game game(800, 600);
+    game.Init();
+    if (game.Levels.empty() || game.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    SoftwareRasterizer rasterizer(84, 84, 800, 600, PIXELS_RGB);
+    if (!rasterizer.Load())
+    {
+        std::cout << "ERROR::BENCH: Failed to load textures (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    game.Balls.Radius = STRESS_BALL_RADIUS;
+    game.StressBalls = STRESS_BALLS;
+    game.State = GAME_ACTIVE;
+    game.ResetPlayer();
+    // the ball pair search runs on every core; the digest must not notice
+    JobSystem jobs;
+    game.Jobs = &jobs;
+    AutoPlayer player;
+    RenderSnapshot snapshot;
+    std::vector<GLubyte> frame(84 * 84 * 3);
+    std::chrono::duration<double, std::milli> tick(0), capture(0), raster(0);
+    unsigned long long balls = 0, events = 0, dropped = 0, cleared = 0;
+    std::uint32_t digest = 2166136261u;
+    for (GLuint t = 0; t < ticks; ++t)
+    {
+        if (game.State != GAME_ACTIVE)
+        {
+            cleared += game.State == GAME_WIN;
+            game.State = GAME_ACTIVE;
+        }
+        player.Update(game, dt);
+        auto start = std::chrono::steady_clock::now();
+        game.Tick(dt);
+        auto ticked = std::chrono::steady_clock::now();
+        snapshot.Capture(game);
+        auto captured = std::chrono::steady_clock::now();
+        rasterizer.Render(game, frame.data());
+        auto drawn = std::chrono::steady_clock::now();
+        tick += ticked - start;
+        capture += captured - ticked;
+        raster += drawn - captured;
+        balls += game.Balls.Size();
+        HashValue(digest, game.Checksum());
+        events += game.Events.Size() + game.Events.Dropped;
+        dropped += game.Events.Dropped;
+    }
+    // the event queue has room for a normal tick, not for this many balls
+    std::cout << std::endl << "stress:   " << balls / ticks << " balls on average, " << events / ticks
+        << " events per tick (" << dropped / ticks << " dropped), " << cleared << " levels cleared" << std::endl;
+    std::cout << std::setprecision(3) << "tick:     " << tick.count() / ticks << " ms" << std::endl;
+    std::cout << "snapshot: " << capture.count() / ticks << " ms" << std::endl;
+    std::cout << "raster:   " << raster.count() / ticks << " ms (84x84 rgb)" << std::endl;
+    std::cout << "digest:   " << std::hex << digest << std::dec << std::endl;
+#ifdef BREAKOUT_FIXED_POINT
+    const std::uint32_t STRESS_DIGEST = 0x7ff23a87u;
+    if (digest != STRESS_DIGEST)
+    {
+        std::cout << "ERROR::BENCH: fixed-point stress ticks differ from the reference digest " << std::hex << STRESS_DIGEST
+            << std::dec << std::endl;
+        return 2;
+    }
+#endif
+    return 0;
+}
+
+// Records 2400 ticks of an AutoPlayer game and plays them back from the
+// file. Every truncated copy of the file, and headers whose tick or
+// event counts are larger than the file, must be rejected by
+// ReplayPlayer::Load instead of allocating what the header claims.
+int BenchReplay()
+{
+    const GLuint ticks = 2400;
+    const GLfloat dt = 1.0f / 120.0f;
+    const GLchar* file = "bench_replay.tmp";
+    Game game(800, 600);
+    game.Init();
+    if (game.Levels.empty() || game.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::BENCH: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    Game initial = game;
+    game.SetSeed(5);
+    ReplayRecorder recorder(5, dt);
+    AutoPlayer player(0);
+    for (GLuint t = 0; t < ticks; ++t)
+    {
+        player.Update(game, dt, &recorder);
+        game.Tick(dt);
+        recorder.EndTick(game);
+    }
+    if (!recorder.Save(file))
+        return 1;
+    std::ifstream stream(file, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    stream.close();
+    auto write = [file](const std::vector<char>& bytes, size_t size) {
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), size);
+    };
+    GLboolean mismatch = GL_FALSE;
+
+    // the intact file loads and plays back to the same checksums
+    ReplayPlayer replay;
+    auto start = std::chrono::steady_clock::now();
+    GLboolean loaded = replay.Load(file);
+    std::chrono::duration<double, std::micro> load = std::chrono::steady_clock::now() - start;
+    if (!loaded || replay.Ticks != ticks)
+        mismatch = GL_TRUE;
+    else
+    {
+        Game replayed = initial;
+        replayed.SetSeed(replay.Seed);
+        while (!replay.Done())
+        {
+            replay.BeginTick(replayed);
+            replayed.Tick(replay.Dt);
+            if (!replay.EndTick(replayed))
+            {
+                mismatch = GL_TRUE;
+                break;
+            }
+        }
+    }
+
+    // cut the file short at 16 points from the magic to the last checksum
+    GLuint rejected = 0, attempts = 0;
+    std::vector<size_t> sizes;
+    for (GLuint i = 0; i < 16; ++i)
+        sizes.push_back(bytes.size() * i / 16);
+    sizes.push_back(bytes.size() - 1);
+    for (size_t size : sizes)
+    {
+        write(bytes, size);
+        ++attempts;
+        rejected += !ReplayPlayer().Load(file);
+    }
+    // keep the magic, version, seed and dt (seed 5 is a one byte varint)
+    // and claim 2^40 ticks, 2^40 events or both over the real payload
+    auto varint = [](std::vector<char>& out, std::uint64_t value) {
+        for (; value >= 0x80; value >>= 7)
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        out.push_back(static_cast<char>(value));
+    };
+    const std::uint64_t huge = 1ull << 40;
+    const std::uint64_t counts[3][2] = { { huge, 0 }, { 0, huge }, { huge, huge } };
+    for (const std::uint64_t* count : counts)
+    {
+        std::vector<char> crafted(bytes.begin(), bytes.begin() + 10);
+        varint(crafted, count[0]);
+        varint(crafted, count[1]);
+        crafted.insert(crafted.end(), bytes.begin() + 10, bytes.end());
+        write(crafted, crafted.size());
+        ++attempts;
+        rejected += !ReplayPlayer().Load(file);
+    }
+    std::remove(file);
+    if (rejected != attempts)
+        mismatch = GL_TRUE;
+
+    std::cout << ticks << " ticks in " << bytes.size() << " bytes, loaded in "
+        << std::fixed << std::setprecision(1) << load.count() << " us" << std::endl;
+    std::cout << rejected << "/" << attempts << " truncated or oversized files rejected" << std::endl;
+    if (mismatch)
+        std::cout << "ERROR::BENCH: replay files are not loaded or rejected as expected" << std::endl;
+    return mismatch ? 2 : 0;
+}
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "autoplayer.h"
+#include "env_client.h"
+#include "env_server.h"
+#include "game.h"
+#include "job_system.h"
+#include "level_analyzer.h"
+#include "replay.h"
+#include "sim_bench.h"
+
+// breakout_sim steps the game logic without a window, GL context or
+// audio device. By default it plays a number of games back to back
+// with the AutoPlayer and reports how fast the
+// simulation runs. Game g is seeded with seed + g, so every run is
+// reproducible; --record saves the first game as a replay. With
+// --threads the games are spread over a JobSystem (0 = every core);
+// the totals do not depend on the thread count.
+//
+// With --replay it instead plays a recorded session as fast as
+// possible and reports the first tick whose state checksum differs.
+// --bench runs one of the micro benchmarks in sim_bench.h. --analyze
+// plays --games seeded games of one level file on every core (unless
+// --threads says otherwise) and reports how hard it is, see
+// level_analyzer.h. --serve runs the shared-memory environment server
+// for trainer processes (env_server.h), --client the test client
+// that checks its answers (env_client.h); both play --level.
+//
+// Usage: breakout_sim [--games N] [--ticks N] [--dt seconds] [--level L] [--seed S] [--threads N] [--record file]
+//        breakout_sim --replay file
+//        breakout_sim --bench name
+//        breakout_sim --analyze file [--games N] [--ticks N] [--dt seconds] [--seed S] [--threads N]
+//        breakout_sim --serve name [--clients N] [--worlds N] [--level L] [--dt seconds] [--threads N]
+//        breakout_sim --client name [--ticks N] [--seed S]
+
+// The Width of the playfield
+const GLuint SCREEN_WIDTH = 800;
+// The height of the playfield
+const GLuint SCREEN_HEIGHT = 600;
+
+// Counts the gameplay events of every tick
+class EventStats
+{
+public:
+    unsigned long long Counts[EVENT_LEVEL_COMPLETED + 1];
+    unsigned long long Dropped;
+
+    EventStats() : Counts(), Dropped(0) { }
+    // Adds the events of the tick game just ran
+    void Count(const Game& game)
+    {
+        for (const GameEvent& event : game.Events)
+            ++this->Counts[event.Type];
+        this->Dropped += game.Events.Dropped;
+    }
+};
+
+// Outcome of one simulated game
+struct GameResult
+{
+    unsigned int Ticks;
+    GameState    State;
+    EventStats   Stats;
+};
+
+// Plays a copy of prototype from the title screen until its level is
+// won or lost, or maxTicks pass. The menus are played like a person
+// would, so replays start from the title screen.
+GameResult PlayGame(const Game& prototype, std::uint64_t seed, GLfloat dt, GLuint level, unsigned int maxTicks, ReplayRecorder* recorder)
+{
+    Game game = prototype;
+    game.SetSeed(seed);
+    AutoPlayer player(level);
+    GameResult result;
+    result.Ticks = 0;
+    GLboolean started = GL_FALSE;
+    while (result.Ticks < maxTicks)
+    {
+        player.Update(game, dt, recorder);
+        game.Tick(dt);
+        ++result.Ticks;
+        result.Stats.Count(game);
+        if (recorder)
+            recorder->EndTick(game);
+        if (game.State == GAME_ACTIVE)
+            started = GL_TRUE;
+        else if (started)
+            break;
+    }
+    result.State = game.State;
+    return result;
+}
+
+// Prints the command line options
+void PrintUsage()
+{
+    std::cout << "Usage: breakout_sim [--games N] [--ticks N] [--dt seconds] [--level L] [--seed S] [--threads N] [--record file]" << std::endl;
+    std::cout << "       breakout_sim --replay file" << std::endl;
+    std::cout << "       breakout_sim --bench name" << std::endl;
+    std::cout << "       breakout_sim --analyze file [--games N] [--ticks N] [--dt seconds] [--seed S] [--threads N]" << std::endl;
+    std::cout << "       breakout_sim --serve name [--clients N] [--worlds N] [--level L] [--dt seconds] [--threads N]" << std::endl;
+    std::cout << "       breakout_sim --client name [--ticks N] [--seed S]" << std::endl;
+}
+
+// Reads a whole number of at least min into value
+GLboolean ParseCount(const GLchar* text, GLuint min, GLuint& value)
+{
+    GLchar* end;
+    errno = 0;
+    long number = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || number < static_cast<long>(min) || number > INT_MAX)
+        return GL_FALSE;
+    value = static_cast<GLuint>(number);
+    return GL_TRUE;
+}
+
+// Reads a positive, finite number of seconds into value
+GLboolean ParseSeconds(const GLchar* text, GLfloat& value)
+{
+    GLchar* end;
+    GLdouble seconds = std::strtod(text, &end);
+    if (end == text || *end != '\0' || !(seconds > 0.0) || !std::isfinite(static_cast<GLfloat>(seconds)))
+        return GL_FALSE;
+    value = static_cast<GLfloat>(seconds);
+    return GL_TRUE;
+}
+
+// Reads an unsigned 64 bit seed into value
+GLboolean ParseSeed(const GLchar* text, std::uint64_t& value)
+{
+    GLchar* end;
+    errno = 0;
+    // strtoull would wrap a minus sign around instead of failing
+    if (text[0] == '-')
+        return GL_FALSE;
+    unsigned long long seed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE)
+        return GL_FALSE;
+    value = seed;
+    return GL_TRUE;
+}
+
+// Plays back a recorded session, returns the process exit code
+int RunReplay(const GLchar* file)
+{
+    ReplayPlayer player;
+    if (!player.Load(file))
+        return 1;
+    Game game(SCREEN_WIDTH, SCREEN_HEIGHT);
+    game.Init();
+    game.SetSeed(player.Seed);
+
+    GLboolean diverged = GL_FALSE;
+    auto start = std::chrono::steady_clock::now();
+    while (!player.Done())
+    {
+        player.BeginTick(game);
+        game.Tick(player.Dt);
+        if (!player.EndTick(game))
+        {
+            diverged = GL_TRUE;
+            break;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (diverged)
+        std::cout << "replay diverged at tick " << player.Tick() - 1 << " of " << player.Ticks << std::endl;
+    else
+        std::cout << "replay matched all " << player.Ticks << " ticks" << std::endl;
+    std::cout << "elapsed:      " << elapsed.count() << " s" << std::endl;
+    std::cout << "ticks/second: " << player.Tick() / elapsed.count() << std::endl;
+    return diverged ? 2 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int games = 1000;
+    unsigned int maxTicks = 60 * 60 * 5;
+    GLfloat dt = 1.0f / 60.0f;
+    GLuint level = 0;
+    std::uint64_t seed = 1;
+    GLint threads = -1;
+    const GLchar* recordFile = nullptr;
+    const GLchar* analyzeFile = nullptr;
+    const GLchar* serveName = nullptr;
+    const GLchar* clientName = nullptr;
+    GLuint clients = 4, worlds = 256;
+    const GLchar* replayFile = nullptr;
+    const GLchar* benchName = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        // every option takes a value; a missing one reads as "" until it is reported below
+        const GLchar* value = i + 1 < argc ? argv[i + 1] : "";
+        GLboolean valid = GL_TRUE;
+        if (std::strcmp(argv[i], "--replay") == 0)
+            replayFile = value;
+        else if (std::strcmp(argv[i], "--bench") == 0)
+            benchName = value;
+        else if (std::strcmp(argv[i], "--analyze") == 0)
+            analyzeFile = value;
+        else if (std::strcmp(argv[i], "--serve") == 0)
+            serveName = value;
+        else if (std::strcmp(argv[i], "--client") == 0)
+            clientName = value;
+        else if (std::strcmp(argv[i], "--clients") == 0)
+            valid = ParseCount(value, 1, clients);
+        else if (std::strcmp(argv[i], "--worlds") == 0)
+            valid = ParseCount(value, 1, worlds);
+        else if (std::strcmp(argv[i], "--record") == 0)
+            recordFile = value;
+        else if (std::strcmp(argv[i], "--games") == 0)
+            valid = ParseCount(value, 1, games);
+        else if (std::strcmp(argv[i], "--ticks") == 0)
+            valid = ParseCount(value, 1, maxTicks);
+        else if (std::strcmp(argv[i], "--dt") == 0)
+            valid = ParseSeconds(value, dt);
+        else if (std::strcmp(argv[i], "--level") == 0)
+            valid = ParseCount(value, 0, level);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            valid = ParseSeed(value, seed);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+        {
+            GLuint count = 0;
+            valid = ParseCount(value, 0, count);
+            threads = static_cast<GLint>(count);
+        }
+        else
+        {
+            std::cout << "ERROR::SIM: Unknown argument " << argv[i] << std::endl;
+            PrintUsage();
+            return 1;
+        }
+        if (++i == argc)
+        {
+            std::cout << "ERROR::SIM: " << argv[i - 1] << " needs a value" << std::endl;
+            PrintUsage();
+            return 1;
+        }
+        if (!valid)
+        {
+            std::cout << "ERROR::SIM: Invalid value " << value << " for " << argv[i - 1] << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+    // each of these runs something else entirely, so at most one may be given
+    const GLchar* modes[] = { replayFile, benchName, analyzeFile, serveName, clientName };
+    if (std::count_if(std::begin(modes), std::end(modes), [](const GLchar* mode) { return mode != nullptr; }) > 1)
+    {
+        std::cout << "ERROR::SIM: --replay, --bench, --analyze, --serve and --client cannot be combined" << std::endl;
+        PrintUsage();
+        return 1;
+    }
+    if (replayFile)
+        return RunReplay(replayFile);
+    if (benchName)
+        return RunBenchmark(benchName);
+    // the analyzer uses every core by default, plain runs a single thread
+    if (analyzeFile)
+        return RunAnalyzer(analyzeFile, SCREEN_WIDTH, SCREEN_HEIGHT, games, maxTicks, dt, seed, threads < 0 ? 0 : threads);
+    // so does the environment server
+    GLuint serverThreads = threads < 0 ? 0 : threads;
+    if (threads < 0)
+        threads = 1;
+
+    // Load the levels once and copy the initial state for every game
+    Game prototype(SCREEN_WIDTH, SCREEN_HEIGHT);
+    prototype.Init();
+    if (prototype.Levels.empty() || prototype.Levels[0].Bricks.empty())
+    {
+        std::cout << "ERROR::SIM: Failed to load levels (run from the Breakout directory)" << std::endl;
+        return 1;
+    }
+    if (level >= prototype.Levels.size())
+    {
+        std::cout << "ERROR::SIM: Invalid value " << level << " for --level, there are "
+            << prototype.Levels.size() << " levels" << std::endl;
+        PrintUsage();
+        return 1;
+    }
+    if (serveName)
+        return RunEnvServer(serveName, prototype, level, clients, worlds, dt, serverThreads);
+    if (clientName)
+        return RunEnvClient(clientName, prototype, maxTicks, seed);
+
+    // every game is an independent job; results are summed in game order afterwards
+    JobSystem jobs(threads == 0 ? 0 : threads - 1);
+    std::vector<GameResult> results(games);
+    auto start = std::chrono::steady_clock::now();
+    jobs.ParallelFor(games, 1, [&](GLuint begin, GLuint end) {
+        for (GLuint g = begin; g < end; ++g)
+        {
+            ReplayRecorder* recorder = g == 0 && recordFile ? new ReplayRecorder(seed + g, dt) : nullptr;
+            results[g] = PlayGame(prototype, seed + g, dt, level, maxTicks, recorder);
+            if (recorder)
+            {
+                recorder->Save(recordFile);
+                delete recorder;
+            }
+        }
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    unsigned long long totalTicks = 0;
+    unsigned int wins = 0, losses = 0;
+    EventStats stats;
+    for (const GameResult& result : results)
+    {
+        totalTicks += result.Ticks;
+        if (result.State == GAME_WIN)
+            ++wins;
+        else if (result.State == GAME_MENU)
+            ++losses;
+        for (GLuint type = 0; type <= EVENT_LEVEL_COMPLETED; ++type)
+            stats.Counts[type] += result.Stats.Counts[type];
+        stats.Dropped += result.Stats.Dropped;
+    }
+
+    std::cout << "games:        " << games << " (" << wins << " won, " << losses << " lost, "
+        << games - wins - losses << " timed out)" << std::endl;
+    std::cout << "ticks:        " << totalTicks << std::endl;
+    std::cout << "events:       " << stats.Counts[EVENT_BRICK_DESTROYED] << " bricks destroyed, "
+        << stats.Counts[EVENT_SOLID_HIT] << " solid hits, " << stats.Counts[EVENT_PADDLE_HIT] << " paddle hits, "
+        << stats.Counts[EVENT_POWERUP_COLLECTED] << " powerups, " << stats.Counts[EVENT_LIFE_LOST] << " lives lost";
+    if (stats.Dropped)
+        std::cout << ", " << stats.Dropped << " dropped";
+    std::cout << std::endl;
+    std::cout << "elapsed:      " << elapsed.count() << " s" << std::endl;
+    std::cout << "ticks/second: " << totalTicks / elapsed.count() << std::endl;
+    std::cout << "games/second: " << games / elapsed.count() << std::endl;
+    std::cout << "threads:      " << jobs.Concurrency() << std::endl;
+    return 0;
+}
\ No newline at end of file
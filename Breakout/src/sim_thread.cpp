@@ -0,0 +1,127 @@
+#include "sim_thread.h"
+
+#include "job_system.h"
+
+
+SimThread::SimThread(Game& game, GLdouble tickRate, GLuint maxTicks, ReplayRecorder* recorder, RewindBuffer* rewind)
+    : game(game), timestep(tickRate, maxTicks), recorder(recorder), rewind(rewind), rewinding(GL_FALSE), held(),
+    start(std::chrono::steady_clock::now()), ticks(0), running(false) { }
+
+SimThread::~SimThread()
+{
+    this->Stop();
+}
+
+void SimThread::Start()
+{
+    if (this->running.load())
+        return;
+    // the window thread can draw the initial state right away
+    this->publish(this->now());
+    this->snapshots.Update();
+    this->running.store(true);
+    this->thread = std::thread(&SimThread::run, this);
+    JobSystem::NameThread(this->thread, "simulation");
+}
+
+void SimThread::Stop()
+{
+    this->running.store(false);
+    if (this->thread.joinable())
+        this->thread.join();
+}
+
+GLboolean SimThread::SendKey(GLuint key, GLboolean pressed)
+{
+    KeyInput input = { key, pressed };
+    return this->input.Push(input);
+}
+
+GLboolean SimThread::PollEvent(GameEvent& event)
+{
+    return this->events.Pop(event);
+}
+
+const RenderSnapshot& SimThread::Snapshot()
+{
+    this->snapshots.Update();
+    return this->snapshots.Front();
+}
+
+GLfloat SimThread::Alpha(const RenderSnapshot& snapshot) const
+{
+    GLdouble alpha = (this->now() - snapshot.Time) / this->timestep.Dt();
+    return static_cast<GLfloat>(alpha < 0.0 ? 0.0 : alpha > 1.0 ? 1.0 : alpha);
+}
+
+GLfloat SimThread::Dt() const
+{
+    return this->timestep.Dt();
+}
+
+void SimThread::run()
+{
+    GLdouble last = this->now();
+    while (this->running.load())
+    {
+        GLdouble current = this->now();
+        GLuint ticks = this->timestep.Advance(current - last);
+        last = current;
+        for (GLuint i = 0; i < ticks; ++i)
+        {
+            // keys pressed since the last tick apply to this one
+            KeyInput key;
+            while (this->input.Pop(key))
+            {
+                // the rewind key never reaches the game
+                if (this->rewind && key.Key == REWIND_KEY)
+                {
+                    this->rewinding = key.Pressed;
+                    continue;
+                }
+                if (key.Key < 1024)
+                    this->held[key.Key] = key.Pressed;
+                this->game.SetKey(key.Key, key.Pressed);
+                if (this->recorder)
+                    this->recorder->Key(key.Key, key.Pressed);
+            }
+            ++this->ticks;
+            if (this->rewinding)
+            {
+                // step back one frame, but keep the keys as the player holds them now
+                if (this->rewind->Frames() > 1)
+                    this->rewind->Rewind(this->game, 1);
+                for (GLuint k = 0; k < 1024; ++k)
+                    if (this->game.Keys[k] != this->held[k])
+                        this->game.SetKey(k, this->held[k]);
+                continue;
+            }
+            this->game.Tick(this->timestep.Dt());
+            if (this->recorder)
+                this->recorder->EndTick(this->game);
+            if (this->rewind)
+                this->rewind->Record(this->game);
+            // if the window thread stalls long enough to fill the queue, drop events
+            for (const GameEvent& event : this->game.Events)
+                this->events.Push(event);
+        }
+        if (ticks > 0)
+            this->publish(current - this->timestep.Alpha() * this->timestep.Dt());
+        // sleep until the next tick is due
+        std::this_thread::sleep_for(std::chrono::duration<GLdouble>((1.0f - this->timestep.Alpha()) * this->timestep.Dt()));
+    }
+}
+
+void SimThread::publish(GLdouble time)
+{
+    RenderSnapshot& snapshot = this->snapshots.Back();
+    snapshot.Capture(this->game);
+    snapshot.Tick = this->ticks;
+    snapshot.Time = time;
+    this->snapshots.Publish();
+}
+
+GLdouble SimThread::now() const
+{
+    return std::chrono::duration<GLdouble>(std::chrono::steady_clock::now() - this->start).count();
+}
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "software_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <stb_image.h>
+
+// SSE2 is part of every x86-64 CPU, so it needs no dispatch
+#if defined(_M_X64) || defined(__SSE2__)
+#define RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+// function declaration
+GLboolean LoadRasterTexture(const std::string& file, RasterTexture& texture);
+void      BlendSpan(std::uint32_t* dst, const std::uint32_t* src, GLuint count, const GLuint tint[3], GLboolean simd);
+void      Confuse(std::uint32_t* pixels, GLuint count, GLboolean simd);
+void      ToGray(const std::uint32_t* pixels, GLuint count, GLubyte* out, GLboolean simd);
+
+
+// File of each powerup texture, in POWERUP_TYPES order
+const GLchar* const POWERUP_FILES[] = { "powerup_speed.png", "powerup_sticky.png", "powerup_passthrough.png",
+    "powerup_increase.png", "powerup_confuse.png", "powerup_chaos.png", "powerup_multiball.png" };
+
+inline std::uint32_t PackPixel(GLuint r, GLuint g, GLuint b, GLuint a)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+inline GLuint Channel(std::uint32_t pixel, GLuint channel)
+{
+    return (pixel >> (channel * 8)) & 0xFF;
+}
+
+// x / 255 rounded, exact for x <= 255 * 255
+inline GLuint Div255(GLuint x)
+{
+    GLuint t = x + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+// Number of pixels of a line of pixels whose centers lie before edge
+inline GLint PixelEdge(GLfloat edge, GLint limit)
+{
+    return std::min(std::max(static_cast<GLint>(std::ceil(edge - 0.5f)), 0), limit);
+}
+
+SoftwareRasterizer::SoftwareRasterizer(GLuint width, GLuint height, GLuint fieldWidth, GLuint fieldHeight,
+    PixelFormat format, GLboolean applyConfuse)
+    : Width(width), Height(height), Format(format), ApplyConfuse(applyConfuse), UseSimd(SimdAvailable()),
+    scale(static_cast<GLfloat>(width) / fieldWidth, static_cast<GLfloat>(height) / fieldHeight),
+    background(width * height, PackPixel(0, 0, 0, 255)), canvas(width * height), columns(width)
+{
+
+}
+
+GLboolean SoftwareRasterizer::SimdAvailable()
+{
+#ifdef RASTER_SSE2
+    return GL_TRUE;
+#else
+    return GL_FALSE;
+#endif
+}
+
+GLboolean SoftwareRasterizer::Load(const std::string& directory)
+{
+    RasterTexture full;
+    GLboolean ok = LoadRasterTexture(directory + "/background.jpg", full)
+        && LoadRasterTexture(directory + "/block.png", this->block)
+        && LoadRasterTexture(directory + "/block_solid.png", this->blockSolid)
+        && LoadRasterTexture(directory + "/paddle.png", this->paddle)
+        && LoadRasterTexture(directory + "/awesomeface.png", this->face);
+    for (GLuint i = 0; ok && i < POWERUP_KINDS; ++i)
+        ok = LoadRasterTexture(directory + "/" + POWERUP_FILES[i], this->powerups[i]);
+    if (!ok)
+        return GL_FALSE;
+    // the background always covers the whole canvas: average each pixel's area once here
+    const RasterImage& image = full.Levels[0];
+    for (GLuint y = 0; y < this->Height; ++y)
+        for (GLuint x = 0; x < this->Width; ++x)
+        {
+            GLuint x0 = x * image.Width / this->Width, x1 = std::max((x + 1) * image.Width / this->Width, x0 + 1);
+            GLuint y0 = y * image.Height / this->Height, y1 = std::max((y + 1) * image.Height / this->Height, y0 + 1);
+            GLuint sum[3] = { 0, 0, 0 }, count = (x1 - x0) * (y1 - y0);
+            for (GLuint v = y0; v < y1; ++v)
+                for (GLuint u = x0; u < x1; ++u)
+                    for (GLuint c = 0; c < 3; ++c)
+                        sum[c] += Channel(image.Pixels[v * image.Width + u], c);
+            this->background[y * this->Width + x] = PackPixel((sum[0] + count / 2) / count,
+                (sum[1] + count / 2) / count, (sum[2] + count / 2) / count, 255);
+        }
+    return GL_TRUE;
+}
+
+void SoftwareRasterizer::Render(const Game& game, GLubyte* out)
+{
+    this->begin();
+    const GameLevel& level = game.Levels[game.Level];
+    level.ForEachAlive([&](GLuint i) {
+        const GameObject& brick = level.Bricks[i];
+        this->draw(brick.IsSolid ? this->blockSolid : this->block, brick.Position, brick.Size, brick.Color);
+    });
+    this->draw(this->paddle, game.Player.Position, game.Player.Size, game.Player.Color);
+    for (const PowerUp& powerUp : game.PowerUps)
+        if (!powerUp.Destroyed)
+            this->draw(this->powerups[PowerUpKind(powerUp.Type)], powerUp.Position, powerUp.Size, powerUp.Color);
+    this->draw(this->face, game.Ball.Position, game.Ball.Size, game.Ball.Color);
+    const BallPool& balls = game.Balls;
+    for (GLuint i = 0; i < balls.Size(); ++i)
+        this->draw(this->face, glm::vec2(balls.X[i], balls.Y[i]), glm::vec2(balls.Radius * 2.0f), game.Ball.Color);
+    this->finish(out, game.Confuse);
+}
+
+void SoftwareRasterizer::Render(const BatchedBreakout& batch, GLuint world, GLubyte* out)
+{
+    this->begin();
+    const std::uint64_t* alive = &batch.Alive[world * batch.AliveWords];
+    for (GLuint word = 0; word < batch.AliveWords; ++word)
+        for (std::uint64_t bits = alive[word]; bits; bits &= bits - 1)
+        {
+            const GameObject& brick = batch.Level.Bricks[word * 64 + LowestBit(bits)];
+            this->draw(brick.IsSolid ? this->blockSolid : this->block, brick.Position, brick.Size, brick.Color);
+        }
+    // colors as Game::ActivatePowerUp sets them
+    this->draw(this->paddle, glm::vec2(batch.PaddleX[world], batch.PaddleY),
+        glm::vec2(batch.PaddleWidth[world], PLAYER_SIZE.y),
+        batch.Sticky[world] ? glm::vec3(1.0f, 0.5f, 1.0f) : glm::vec3(1.0f));
+    for (GLuint slot = world * BatchedBreakout::POWERUP_SLOTS, end = slot + batch.PowerUpCount[world]; slot < end; ++slot)
+        if (!batch.PowerUpDestroyed[slot])
+            this->draw(this->powerups[batch.PowerUpType[slot]], glm::vec2(batch.PowerUpX[slot], batch.PowerUpY[slot]),
+                SIZE, POWERUP_COLORS[batch.PowerUpType[slot]]);
+    this->draw(this->face, glm::vec2(batch.BallX[world], batch.BallY[world]), glm::vec2(BALL_RADIUS * 2.0f),
+        batch.PassThrough[world] ? glm::vec3(1.0f, 0.5f, 0.5f) : glm::vec3(1.0f));
+    this->finish(out, batch.Confuse[world]);
+}
+
+void SoftwareRasterizer::begin()
+{
+    std::memcpy(this->canvas.data(), this->background.data(), this->canvas.size() * sizeof(std::uint32_t));
+}
+
+void SoftwareRasterizer::draw(const RasterTexture& texture, glm::vec2 position, glm::vec2 size, glm::vec3 color)
+{
+    glm::vec2 start = position * this->scale, extent = size * this->scale;
+    GLint x0 = PixelEdge(start.x, this->Width), x1 = PixelEdge(start.x + extent.x, this->Width);
+    GLint y0 = PixelEdge(start.y, this->Height), y1 = PixelEdge(start.y + extent.y, this->Height);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    // the smallest level that still has a texel for every pixel
+    GLuint level = 0;
+    while (level + 1 < texture.Levels.size() && texture.Levels[level + 1].Width >= extent.x
+        && texture.Levels[level + 1].Height >= extent.y)
+        ++level;
+    const RasterImage& image = texture.Levels[level];
+    for (GLint x = x0; x < x1; ++x)
+    {
+        GLfloat u = (x + 0.5f - start.x) / extent.x;
+        this->columns[x - x0] = std::min(static_cast<GLuint>(std::max(u, 0.0f) * image.Width), image.Width - 1);
+    }
+    GLuint tint[3] = { static_cast<GLuint>(color.r * 256.0f + 0.5f), static_cast<GLuint>(color.g * 256.0f + 0.5f),
+        static_cast<GLuint>(color.b * 256.0f + 0.5f) };
+    for (GLuint c = 0; c < 3; ++c)
+        tint[c] = std::min(tint[c], 256u);
+    // gather one row of texels, then blend it in one pass
+    std::uint32_t texels[256];
+    for (GLint y = y0; y < y1; ++y)
+    {
+        GLfloat v = (y + 0.5f - start.y) / extent.y;
+        const std::uint32_t* row = &image.Pixels[std::min(static_cast<GLuint>(std::max(v, 0.0f) * image.Height),
+            image.Height - 1) * image.Width];
+        for (GLint x = x0; x < x1; x += 256)
+        {
+            GLuint count = std::min(x1 - x, 256);
+            for (GLuint i = 0; i < count; ++i)
+                texels[i] = row[this->columns[x - x0 + i]];
+            BlendSpan(&this->canvas[y * this->Width + x], texels, count, tint, this->UseSimd);
+        }
+    }
+}
+
+void SoftwareRasterizer::finish(GLubyte* out, GLboolean confuse)
+{
+    GLuint count = this->Width * this->Height;
+    if (confuse && this->ApplyConfuse)
+        Confuse(this->canvas.data(), count, this->UseSimd);
+    if (this->Format == PIXELS_GRAY)
+    {
+        ToGray(this->canvas.data(), count, out, this->UseSimd);
+        return;
+    }
+    for (GLuint i = 0; i < count; ++i)
+    {
+        std::uint32_t pixel = this->canvas[i];
+        out[i * 3 + 0] = static_cast<GLubyte>(pixel);
+        out[i * 3 + 1] = static_cast<GLubyte>(pixel >> 8);
+        out[i * 3 + 2] = static_cast<GLubyte>(pixel >> 16);
+    }
+}
+
+GLboolean LoadRasterTexture(const std::string& file, RasterTexture& texture)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(file.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!data)
+    {
+        std::cout << "ERROR::RASTER: Failed to load texture " << file << std::endl;
+        return GL_FALSE;
+    }
+    // premultiply alpha, which is what blending with SRC_ALPHA computes
+    texture.Levels.assign(1, RasterImage());
+    RasterImage& image = texture.Levels[0];
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.resize(width * height);
+    for (GLuint i = 0; i < image.Pixels.size(); ++i)
+    {
+        const unsigned char* p = data + i * 4;
+        image.Pixels[i] = PackPixel(Div255(p[0] * p[3]), Div255(p[1] * p[3]), Div255(p[2] * p[3]), p[3]);
+    }
+    stbi_image_free(data);
+    // box filtered mip levels down to 1x1
+    while (texture.Levels.back().Width > 1 || texture.Levels.back().Height > 1)
+    {
+        const RasterImage& from = texture.Levels.back();
+        RasterImage to;
+        to.Width = std::max(from.Width / 2, 1u);
+        to.Height = std::max(from.Height / 2, 1u);
+        to.Pixels.resize(to.Width * to.Height);
+        for (GLuint y = 0; y < to.Height; ++y)
+            for (GLuint x = 0; x < to.Width; ++x)
+            {
+                GLuint u0 = std::min(x * 2, from.Width - 1), u1 = std::min(x * 2 + 1, from.Width - 1);
+                GLuint v0 = std::min(y * 2, from.Height - 1), v1 = std::min(y * 2 + 1, from.Height - 1);
+                std::uint32_t a = from.Pixels[v0 * from.Width + u0], b = from.Pixels[v0 * from.Width + u1];
+                std::uint32_t c = from.Pixels[v1 * from.Width + u0], d = from.Pixels[v1 * from.Width + u1];
+                GLuint sum[4];
+                for (GLuint k = 0; k < 4; ++k)
+                    sum[k] = (Channel(a, k) + Channel(b, k) + Channel(c, k) + Channel(d, k) + 2) / 4;
+                to.Pixels[y * to.Width + x] = PackPixel(sum[0], sum[1], sum[2], sum[3]);
+            }
+        texture.Levels.push_back(std::move(to));
+    }
+    return GL_TRUE;
+}
+
+// dst = tint * src + dst * (1 - src alpha), src premultiplied. Every
+// step fits in 16 bits, so the SSE2 path gives the same bytes.
+void BlendSpan(std::uint32_t* dst, const std::uint32_t* src, GLuint count, const GLuint tint[3], GLboolean simd)
+{
+    GLuint i = 0;
+#ifdef RASTER_SSE2
+    if (simd)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i tints = _mm_setr_epi16(static_cast<short>(tint[0]), static_cast<short>(tint[1]),
+            static_cast<short>(tint[2]), 256, static_cast<short>(tint[0]), static_cast<short>(tint[1]),
+            static_cast<short>(tint[2]), 256);
+        const __m128i full = _mm_set1_epi16(255), half = _mm_set1_epi16(128);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i result[2];
+            for (GLuint k = 0; k < 2; ++k)
+            {
+                // two pixels as eight 16-bit channels
+                __m128i sk = k ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+                __m128i dk = k ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+                __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sk, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(dk, _mm_sub_epi16(full, alpha)), half);
+                t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+                result[k] = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(sk, tints), 8), t);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(result[0], result[1]));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        std::uint32_t s = src[i], d = dst[i];
+        GLuint inverse = 255 - Channel(s, 3);
+        dst[i] = PackPixel(((Channel(s, 0) * tint[0]) >> 8) + Div255(Channel(d, 0) * inverse),
+            ((Channel(s, 1) * tint[1]) >> 8) + Div255(Channel(d, 1) * inverse),
+            ((Channel(s, 2) * tint[2]) >> 8) + Div255(Channel(d, 2) * inverse),
+            Channel(s, 3) + Div255(Channel(d, 3) * inverse));
+    }
+}
+
+// post_processing confuse: the picture turned by 180 degrees, colors inverted
+void Confuse(std::uint32_t* pixels, GLuint count, GLboolean simd)
+{
+    const std::uint32_t invert = 0x00FFFFFF;
+    GLuint i = 0, j = count;
+#ifdef RASTER_SSE2
+    if (simd)
+    {
+        const __m128i mask = _mm_set1_epi32(invert);
+        for (; j - i >= 8; i += 4, j -= 4)
+        {
+            __m128i front = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+            __m128i back = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + j - 4));
+            front = _mm_xor_si128(_mm_shuffle_epi32(front, _MM_SHUFFLE(0, 1, 2, 3)), mask);
+            back = _mm_xor_si128(_mm_shuffle_epi32(back, _MM_SHUFFLE(0, 1, 2, 3)), mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), back);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + j - 4), front);
+        }
+    }
+#endif
+    for (; j - i >= 2; ++i, --j)
+    {
+        std::uint32_t front = pixels[i];
+        pixels[i] = pixels[j - 1] ^ invert;
+        pixels[j - 1] = front ^ invert;
+    }
+    if (j > i)
+        pixels[i] ^= invert;
+}
+
+// BT.601 luma in 8-bit fixed point: (77 R + 150 G + 29 B + 128) / 256
+void ToGray(const std::uint32_t* pixels, GLuint count, GLubyte* out, GLboolean simd)
+{
+    GLuint i = 0;
+#ifdef RASTER_SSE2
+    if (simd)
+    {
+        // one pixel per 32-bit lane; the sums stay below 2^16, so 16-bit multiplies do
+        const __m128i low = _mm_set1_epi32(0xFF), half = _mm_set1_epi32(128);
+        const __m128i red = _mm_set1_epi32(77), green = _mm_set1_epi32(150), blue = _mm_set1_epi32(29);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i gray[2];
+            for (GLuint k = 0; k < 2; ++k)
+            {
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i + k * 4));
+                __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(p, low), red), half);
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(p, 8), low), green));
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(p, 16), low), blue));
+                gray[k] = _mm_srli_epi32(sum, 8);
+            }
+            __m128i words = _mm_packs_epi32(gray[0], gray[1]);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        out[i] = static_cast<GLubyte>((77 * Channel(pixels[i], 0) + 150 * Channel(pixels[i], 1)
+            + 29 * Channel(pixels[i], 2) + 128) >> 8);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "spatial_hash.h"
+
+
+SpatialHash::SpatialHash() : inverseCell(1.0f), mask(0), rowStride(1) { }
+
+void SpatialHash::Build(const GLfloat* x, const GLfloat* y, GLuint count, GLfloat cellSize)
+{
+    this->inverseCell = 1.0f / cellSize;
+    GLuint size = 16;
+    while (size < count * 2)
+        size *= 2;
+    this->mask = size - 1;
+    // rows 1 and 2 apart start 0.618 and 0.236 of the table apart, at
+    // least 3 buckets even for the smallest table
+    this->rowStride = static_cast<GLuint>(size * 0.6180339887 + 0.5);
+    this->starts.assign(size + 1, 0);
+    this->buckets.resize(count);
+    this->indices.resize(count);
+    // count the points per bucket, turn the counts into start offsets, then
+    // place the points; they stay in index order within a bucket
+    for (GLuint i = 0; i < count; ++i)
+    {
+        GLuint b = this->bucket(static_cast<GLint>(std::floor(x[i] * this->inverseCell)),
+            static_cast<GLint>(std::floor(y[i] * this->inverseCell)));
+        this->buckets[i] = b;
+        ++this->starts[b + 1];
+    }
+    for (GLuint b = 0; b < size; ++b)
+        this->starts[b + 1] += this->starts[b];
+    for (GLuint i = 0; i < count; ++i)
+        this->indices[this->starts[this->buckets[i]]++] = i;
+    // placing moved every start to the end of its bucket, which is where the next one begins
+    for (GLuint b = size; b > 0; --b)
+        this->starts[b] = this->starts[b - 1];
+    this->starts[0] = 0;
+}
\ No newline at end of file
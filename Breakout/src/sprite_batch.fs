@@ -0,0 +1,15 @@
+#version 330 core
+
+in vec2 TexCoords;
+in vec3 SpriteColor;
+flat in float Layer;
+out vec4 color;
+
+uniform sampler2D sprite;
+uniform sampler2DArray sprites;
+
+void main()
+{
+    vec4 texel = Layer < 0.0 ? texture(sprite, TexCoords) : texture(sprites, vec3(TexCoords, Layer));
+    color = vec4(SpriteColor, 1.0) * texel;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 color;  // <vec3 color, float layer>
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+flat out float Layer;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = vertex.zw;
+    SpriteColor = color.rgb;
+    Layer = color.a;
+    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+}
\ No newline at end of file
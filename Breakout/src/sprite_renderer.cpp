@@ -1,16 +1,39 @@
 #include "sprite_renderer.h"
 
+#include <cmath>
 #include <iostream>
 
 SpriteRenderer::SpriteRenderer(Shader& shader)
+    : DrawCalls(0), Sprites(0), batchVAO(0), batchVBO(0), batchEBO(0),
+      maxSprites(0), batching(GL_FALSE), batchTexture(0), batchArray(GL_FALSE)
 {
     this->shader = shader;
     this->initRenderData();
 }
 
+SpriteRenderer::SpriteRenderer(Shader& shader, Shader& batchShader, GLuint maxSprites)
+    : DrawCalls(0), Sprites(0), batchVAO(0), batchVBO(0), batchEBO(0),
+      maxSprites(maxSprites), batching(GL_FALSE), batchTexture(0), batchArray(GL_FALSE)
+{
+    this->shader = shader;
+    this->batchShader = batchShader;
+    // GLushort indices address at most 65536 vertices
+    if (this->maxSprites > 16384)
+        this->maxSprites = 16384;
+    this->initRenderData();
+    if (this->maxSprites > 0)
+        this->initBatchData();
+}
+
 SpriteRenderer::~SpriteRenderer()
 {
     glDeleteVertexArrays(1,&this->quadVAO);
+    if (this->batchVAO)
+    {
+        glDeleteVertexArrays(1, &this->batchVAO);
+        glDeleteBuffers(1, &this->batchVBO);
+        glDeleteBuffers(1, &this->batchEBO);
+    }
 }
 
 void SpriteRenderer::initRenderData()
@@ -41,9 +64,49 @@ void SpriteRenderer::initRenderData()
     glBindVertexArray(0);
 }
 
+void SpriteRenderer::initBatchData()
+{
+    // ÿıεĽǣ0 1 2 3£ģʽͬ
+    std::vector<GLushort> indices(this->maxSprites * 6);
+    for (GLuint i = 0; i < this->maxSprites; ++i)
+    {
+        GLushort base = static_cast<GLushort>(i * 4);
+        GLushort* quad = &indices[i * 6];
+        quad[0] = base + 3; quad[1] = base + 1; quad[2] = base + 0;
+        quad[3] = base + 3; quad[4] = base + 2; quad[5] = base + 1;
+    }
+    this->vertices.reserve(this->maxSprites * 4);
+
+    glGenVertexArrays(1, &this->batchVAO);
+    glGenBuffers(1, &this->batchVBO);
+    glGenBuffers(1, &this->batchEBO);
+
+    glBindVertexArray(this->batchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->batchVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->maxSprites * 4 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->batchEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (GLvoid*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (GLvoid*)(4 * sizeof(GLfloat)));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position,
     glm::vec2 size, GLfloat rotate, glm::vec3 color)
 {
+    ++this->Sprites;
+    if (this->batching)
+    {
+        this->queue(texture.ID, GL_FALSE, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), -1.0f, position, size, rotate, color);
+        return;
+    }
+
+    ++this->DrawCalls;
     this->shader.Use();
 
     glm::mat4 model = glm::mat4(1.0f);
@@ -62,4 +125,102 @@ void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position,
     glBindVertexArray(this->quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+}
+
+void SpriteRenderer::DrawSprite(const TextureArray& sprites, const SpriteRegion& region, glm::vec2 position,
+    glm::vec2 size, GLfloat rotate, glm::vec3 color)
+{
+    if (!this->batchVAO)
+    {
+        std::cout << "ERROR::SPRITE_RENDERER: Texture array sprites need the batch shader" << std::endl;
+        return;
+    }
+    ++this->Sprites;
+    this->queue(sprites.ID, GL_TRUE, region.UV, static_cast<GLfloat>(region.Layer), position, size, rotate, color);
+    // ģʽŶӺϻ
+    if (!this->batching)
+        this->Flush();
+}
+
+void SpriteRenderer::queue(GLuint texture, GLboolean array, const glm::vec4& uv, GLfloat layer,
+    glm::vec2 position, glm::vec2 size, GLfloat rotate, glm::vec3 color)
+{
+    if (texture != this->batchTexture || this->vertices.size() >= this->maxSprites * 4)
+    {
+        this->Flush();
+        this->batchTexture = texture;
+        this->batchArray = array;
+    }
+    // ģʽmodelͬתƽƵposition
+    glm::vec2 corners[4] = {
+        glm::vec2(0.0f, 0.0f), glm::vec2(size.x, 0.0f),
+        glm::vec2(size.x, size.y), glm::vec2(0.0f, size.y)
+    };
+    if (rotate != 0.0f)
+    {
+        GLfloat radians = glm::radians(rotate);
+        GLfloat c = std::cos(radians), s = std::sin(radians);
+        glm::vec2 center = 0.5f * size;
+        for (glm::vec2& corner : corners)
+        {
+            glm::vec2 d = corner - center;
+            corner = center + glm::vec2(c * d.x - s * d.y, s * d.x + c * d.y);
+        }
+    }
+    GLfloat u[4] = { uv.x, uv.z, uv.z, uv.x };
+    GLfloat v[4] = { uv.y, uv.y, uv.w, uv.w };
+    for (int i = 0; i < 4; ++i)
+    {
+        SpriteVertex vertex = {
+            position.x + corners[i].x, position.y + corners[i].y, u[i], v[i],
+            color.r, color.g, color.b, layer
+        };
+        this->vertices.push_back(vertex);
+    }
+}
+
+void SpriteRenderer::Begin()
+{
+    this->DrawCalls = 0;
+    this->Sprites = 0;
+    this->batchTexture = 0;
+    this->vertices.clear();
+    this->batching = this->batchVAO != 0;
+}
+
+void SpriteRenderer::Flush()
+{
+    if (this->vertices.empty())
+        return;
+    ++this->DrawCalls;
+    this->batchShader.Use();
+    if (this->batchArray)
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->batchTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    else
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, this->batchTexture);
+    }
+
+    glBindVertexArray(this->batchVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->batchVBO);
+    // ȶɵĴ洢ȴһ֡ʹøûĻ
+    GLsizeiptr bytes = this->vertices.size() * sizeof(SpriteVertex);
+    glBufferData(GL_ARRAY_BUFFER, this->maxSprites * 4 * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, this->vertices.data());
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->vertices.size() / 4 * 6), GL_UNSIGNED_SHORT, (GLvoid*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    this->vertices.clear();
+}
+
+void SpriteRenderer::End()
+{
+    this->Flush();
+    this->batching = GL_FALSE;
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "texture_array.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+// A row of images in a layer, all placed at the same y
+struct Shelf
+{
+    GLuint Layer, Y, Height, Width;
+};
+
+TextureArray::TextureArray(GLuint layerSize)
+    : ID(0), LayerSize(layerSize), Layers(0), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR) { }
+
+GLuint TextureArray::Add(GLuint width, GLuint height, const unsigned char* rgba)
+{
+    Image image;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.assign(rgba, rgba + width * height * 4);
+    this->images.push_back(image);
+    return static_cast<GLuint>(this->images.size() - 1);
+}
+
+GLboolean TextureArray::Generate()
+{
+    // Tallest images first, each on the first shelf it fits; a new shelf
+    // goes below the last one of the last layer, or into a new layer
+    std::vector<GLuint> order(this->images.size());
+    for (GLuint i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](GLuint a, GLuint b) {
+        return this->images[a].Height > this->images[b].Height;
+    });
+    std::vector<Shelf> shelves;
+    std::vector<glm::uvec3> places(this->images.size());
+    GLuint layers = 0, bottom = 0;
+    for (GLuint index : order)
+    {
+        GLuint width = this->images[index].Width + 2, height = this->images[index].Height + 2;
+        if (width > this->LayerSize || height > this->LayerSize)
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY: Image of " << width - 2 << "x" << height - 2
+                << " does not fit in a layer of " << this->LayerSize << std::endl;
+            return GL_FALSE;
+        }
+        Shelf* shelf = nullptr;
+        for (Shelf& candidate : shelves)
+            if (height <= candidate.Height && candidate.Width + width <= this->LayerSize)
+            {
+                shelf = &candidate;
+                break;
+            }
+        if (!shelf)
+        {
+            if (layers == 0 || bottom + height > this->LayerSize)
+            {
+                ++layers;
+                bottom = 0;
+            }
+            Shelf created = { layers - 1, bottom, height, 0 };
+            shelves.push_back(created);
+            shelf = &shelves.back();
+            bottom += height;
+        }
+        places[index] = glm::uvec3(shelf->Width, shelf->Y, shelf->Layer);
+        shelf->Width += width;
+    }
+
+    // Copy every image and its wrapped border into the layers
+    GLuint size = this->LayerSize;
+    std::vector<unsigned char> texels(static_cast<size_t>(size) * size * layers * 4, 0);
+    this->regions.resize(this->images.size());
+    for (GLuint i = 0; i < this->images.size(); ++i)
+    {
+        const Image& image = this->images[i];
+        GLuint w = image.Width, h = image.Height;
+        glm::uvec3 place = places[i];
+        for (GLuint y = 0; y < h + 2; ++y)
+        {
+            GLuint sourceY = (y + h - 1) % h;
+            unsigned char* row = &texels[((static_cast<size_t>(place.z) * size + place.y + y) * size + place.x) * 4];
+            for (GLuint x = 0; x < w + 2; ++x)
+            {
+                GLuint sourceX = (x + w - 1) % w;
+                const unsigned char* texel = &image.Pixels[(static_cast<size_t>(sourceY) * w + sourceX) * 4];
+                std::copy(texel, texel + 4, row + x * 4);
+            }
+        }
+        SpriteRegion& region = this->regions[i];
+        region.Layer = place.z;
+        region.UV = glm::vec4(place.x + 1, place.y + 1, place.x + 1 + w, place.y + 1 + h) / static_cast<GLfloat>(size);
+    }
+
+    this->Layers = layers;
+    if (!this->ID)
+        glGenTextures(1, &this->ID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, this->ID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size, size, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return GL_TRUE;
+}
+
+const SpriteRegion& TextureArray::Region(GLuint index) const
+{
+    return this->regions[index];
+}
+
+void TextureArray::Bind() const
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, this->ID);
+}
+
+void TextureArray::Clear()
+{
+    if (this->ID)
+        glDeleteTextures(1, &this->ID);
+    this->ID = 0;
+    this->Layers = 0;
+    this->images.clear();
+    this->regions.clear();
+}
\ No newline at end of file